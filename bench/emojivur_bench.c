@@ -0,0 +1,549 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       emojivur_bench.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Benchmark of shaping, rasterization and PDF emission
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <harfbuzz/hb.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "bench_options.h"
+#include "emojivur.h"
+#include "raster_output.h"
+#include "stats.h"
+#include "stream.h"
+
+// Font found at build time (if any)
+#ifndef EMOJIVUR_BENCH_FONT
+#define EMOJIVUR_BENCH_FONT ""
+#endif
+
+// Number of times each ZWJ sequence is repeated to build a long text
+#define BENCH_ZWJ_REPEAT 16
+
+// Sizes in pixels used when none is requested
+static const int bench_default_pxsizes[] = {16, 32, 64, 128};
+
+// Short texts like the ones typically given on the command line
+static const char *bench_short_texts[] = {
+    "\U0001F600",
+    "\U0001F363 \u26B0\uFE0F \U0001F41F",
+    "\U0001F44D\U0001F3FD",
+    "\U0001F1EE\U0001F1F9",
+    "\u2764\uFE0F",
+    "#\uFE0F\u20E3",
+    "\U0001F431\U0001F436\U0001F42D\U0001F439",
+};
+
+// ZWJ sequences (each one rendered by a single glyph in a color emoji font)
+static const char *bench_zwj_sequences[] = {
+    "\U0001F468\u200D\U0001F469\u200D\U0001F467\u200D\U0001F466",
+    "\U0001F3F3\uFE0F\u200D\U0001F308",
+    "\U0001F469\U0001F3FD\u200D\U0001F4BB",
+    "\U0001F9D1\U0001F3FF\u200D\U0001F91D\u200D\U0001F9D1\U0001F3FB",
+    "\U0001F441\uFE0F\u200D\U0001F5E8\uFE0F",
+    "\U0001F3F4\u200D\u2620\uFE0F",
+};
+
+/*!
+ * \brief Texts making up a workload
+ *
+ */
+typedef struct
+{
+    const char *name;   /**< Name of the workload */
+    char **texts;       /**< UTF-8 texts to process (owned by the workload) */
+    size_t text_count;  /**< Number of texts */
+} bench_workload_t;
+
+/*!
+ * \brief Latencies measured for a stage of a workload
+ *
+ */
+typedef struct
+{
+    uint64_t *latencies_ns; /**< Latency of every sample */
+    size_t count;           /**< Number of samples */
+    size_t allocated;       /**< Number of samples that fit in `latencies_ns` */
+    uint64_t glyphs;        /**< Total number of glyphs processed */
+    uint64_t elapsed_ns;    /**< Total time spent processing the samples */
+    uint64_t allocations;   /**< Heap allocations made by the samples taken once warmed up */
+    size_t warm_count;      /**< Number of samples taken once warmed up (0 if allocations cannot be counted) */
+} bench_samples_t;
+
+/*!
+ * \brief Stages of the pipeline measured
+ *
+ */
+typedef enum
+{
+    BENCH_STAGE_SHAPE,  /**< `emojivur_shape_text()` (HarfBuzz shaping & Cairo glyphs) */
+    BENCH_STAGE_RASTER, /**< `emojivur_image_render()` (rasterization to an ARGB32 image) */
+    BENCH_STAGE_PNG,    /**< Rasterization & PNG encoding to memory, like the batch does for each image */
+    BENCH_STAGE_PDF,    /**< Same steps as `emojivur_pdf_output()` (one page PDF document) */
+    BENCH_STAGE_COUNT,
+} bench_stage_t;
+
+static const char *bench_stage_names[BENCH_STAGE_COUNT] = {"shape", "raster", "png", "pdf"};
+
+/*!
+ * \brief Append a copy of a text to a workload
+ *
+ * \param workload          Workload to add the text to
+ * \param text              UTF-8 text to add
+ *
+ */
+static void bench_workload_add(bench_workload_t *workload, const char *text)
+{
+    workload->texts = (char **)realloc(workload->texts, (workload->text_count + 1) * sizeof(char *));
+    if (unlikely(!workload->texts || !(workload->texts[workload->text_count] = strdup(text))))
+    {
+        fprintf(stderr, "[ERROR] Out of memory building the %s workload!\n", workload->name);
+        exit(1);
+    }
+    ++workload->text_count;
+}
+
+/*!
+ * \brief Release the texts of a workload
+ *
+ * \param workload          Workload to release
+ *
+ */
+static void bench_workload_free(bench_workload_t *workload)
+{
+    for (size_t i = 0; i < workload->text_count; ++i)
+    {
+        free(workload->texts[i]);
+    }
+    free(workload->texts);
+    workload->texts = NULL;
+    workload->text_count = 0;
+}
+
+/*!
+ * \brief Encode a Unicode code point as UTF-8
+ *
+ * \param codepoint         Code point to encode
+ * \param utf8              Buffer at least 5 bytes long (output, NUL terminated)
+ *
+ */
+static void bench_utf8_encode(hb_codepoint_t codepoint, char *utf8)
+{
+    if (codepoint < 0x80)
+    {
+        *utf8++ = codepoint;
+    }
+    else if (codepoint < 0x800)
+    {
+        *utf8++ = 0xC0 | (codepoint >> 6);
+        *utf8++ = 0x80 | (codepoint & 0x3F);
+    }
+    else if (codepoint < 0x10000)
+    {
+        *utf8++ = 0xE0 | (codepoint >> 12);
+        *utf8++ = 0x80 | ((codepoint >> 6) & 0x3F);
+        *utf8++ = 0x80 | (codepoint & 0x3F);
+    }
+    else
+    {
+        *utf8++ = 0xF0 | (codepoint >> 18);
+        *utf8++ = 0x80 | ((codepoint >> 12) & 0x3F);
+        *utf8++ = 0x80 | ((codepoint >> 6) & 0x3F);
+        *utf8++ = 0x80 | (codepoint & 0x3F);
+    }
+    *utf8 = '\0';
+}
+
+/*!
+ * \brief Build a workload made of every emoji the font has a glyph for (one text each)
+ *
+ * \param workload          Workload to fill
+ * \param font              HarfBuzz font to check the coverage of
+ *
+ */
+static void bench_workload_font(bench_workload_t *workload, hb_font_t *font)
+{
+    // Blocks where emojis live (joiners, selectors and combining marks excluded)
+    static const hb_codepoint_t ranges[][2] = {
+        {0x00A9, 0x00AE},
+        {0x2010, 0x2064},
+        {0x2100, 0x2BFF},
+        {0x3030, 0x3299},
+        {0x1F000, 0x1FAFF},
+    };
+
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r)
+    {
+        for (hb_codepoint_t codepoint = ranges[r][0]; codepoint <= ranges[r][1]; ++codepoint)
+        {
+            hb_codepoint_t glyph = 0;
+            if ((codepoint >= 0x200B && codepoint <= 0x200F) ||
+                !hb_font_get_nominal_glyph(font, codepoint, &glyph) || glyph == 0)
+            {
+                continue;
+            }
+
+            char text[8];
+            bench_utf8_encode(codepoint, text);
+            bench_workload_add(workload, text);
+        }
+    }
+}
+
+/*!
+ * \brief Record the latency of one sample
+ *
+ * \param samples           Samples of the stage
+ * \param latency_ns        Time taken by the sample
+ * \param glyphs            Number of glyphs processed by the sample
+ *
+ */
+static void bench_samples_add(bench_samples_t *samples, uint64_t latency_ns, unsigned int glyphs)
+{
+    if (samples->count == samples->allocated)
+    {
+        samples->allocated = MAX(1024, samples->allocated * 2);
+        samples->latencies_ns = (uint64_t *)realloc(samples->latencies_ns, samples->allocated * sizeof(uint64_t));
+        if (unlikely(!samples->latencies_ns))
+        {
+            fprintf(stderr, "[ERROR] Out of memory recording the benchmark samples!\n");
+            exit(1);
+        }
+    }
+    samples->latencies_ns[samples->count++] = latency_ns;
+    samples->glyphs += glyphs;
+    samples->elapsed_ns += latency_ns;
+}
+
+static int bench_compare_latency(const void *a, const void *b)
+{
+    uint64_t latency_a = *(const uint64_t *)a;
+    uint64_t latency_b = *(const uint64_t *)b;
+    return (latency_a > latency_b) - (latency_a < latency_b);
+}
+
+/*!
+ * \brief Get a latency percentile (nearest rank) from samples already sorted
+ *
+ * \param samples           Sorted samples
+ * \param percentile        Percentile to get (0-100)
+ *
+ * \return Latency in microseconds
+ *
+ */
+static double bench_percentile_us(const bench_samples_t *samples, double percentile)
+{
+    if (samples->count == 0)
+    {
+        return 0.0;
+    }
+
+    size_t rank = (size_t)(percentile / 100.0 * samples->count + 0.5);
+    rank = MIN(MAX(rank, 1), samples->count);
+    return samples->latencies_ns[rank - 1] / 1e3;
+}
+
+/*!
+ * \brief Run one stage of a workload until enough samples have been collected
+ *
+ * Heap allocations are counted once every text of the workload went through the stage,
+ * that is once caches, arenas and recycled images are warmed up.
+ *
+ * \param shared_data       Shared data with the font loaded and scaled to `pxsize`
+ * \param stage             Stage to measure
+ * \param workload          Texts to process (in a round robin fashion)
+ * \param emojis            Texts of the workload already shaped and laid out on a page
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param options           Benchmark options
+ * \param png_stream        Memory stream the PNG images are encoded to
+ * \param samples           Samples collected (output)
+ *
+ */
+static void bench_run_stage(emojivur_shared_ptrs_t *shared_data, bench_stage_t stage,
+                            const bench_workload_t *workload, const emoji_to_render_t *emojis,
+                            unsigned int pxsize, const struct gengetopt_args_info *options,
+                            emojivur_stream_t *png_stream, bench_samples_t *samples)
+{
+    uint64_t min_time_ns = options->min_time_arg * 1e9;
+    size_t min_samples = MAX(options->min_samples_arg, 1);
+
+    for (size_t i = 0; samples->count < min_samples || samples->elapsed_ns < min_time_ns; ++i)
+    {
+        size_t text = i % workload->text_count;
+        emoji_viewport_t text_size;
+        unsigned int glyph_count = emojis[text].glyph_count;
+
+        uint64_t allocations = 0;
+        bool warm = i >= workload->text_count && emojivur_stats_count_allocations(&allocations, NULL);
+
+        uint64_t start_ns = emojivur_stats_now();
+        switch (stage)
+        {
+        case BENCH_STAGE_SHAPE:
+            glyph_count = emojivur_shape_text(shared_data, workload->texts[text], -1, pxsize, &text_size);
+            break;
+
+        case BENCH_STAGE_RASTER:
+            emojivur_image_render(shared_data, emojis[text]);
+            emojivur_image_recycle(shared_data);
+            break;
+
+        case BENCH_STAGE_PNG:
+            emojivur_image_render(shared_data, emojis[text]);
+            png_stream->length = 0;
+            if (unlikely(!emojivur_png_write_stream(shared_data->cairo_surface, emojivur_stream_write, png_stream)))
+            {
+                emojivur_exit(shared_data, "An error occured encoding the PNG image!", 1);
+            }
+            emojivur_image_recycle(shared_data);
+            break;
+
+        case BENCH_STAGE_PDF:
+            emojivur_pdf_open(shared_data, emojis[text].viewport, options->pdf_arg);
+            emojivur_pdf_page(shared_data, emojis[text]);
+            emojivur_pdf_close(shared_data);
+            break;
+
+        default:
+            break;
+        }
+        uint64_t latency_ns = emojivur_stats_now() - start_ns;
+
+        if (warm)
+        {
+            uint64_t warm_allocations = 0;
+            emojivur_stats_count_allocations(&warm_allocations, NULL);
+            samples->allocations += warm_allocations - allocations;
+            ++samples->warm_count;
+        }
+        bench_samples_add(samples, latency_ns, glyph_count);
+    }
+
+    qsort(samples->latencies_ns, samples->count, sizeof(uint64_t), bench_compare_latency);
+}
+
+/*!
+ * \brief Print the results of a stage of a workload (and append them to the JSON report)
+ *
+ * \param workload          Workload measured
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param stage             Stage measured
+ * \param samples           Sorted samples collected
+ * \param json_file         File the JSON report is written to (NULL if none)
+ * \param first             Whether these are the first results written to the JSON report
+ *
+ */
+static void bench_report(const bench_workload_t *workload, unsigned int pxsize, bench_stage_t stage,
+                         const bench_samples_t *samples, FILE *json_file, bool first)
+{
+    double elapsed_s = samples->elapsed_ns / 1e9;
+    double samples_per_s = elapsed_s > 0 ? samples->count / elapsed_s : 0.0;
+    double glyphs_per_s = elapsed_s > 0 ? samples->glyphs / elapsed_s : 0.0;
+
+    // Allocations are unknown when they cannot be counted or when no sample was taken once warmed up
+    char allocations[32] = "n/a";
+    char json_allocations[32] = "null";
+    if (samples->warm_count > 0)
+    {
+        snprintf(allocations, sizeof(allocations), "%.2f", (double)samples->allocations / samples->warm_count);
+        snprintf(json_allocations, sizeof(json_allocations), "%.3f",
+                 (double)samples->allocations / samples->warm_count);
+    }
+
+    printf("%-6s %5u %-7s %9zu %12.1f %12.1f %10.1f %10.1f %10.1f %10.1f %10s\n",
+           workload->name, pxsize, bench_stage_names[stage], samples->count, samples_per_s, glyphs_per_s,
+           bench_percentile_us(samples, 50), bench_percentile_us(samples, 90),
+           bench_percentile_us(samples, 99), bench_percentile_us(samples, 100), allocations);
+
+    if (json_file)
+    {
+        fprintf(json_file,
+                "%s    {\"workload\": \"%s\", \"pxsize\": %u, \"stage\": \"%s\", \"samples\": %zu, "
+                "\"samples_per_s\": %.1f, \"glyphs_per_s\": %.1f, "
+                "\"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, "
+                "\"allocations_per_sample\": %s}",
+                first ? "" : ",\n",
+                workload->name, pxsize, bench_stage_names[stage], samples->count,
+                samples_per_s, glyphs_per_s,
+                bench_percentile_us(samples, 50), bench_percentile_us(samples, 90),
+                bench_percentile_us(samples, 99), bench_percentile_us(samples, 100), json_allocations);
+    }
+}
+
+//    __  __    _    ___ _   _
+//   |  \/  |  / \  |_ _| \ | |
+//   | |\/| | / _ \  | ||  \| |
+//   | |  | |/ ___ \ | || |\  |
+//   |_|  |_/_/   \_\___|_| \_|
+//
+//   #pragma MAIN
+
+int main(int argc, char *argv[])
+{
+    struct gengetopt_args_info options;
+    if (unlikely(cmdline_parser(argc, argv, &options) != 0))
+    {
+        return 1;
+    }
+
+    const char *font_filename = options.font_given ? options.font_arg : EMOJIVUR_BENCH_FONT;
+    if (unlikely(font_filename[0] == '\0'))
+    {
+        fprintf(stderr, "[ERROR] No color font found at build time: choose one with --font (1)\n");
+        return 1;
+    }
+
+    emojivur_shared_ptrs_t pshared = emojivur_shared_ptrs_default;
+    emojivur_load_font(&pshared, font_filename, 0);
+
+    if (options.glyph_cache_arg > 0)
+    {
+        pshared.glyph_cache = emojivur_glyph_cache_create((size_t)options.glyph_cache_arg << 20);
+        emojivur_ptr_valid_or_exit(&pshared, pshared.glyph_cache,
+                                   "An error occured during the glyph cache creation!", 1);
+    }
+
+    pshared.tmp_buffer = hb_buffer_create();
+    emojivur_ptr_valid_or_exit(&pshared, pshared.tmp_buffer,
+                               "An error occured during the HarfBuzz work Buffer creation!", 1);
+
+    // Build the workloads requested
+    bench_workload_t workloads[] = {{.name = "short"}, {.name = "zwj"}, {.name = "font"}};
+    bool workload_requested[] = {!options.workload_given, !options.workload_given, !options.workload_given};
+    for (unsigned int i = 0; i < options.workload_given; ++i)
+    {
+        workload_requested[options.workload_arg[i]] = true;
+    }
+
+    for (size_t i = 0; i < sizeof(bench_short_texts) / sizeof(bench_short_texts[0]); ++i)
+    {
+        bench_workload_add(&workloads[workload_arg_short], bench_short_texts[i]);
+    }
+    for (size_t i = 0; i < sizeof(bench_zwj_sequences) / sizeof(bench_zwj_sequences[0]); ++i)
+    {
+        char text[BENCH_ZWJ_REPEAT * 64] = "";
+        for (int repeat = 0; repeat < BENCH_ZWJ_REPEAT; ++repeat)
+        {
+            strcat(text, bench_zwj_sequences[i]);
+        }
+        bench_workload_add(&workloads[workload_arg_zwj], text);
+    }
+    bench_workload_font(&workloads[workload_arg_font], pshared.harfbuzz_font);
+
+    const int *pxsizes = options.pxsize_given ? options.pxsize_arg : bench_default_pxsizes;
+    size_t pxsize_count = options.pxsize_given ? options.pxsize_given
+                                               : sizeof(bench_default_pxsizes) / sizeof(bench_default_pxsizes[0]);
+
+    FILE *json_file = NULL;
+    if (options.json_given)
+    {
+        json_file = fopen(options.json_arg, "w");
+        emojivur_ptr_valid_or_exit(&pshared, json_file,
+                                   "An error occured opening the JSON report for writing!", 1);
+        fprintf(json_file, "{\n  \"font\": \"%s\",\n  \"results\": [\n", font_filename);
+    }
+
+    printf("# font: %s\n", font_filename);
+    printf("%-6s %5s %-7s %9s %12s %12s %10s %10s %10s %10s %10s\n",
+           "load", "px", "stage", "samples", "samples/s", "glyphs/s", "p50(us)", "p90(us)", "p99(us)", "max(us)",
+           "allocs");
+
+    // Allocations made by the stages are counted through the statistics
+    emojivur_stats_enable();
+    emojivur_stream_t png_stream = emojivur_stream_default;
+
+    bool first = true;
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); ++w)
+    {
+        if (!workload_requested[w] || workloads[w].text_count == 0)
+        {
+            continue;
+        }
+
+        for (size_t p = 0; p < pxsize_count; ++p)
+        {
+            unsigned int pxsize = MAX(pxsizes[p], 1);
+            hb_font_set_scale(pshared.harfbuzz_font, pxsize * 64, pxsize * 64);
+
+            // Rendering stages start from texts already shaped & laid out like `main()` does
+            emoji_to_render_t *emojis = (emoji_to_render_t *)calloc(workloads[w].text_count,
+                                                                    sizeof(emoji_to_render_t));
+            emojivur_ptr_valid_or_exit(&pshared, emojis, "An error occured allocating the shaped texts!", 1);
+            for (size_t t = 0; t < workloads[w].text_count; ++t)
+            {
+                emoji_viewport_t text_size;
+                unsigned int glyph_count = emojivur_shape_text(&pshared, workloads[w].texts[t], -1,
+                                                               pxsize, &text_size);
+                emojis[t] = (emoji_to_render_t){
+                    .viewport = emojivur_page_layout(pshared.cairo_glyphs, glyph_count, text_size, pxsize),
+                    .font_face = pshared.cairo_font_face,
+                    .glyphs = pshared.cairo_glyphs,
+                    .glyph_count = glyph_count,
+                    .glyph_size = pxsize,
+                };
+                pshared.cairo_glyphs = NULL;
+                pshared.cairo_glyphs_allocated = 0;
+            }
+
+            for (bench_stage_t stage = 0; stage < BENCH_STAGE_COUNT; ++stage)
+            {
+                bench_samples_t samples = {0};
+                bench_run_stage(&pshared, stage, &workloads[w], emojis, pxsize, &options, &png_stream, &samples);
+                bench_report(&workloads[w], pxsize, stage, &samples, json_file, first);
+                free(samples.latencies_ns);
+                first = false;
+            }
+
+            for (size_t t = 0; t < workloads[w].text_count; ++t)
+            {
+                cairo_glyph_free(emojis[t].glyphs);
+            }
+            free(emojis);
+        }
+    }
+
+    if (json_file)
+    {
+        fprintf(json_file, "\n  ]\n}\n");
+        fclose(json_file);
+    }
+
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); ++w)
+    {
+        bench_workload_free(&workloads[w]);
+    }
+    emojivur_stream_free(&png_stream);
+    emojivur_release(&pshared);
+    cmdline_parser_free(&options);
+
+    return 0;
+}
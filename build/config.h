@@ -0,0 +1,35 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#define PACKAGE "emojivur"
+#define PACKAGE_NAME "emojivur"
+#define APP_NAME "emojivur"
+#define VERSION "0.1.0"
+#define APP_VERSION "0.1.0"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__OPTIMIZE__)
+#define likely(expr) (__builtin_expect(!!(expr), 1))
+#define unlikely(expr) (__builtin_expect(!!(expr), 0))
+#else
+#define likely(expr) (expr)
+#define unlikely(expr) (expr)
+#endif
+
+#define UNUSED(x) ((void)(x))
+#define MIN(a, b)               \
+    ({                          \
+        __typeof__(a) _a = (a); \
+        __typeof__(b) _b = (b); \
+        _a < _b ? _a : _b;      \
+    })
+#define MAX(a, b)               \
+    ({                          \
+        __typeof__(a) _a = (a); \
+        __typeof__(b) _b = (b); \
+        _a > _b ? _a : _b;      \
+    })
+
+#define MIN_WINDOW_WIDTH 320
+#define MIN_WINDOW_HEIGHT 240
+
+#endif // CONFIG_H
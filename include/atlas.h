@@ -0,0 +1,51 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       atlas.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Coverage sheet & sprite atlas of every emoji of a font
+//
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "cli_options.h"
+#include "emojivur.h"
+
+/*!
+ * \brief Render every emoji of the font on a grid of tiles, writing an index of the tiles as JSON
+ *
+ * Emojis are every codepoint mapped by the font plus every sequence of codepoints the
+ * font turns into a single glyph through a GSUB ligature. PNG output packs the tiles in
+ * an atlas (split in numbered images if larger than the maximum atlas size), while PDF
+ * output lays them out on a grid spanning as many pages as needed.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param format            Format of the output
+ * \param thread_count      Number of threads rendering (0 to use one for each CPU)
+ * \param output_filename   File name for the PDF (or PNG atlas) to create
+ * \param index_filename    File name of the JSON index mapping each sequence of codepoints to its tile (`-` for the standard output)
+ *
+ */
+void emojivur_atlas_output(emojivur_shared_ptrs_t *shared_data, unsigned int pxsize, enum enum_format format,
+                           int thread_count, char *output_filename, const char *index_filename);
+
+#endif // ATLAS_H
@@ -0,0 +1,86 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       batch.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Multi-threaded batch renderer
+//
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+
+#include "cli_options.h"
+#include "emojivur.h"
+
+/*!
+ * \brief Build the name of the file numbered `number` of a sequence of files named after `filename`
+ *
+ * \param buffer            Buffer to write the file name to
+ * \param size              Size of the buffer
+ * \param filename          Name of the file (e.g. "emoji.png")
+ * \param number            Number of the file in the sequence (e.g. 42 to get "emoji-000042.png")
+ *
+ */
+void emojivur_numbered_filename(char *buffer, size_t size, const char *filename, unsigned long number);
+
+/*!
+ * \brief Build the name of the file rendered at `pxsize` pixels of a set of files named after `filename`
+ *
+ * \param buffer            Buffer to write the file name to
+ * \param size              Size of the buffer
+ * \param filename          Name of the file (e.g. "emoji.png")
+ * \param pxsize            Size in pixels used to render the glyphs (e.g. 64 to get "emoji-64px.png")
+ *
+ */
+void emojivur_sized_filename(char *buffer, size_t size, const char *filename, unsigned int pxsize);
+
+/*!
+ * \brief Render a text at many sizes shaping it just once, on one PDF page (or PNG image) each
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param text              UTF-8 text to render
+ * \param pxsizes           Sizes in pixels to render the glyphs at
+ * \param pxsize_count      Number of sizes
+ * \param format            Format of the output
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ *
+ */
+void emojivur_sizes_output(emojivur_shared_ptrs_t *shared_data, const char *text, const int *pxsizes,
+                           unsigned int pxsize_count, enum enum_format format, char *output_filename);
+
+/*!
+ * \brief Render each line of a text file on its own PDF page (or PNG image) using a pool of threads
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param batch_filename    File name of the text file to read (`-` to read from the standard input)
+ * \param pxsizes           Sizes in pixels used to render the glyphs (one page or image each)
+ * \param pxsize_count      Number of sizes
+ * \param format            Format of the output
+ * \param thread_count      Number of threads rendering (0 to use one for each CPU)
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ *
+ */
+void emojivur_batch_output(emojivur_shared_ptrs_t *shared_data, char *batch_filename, const int *pxsizes,
+                           unsigned int pxsize_count, enum enum_format format, int thread_count,
+                           char *output_filename);
+
+#endif // BATCH_H
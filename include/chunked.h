@@ -0,0 +1,50 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       chunked.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Shaping & rendering of arbitrarily large texts chunk by chunk
+//
+#ifndef CHUNKED_H
+#define CHUNKED_H
+
+#include "cli_options.h"
+#include "emojivur.h"
+
+/*!
+ * \brief Render a text of any length read from a file, shaping and emitting it chunk by chunk
+ *
+ * The text is split in rows at line breaks and, when a line is too long, at cluster boundaries
+ * HarfBuzz marks safe to break. Rows are stacked on PDF pages (or PNG images) of a fixed number
+ * of rows, each one written as soon as it is full, so that memory usage does not depend on the
+ * length of the text and the output starts flowing right after the first page.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param text_filename     File with the UTF-8 text to render (`-` for the standard input)
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param format            Format of the output
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ *
+ */
+void emojivur_chunked_output(emojivur_shared_ptrs_t *shared_data, const char *text_filename, unsigned int pxsize,
+                             enum enum_format format, char *output_filename);
+
+#endif // CHUNKED_H
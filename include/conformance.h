@@ -0,0 +1,51 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       conformance.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Conformance of a font to the Unicode emoji-test.txt list
+//
+#ifndef CONFORMANCE_H
+#define CONFORMANCE_H
+
+#include <stdio.h>
+
+#include "emojivur.h"
+
+/*!
+ * \brief Shape every sequence listed by a Unicode emoji-test.txt file checking it turns into a single glyph
+ *
+ * Nothing gets rasterized: sequences are just shaped (in parallel) and their glyphs inspected.
+ * The report lists the fully-qualified and component sequences falling back to many glyphs or
+ * to `.notdef`, followed by a summary for each status of the sequences.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param test_filename     Path of the emoji-test.txt file (`-` for the standard input)
+ * \param thread_count      Number of threads shaping (0 to use one for each CPU)
+ * \param report_file       File to write the report to
+ *
+ * \return Number of fully-qualified and component sequences not rendered as a single glyph
+ *
+ */
+unsigned long emojivur_conformance_check(emojivur_shared_ptrs_t *shared_data, const char *test_filename,
+                                         int thread_count, FILE *report_file);
+
+#endif // CONFORMANCE_H
@@ -26,12 +26,25 @@
 #ifndef EMOJIVUR_H
 #define EMOJIVUR_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <SDL2/SDL.h>
+
 #include <harfbuzz/hb.h>
 #include <harfbuzz/hb-ot.h>
 
 #include <cairo/cairo.h>
 #include <cairo/cairo-ft.h>
 
+#include "font_chain.h"
+#include "glyph_cache.h"
+#include "glyph_index.h"
+#include "layout.h"
+#include "pdf_subset.h"
+#include "shape_cache.h"
+#include "stream.h"
+
 /*!
  * \brief A simple pair of width & height to define any viewport
  *
@@ -50,31 +63,133 @@ typedef struct
  */
 typedef struct
 {
-    emoji_viewport_t viewport;    /**< Size of the viewport covered by the Cairo surface */
-    cairo_font_face_t *font_face; /**< Cairo font face to use */
-    cairo_glyph_t *glyphs;        /**< Vector of Cairo glyphs to render */
-    unsigned int glyph_count;     /**< Number of Cairo glyphs to render */
-    unsigned int glyph_size;      /**< Size in pixels for the glyphs to render */
+    emoji_viewport_t viewport;            /**< Size of the viewport covered by the Cairo surface */
+    cairo_font_face_t *font_face;         /**< Cairo font face to use */
+    cairo_glyph_t *glyphs;                /**< Vector of Cairo glyphs to render */
+    unsigned int glyph_count;             /**< Number of Cairo glyphs to render */
+    unsigned int glyph_size;              /**< Size in pixels for the glyphs to render */
+    cairo_font_face_t *const *font_faces; /**< Font faces of a fallback chain (NULL if all glyphs use `font_face`) */
+    const uint8_t *glyph_fonts;           /**< Position in `font_faces` of the font of each glyph */
 } emoji_to_render_t;
 
+/*!
+ * \brief Part of the emojis shown by the window created by `emojivur_gui()`
+ *
+ * Only the glyphs found by the spatial index in the area being redrawn are handed over to Cairo,
+ * so that drawing a frame takes the same time however long the text is.
+ *
+ */
+typedef struct
+{
+    emojivur_glyph_index_t *glyph_index;    /**< Spatial index of the glyphs to display */
+    cairo_rectangle_t content;              /**< Bounding box of the glyphs */
+    cairo_rectangle_t *line_extents;        /**< Ink of each line of the laid out text (from its baseline) */
+    unsigned int line_extents_allocated;    /**< Number of lines whose extents fit in `line_extents` */
+    double scroll_x;                        /**< Horizontal position of the glyphs shown at the left edge of the window */
+    double scroll_y;                        /**< Vertical position of the glyphs shown at the top edge of the window */
+    double zoom;                            /**< Scale factor applied to the glyphs */
+    double wrap_width;                      /**< Width the laid out text was last wrapped at (0 if never) */
+    size_t caret;                           /**< Offset in the laid out text where typing inserts characters */
+    unsigned int glyphs_allocated;          /**< Number of glyphs that fit in the vector of glyphs displayed */
+    unsigned int *visible_ids;              /**< Positions of the glyphs found in the area being redrawn */
+    unsigned int visible_ids_allocated;     /**< Number of positions that fit in `visible_ids` */
+    cairo_glyph_t *visible_glyphs;          /**< Glyphs found in the area being redrawn moved to window coordinates */
+    unsigned int visible_glyphs_allocated;  /**< Number of glyphs that fit in `visible_glyphs` */
+} emojivur_gui_view_t;
+
 struct emojivur_shared_ptrs_temp
 {
+    // FreeType
+    FT_Library ft_library;
+
     // Cairo
     cairo_t *cairo_context;
     cairo_surface_t *cairo_surface;
     cairo_font_face_t *cairo_font_face;
     cairo_glyph_t *cairo_glyphs;
+    unsigned int cairo_glyphs_allocated;
+    emojivur_stream_t *output_stream;
+    emojivur_pdf_subset_t *pdf_subset;
+
+    // Rendering state recycled from one image to the next
+    cairo_t *image_context;
+    cairo_surface_t *image_surface;
+    emojivur_stream_t *image_stream;
 
     // HarfBuzz
+    hb_blob_t *harfbuzz_blob;
+    hb_face_t *harfbuzz_face;
     hb_font_t *harfbuzz_font;
     hb_buffer_t *tmp_buffer;
 
+    // Rasterized glyphs & shaped runs
+    emojivur_glyph_cache_t *glyph_cache;
+    emojivur_shape_cache_t *shape_cache;
+    emojivur_layout_t *layout;
+    emojivur_font_chain_t *font_chain;
+
     // SDL2
     SDL_Window *window;
     SDL_Renderer *renderer;
-    SDL_Surface *sdl_surface;
     SDL_Texture *sdl_texture;
-} emojivur_shared_ptrs_default = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    // Error reported by the last function failing without exiting
+    char *error_msg;
+};
 typedef struct emojivur_shared_ptrs_temp emojivur_shared_ptrs_t;
 
+extern const emojivur_shared_ptrs_t emojivur_shared_ptrs_default;
+extern bool emojivur_verbose;
+
+void emojivur_release(emojivur_shared_ptrs_t *shared_data);
+void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data);
+void emojivur_exit(emojivur_shared_ptrs_t *shared_data, char *error_msg, int exit_code);
+void emojivur_ptr_valid_or_exit(emojivur_shared_ptrs_t *shared_data, void *ptr, char *error_msg, int exit_code);
+bool emojivur_fail(emojivur_shared_ptrs_t *shared_data, char *error_msg);
+
+cairo_font_face_t *emojivur_font_face_create(FT_Library ft_library, hb_blob_t *harfbuzz_blob, unsigned int face_index);
+FT_Face emojivur_font_face_ft_face(cairo_font_face_t *cairo_font_face);
+void emojivur_load_font(emojivur_shared_ptrs_t *shared_data, const char *font_filename, unsigned int face_index);
+bool emojivur_try_shape_text(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                             unsigned int pxsize, emoji_viewport_t *text_size, unsigned int *glyph_count);
+unsigned int emojivur_shape_text(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                                 unsigned int pxsize, emoji_viewport_t *text_size);
+bool emojivur_try_shape_text_units(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                                   emoji_viewport_t *text_size, unsigned int *glyph_count);
+unsigned int emojivur_shape_text_units(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                                       emoji_viewport_t *text_size);
+emoji_viewport_t emojivur_scale_glyphs(const cairo_glyph_t *unit_glyphs, unsigned int glyph_count,
+                                       emoji_viewport_t unit_size, unsigned int units_per_em,
+                                       unsigned int pxsize, cairo_glyph_t *glyphs);
+bool emojivur_glyphs_reserve(cairo_glyph_t **glyphs, unsigned int *glyphs_allocated, unsigned int glyph_count);
+emoji_viewport_t emojivur_page_layout(cairo_glyph_t *glyphs, unsigned int glyph_count,
+                                      emoji_viewport_t text_size, unsigned int pxsize);
+
+void emojivur_show_glyphs(emojivur_glyph_cache_t *cache, cairo_t *cairo_context, emoji_to_render_t emoji,
+                          const cairo_glyph_t *glyphs, const unsigned int *glyph_ids, unsigned int glyph_count);
+
+bool emojivur_try_pdf_open(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport, char *pdf_filename);
+void emojivur_pdf_open(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport, char *pdf_filename);
+bool emojivur_try_pdf_open_stream(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport,
+                                  cairo_write_func_t write_func, void *closure);
+void emojivur_pdf_open_stream(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport,
+                              cairo_write_func_t write_func, void *closure);
+bool emojivur_try_pdf_page(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji);
+void emojivur_pdf_page(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji);
+bool emojivur_try_pdf_close(emojivur_shared_ptrs_t *shared_data);
+void emojivur_pdf_close(emojivur_shared_ptrs_t *shared_data);
+void emojivur_pdf_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *pdf_filename);
+bool emojivur_try_image_render(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji);
+void emojivur_image_render(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji);
+void emojivur_image_recycle(emojivur_shared_ptrs_t *shared_data);
+bool emojivur_try_png_surface_output(emojivur_shared_ptrs_t *shared_data, cairo_surface_t *surface,
+                                     char *png_filename);
+void emojivur_png_surface_output(emojivur_shared_ptrs_t *shared_data, cairo_surface_t *surface, char *png_filename);
+bool emojivur_try_png_file_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *png_filename);
+void emojivur_png_file_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *png_filename);
+void emojivur_png_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *png_filename);
+
+void emojivur_gui_content_changed(void);
+void emojivur_gui(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji);
+
 #endif // EMOJIVUR_H
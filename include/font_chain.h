@@ -0,0 +1,138 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       font_chain.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Ordered fonts falling back on each other, loaded only when needed
+//
+#ifndef FONT_CHAIN_H
+#define FONT_CHAIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <cairo/cairo.h>
+#include <harfbuzz/hb.h>
+
+// Most fonts a fallback chain can hold (the font of each glyph is kept in a byte)
+#define EMOJIVUR_FONT_CHAIN_MAX 256
+
+typedef struct emojivur_font_chain emojivur_font_chain_t;
+
+/*!
+ * \brief Split a font given on the command line in file name and face index
+ *
+ * A font is given as `FILENAME` or as `FILENAME:N` to pick the face `N` of a collection (e.g. a `.ttc` file).
+ *
+ * \param font_spec         Font as given on the command line
+ * \param font_filename     Buffer to write the file name of the font to
+ * \param size              Size of the buffer
+ * \param face_index        Index of the face in the font file (output)
+ *
+ * \return `true` on success, `false` if the file name does not fit the buffer
+ *
+ */
+bool emojivur_font_spec(const char *font_spec, char *font_filename, size_t size, unsigned int *face_index);
+
+/*!
+ * \brief Create a fallback chain starting with a font already loaded
+ *
+ * \param harfbuzz_font     HarfBuzz font of the first font (not owned: its scale applies to all fonts)
+ * \param cairo_font_face   Cairo font face of the first font (not owned)
+ *
+ * \return The new chain, NULL on failure
+ *
+ */
+emojivur_font_chain_t *emojivur_font_chain_create(hb_font_t *harfbuzz_font, cairo_font_face_t *cairo_font_face);
+
+/*!
+ * \brief Append a font to a fallback chain
+ *
+ * Only the codepoints the font covers are read now: the font is loaded by the first run of text needing it.
+ *
+ * \param chain             Chain to add the font to
+ * \param font_filename     File name of the font
+ * \param face_index        Index of the face in the font file
+ *
+ * \return `true` on success, `false` if the font cannot be read or the chain is full
+ *
+ */
+bool emojivur_font_chain_add(emojivur_font_chain_t *chain, const char *font_filename, unsigned int face_index);
+
+/*!
+ * \brief Destroy a fallback chain releasing the fonts it loaded
+ *
+ * \param chain             Chain to destroy (can be NULL)
+ *
+ */
+void emojivur_font_chain_destroy(emojivur_font_chain_t *chain);
+
+/*!
+ * \brief Get the number of fonts of a fallback chain
+ *
+ * \param chain             Chain
+ *
+ * \return Number of fonts
+ *
+ */
+unsigned int emojivur_font_chain_count(const emojivur_font_chain_t *chain);
+
+/*!
+ * \brief Find the run of text to shape with one font of a fallback chain
+ *
+ * Each cluster (a character with the marks, variation selectors, emoji modifiers and tags attached
+ * to it, or characters joined by a ZWJ) goes to the first font covering all of it, or else to the
+ * first font covering its first character. Clusters no font covers stay in the current run.
+ *
+ * \param chain             Chain
+ * \param text              UTF-8 text
+ * \param start             Offset of the run
+ * \param end               Offset of the end of the text to itemize
+ * \param font              Position in the chain of the font of the run (output)
+ *
+ * \return Offset of the end of the run
+ *
+ */
+size_t emojivur_font_chain_run(const emojivur_font_chain_t *chain, const char *text, size_t start, size_t end,
+                               unsigned int *font);
+
+/*!
+ * \brief Get the HarfBuzz font of a font of a fallback chain, loading the font first if needed
+ *
+ * \param chain             Chain
+ * \param font              Position of the font in the chain
+ *
+ * \return HarfBuzz font scaled like the first font of the chain
+ *
+ */
+hb_font_t *emojivur_font_chain_harfbuzz_font(emojivur_font_chain_t *chain, unsigned int font);
+
+/*!
+ * \brief Get the Cairo font faces of the fonts of a fallback chain
+ *
+ * \param chain             Chain
+ *
+ * \return Vector of font faces in chain order (NULL for fonts not loaded yet)
+ *
+ */
+cairo_font_face_t *const *emojivur_font_chain_cairo_font_faces(const emojivur_font_chain_t *chain);
+
+#endif // FONT_CHAIN_H
@@ -0,0 +1,99 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       glyph_cache.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      LRU cache of rasterized glyphs
+//
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <cairo/cairo.h>
+
+#include "glyph_file.h"
+
+typedef struct emojivur_glyph_cache emojivur_glyph_cache_t;
+
+/*!
+ * \brief Create an empty cache of rasterized glyphs
+ *
+ * The cache can be shared by many threads and it is reference counted.
+ *
+ * \param max_bytes         Memory the cached bitmaps can use at most
+ *
+ * \return The new cache (with a reference count of 1), NULL on failure
+ *
+ */
+emojivur_glyph_cache_t *emojivur_glyph_cache_create(size_t max_bytes);
+
+/*!
+ * \brief Get a new reference to a cache
+ *
+ * \param cache             Cache to reference (can be NULL)
+ *
+ * \return `cache`
+ *
+ */
+emojivur_glyph_cache_t *emojivur_glyph_cache_reference(emojivur_glyph_cache_t *cache);
+
+/*!
+ * \brief Persist the glyphs of a font face in glyph files, shared by all the runs rendering the same font
+ *
+ * \param cache             Cache to persist the glyphs of
+ * \param font_face         Font face whose glyphs are persisted
+ * \param font_id           Identity of the font of `font_face`
+ * \param directory         Directory of the glyph files (created if missing)
+ *
+ * \return `false` on failure
+ *
+ */
+bool emojivur_glyph_cache_persist(emojivur_glyph_cache_t *cache, const cairo_font_face_t *font_face,
+                                  const emojivur_font_id_t *font_id, const char *directory);
+
+/*!
+ * \brief Release a reference to a cache, destroying it together with its bitmaps when it is the last one
+ *
+ * \param cache             Cache to release (can be NULL)
+ *
+ */
+void emojivur_glyph_cache_destroy(emojivur_glyph_cache_t *cache);
+
+/*!
+ * \brief Draw glyphs like `cairo_show_glyphs()` compositing their cached bitmaps
+ *
+ * Bitmaps are keyed by font face, glyph index and size in device pixels: missing ones
+ * get rasterized and cached on first use. Whenever the context cannot be served from
+ * the cache (e.g. a rotated or scaled transformation, a non-image target, a source other
+ * than opaque black or no cache at all) `cairo_show_glyphs()` is used instead.
+ *
+ * \param cache             Cache to use (can be NULL)
+ * \param cairo_context     Cairo context to draw onto (with font face & size already set)
+ * \param glyphs            Vector of Cairo glyphs to draw
+ * \param glyph_count       Number of Cairo glyphs to draw
+ *
+ */
+void emojivur_glyph_cache_show_glyphs(emojivur_glyph_cache_t *cache, cairo_t *cairo_context,
+                                      const cairo_glyph_t *glyphs, int glyph_count);
+
+#endif // GLYPH_CACHE_H
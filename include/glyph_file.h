@@ -0,0 +1,118 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       glyph_file.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Glyph bitmaps persisted in memory mapped files across runs
+//
+#ifndef GLYPH_FILE_H
+#define GLYPH_FILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <harfbuzz/hb.h>
+
+#include <cairo/cairo.h>
+
+/*!
+ * \brief What identifies the contents of a font file (cached bitmaps are valid only for the same font)
+ *
+ */
+typedef struct
+{
+    uint64_t size;      /**< Size of the font file in bytes */
+    int64_t mtime_ns;   /**< Last modification time of the font file in nanoseconds */
+    uint32_t checksum;  /**< Whole font checksum (`checkSumAdjustment` of the `head` table) */
+    uint32_t face;      /**< Index of the face in the font file */
+} emojivur_font_id_t;
+
+typedef struct emojivur_glyph_file emojivur_glyph_file_t;
+
+/*!
+ * \brief Identify the contents of a font file
+ *
+ * \param font_filename     File name of the font
+ * \param harfbuzz_face     HarfBuzz face loaded from the font file
+ * \param face              Index of the face in the font file
+ * \param font_id           Identity of the font (output)
+ *
+ * \return `false` if the font file cannot be identified
+ *
+ */
+bool emojivur_font_id(const char *font_filename, hb_face_t *harfbuzz_face, unsigned int face,
+                      emojivur_font_id_t *font_id);
+
+/*!
+ * \brief Open (creating it if needed) the file of the bitmaps of a font at a given size
+ *
+ * The file is named after the font identity and the size and it is mapped in memory:
+ * bitmaps already stored are served straight from the mapping. Files left by a different
+ * version of the font are replaced.
+ *
+ * \param directory         Directory of the glyph files (created if missing)
+ * \param font_id           Identity of the font
+ * \param size              Size of the glyphs in 1/64 of device pixel
+ *
+ * \return The glyph file, NULL if it cannot be used
+ *
+ */
+emojivur_glyph_file_t *emojivur_glyph_file_open(const char *directory, const emojivur_font_id_t *font_id,
+                                                int32_t size);
+
+/*!
+ * \brief Find the bitmap of a glyph in a glyph file
+ *
+ * \param file              Glyph file to search
+ * \param index             Index of the glyph in the font
+ * \param bitmap            Bitmap of the glyph (output, NULL for blank glyphs, to be released
+ *                          with `cairo_surface_destroy()` before closing the file)
+ * \param x_bearing         Device pixels from the glyph origin to the left edge of the bitmap (output)
+ * \param y_bearing         Device pixels from the glyph origin to the top edge of the bitmap (output)
+ *
+ * \return `true` if the glyph is in the file
+ *
+ */
+bool emojivur_glyph_file_lookup(emojivur_glyph_file_t *file, unsigned long index,
+                                cairo_surface_t **bitmap, int *x_bearing, int *y_bearing);
+
+/*!
+ * \brief Add the bitmap of a glyph to a glyph file (it is written when the file gets closed)
+ *
+ * \param file              Glyph file to add the glyph to
+ * \param index             Index of the glyph in the font
+ * \param bitmap            ARGB32 bitmap of the glyph (NULL for blank glyphs)
+ * \param x_bearing         Device pixels from the glyph origin to the left edge of the bitmap
+ * \param y_bearing         Device pixels from the glyph origin to the top edge of the bitmap
+ *
+ */
+void emojivur_glyph_file_add(emojivur_glyph_file_t *file, unsigned long index,
+                             cairo_surface_t *bitmap, int x_bearing, int y_bearing);
+
+/*!
+ * \brief Write the glyphs added to a glyph file and close it
+ *
+ * \param file              Glyph file to close (can be NULL)
+ *
+ */
+void emojivur_glyph_file_close(emojivur_glyph_file_t *file);
+
+#endif // GLYPH_FILE_H
@@ -0,0 +1,97 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       glyph_index.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Spatial index of laid out glyphs
+//
+#ifndef GLYPH_INDEX_H
+#define GLYPH_INDEX_H
+
+#include <stdbool.h>
+
+#include <cairo/cairo.h>
+
+typedef struct emojivur_glyph_index emojivur_glyph_index_t;
+
+/*!
+ * \brief Index the glyphs of a layout on a uniform grid, so that the ones falling in any area are found quickly
+ *
+ * \param glyphs            Vector of Cairo glyphs to index (the index keeps no reference to it)
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param cell_size         Size of the cells of the grid (in the same unit as the glyph positions)
+ * \param reach             How far the ink of a glyph can get from its origin
+ *
+ * \return The new index, NULL on failure
+ *
+ */
+emojivur_glyph_index_t *emojivur_glyph_index_create(const cairo_glyph_t *glyphs, unsigned int glyph_count,
+                                                    double cell_size, double reach);
+
+/*!
+ * \brief Index again the glyphs of a layout after an edit, sorting only the entries of the glyphs which changed
+ *
+ * \param index             Index of the glyphs before the edit (destroyed on success)
+ * \param glyphs            Vector of Cairo glyphs edited (the index keeps no reference to it)
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param first_glyph       First glyph edited (the ones before it stay where they were)
+ * \param end_glyph         Glyph after the last one edited (the ones from it on are the ones indexed from
+ *                          `end_glyph - glyph_delta` on, wherever they moved)
+ * \param glyph_delta       Change in the number of glyphs
+ *
+ * \return The updated index, NULL on failure (the index passed is left untouched)
+ *
+ */
+emojivur_glyph_index_t *emojivur_glyph_index_update(emojivur_glyph_index_t *index, const cairo_glyph_t *glyphs,
+                                                    unsigned int glyph_count, unsigned int first_glyph,
+                                                    unsigned int end_glyph, int glyph_delta);
+
+/*!
+ * \brief Destroy an index
+ *
+ * \param index             Index to destroy (can be NULL)
+ *
+ */
+void emojivur_glyph_index_destroy(emojivur_glyph_index_t *index);
+
+/*!
+ * \brief Find the glyphs which can be visible in an area
+ *
+ * Glyphs are found in the order they are laid out, so that overlapping glyphs are drawn as usual.
+ * The cost depends on the size of the area and on the glyphs found, not on the glyphs indexed.
+ *
+ * \param index             Index to search
+ * \param x0                Left edge of the area
+ * \param y0                Top edge of the area
+ * \param x1                Right edge of the area
+ * \param y1                Bottom edge of the area
+ * \param glyph_ids         Vector of the positions of the glyphs found (grown with `realloc()` as needed)
+ * \param glyph_ids_allocated Number of positions that fit in `*glyph_ids` (updated when grown)
+ * \param glyph_id_count    Number of glyphs found (output)
+ *
+ * \return `false` if out of memory
+ *
+ */
+bool emojivur_glyph_index_query(const emojivur_glyph_index_t *index, double x0, double y0, double x1, double y1,
+                                unsigned int **glyph_ids, unsigned int *glyph_ids_allocated,
+                                unsigned int *glyph_id_count);
+
+#endif // GLYPH_INDEX_H
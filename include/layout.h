@@ -0,0 +1,232 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       layout.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Text laid out on many lines, wrapped again without shaping it again
+//
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cairo/cairo.h>
+#include <harfbuzz/hb.h>
+
+#include "font_chain.h"
+
+typedef struct emojivur_layout emojivur_layout_t;
+
+/*!
+ * \brief Shape a text once, one paragraph (i.e. text between hard line breaks) at a time
+ *
+ * Advances, clusters and line break opportunities of the glyphs are kept, so that
+ * `emojivur_layout_wrap()` can break the paragraphs in lines of any width afterwards, and
+ * `emojivur_layout_edit()` can shape again only the clusters an edit changes. A hard line break
+ * closing the text starts an empty last line.
+ *
+ * \param font_chain        Fonts to shape the text with (scaled to the size of the glyphs)
+ * \param buffer            HarfBuzz buffer to shape the paragraphs with
+ * \param text              UTF-8 text to lay out (copied)
+ * \param text_length       Length of the text in bytes (-1 if the text is NUL terminated)
+ * \param line_height       Distance between the baselines of two lines
+ *
+ * \return The new layout (wrapped on no width limit), NULL on failure
+ *
+ */
+emojivur_layout_t *emojivur_layout_create(emojivur_font_chain_t *font_chain, hb_buffer_t *buffer, const char *text,
+                                          int text_length, double line_height);
+
+/*!
+ * \brief Destroy a layout
+ *
+ * \param layout            Layout to destroy (can be NULL)
+ *
+ */
+void emojivur_layout_destroy(emojivur_layout_t *layout);
+
+/*!
+ * \brief Get the number of glyphs of a layout (the same whatever the width it is wrapped at)
+ *
+ * \param layout            Layout
+ *
+ * \return Number of glyphs
+ *
+ */
+unsigned int emojivur_layout_glyph_count(const emojivur_layout_t *layout);
+
+/*!
+ * \brief Get the fonts the glyphs of a layout come from
+ *
+ * \param layout            Layout
+ *
+ * \return Position in the font chain of the font of each glyph (NULL if the chain has one font only)
+ *
+ */
+const uint8_t *emojivur_layout_glyph_fonts(const emojivur_layout_t *layout);
+
+/*!
+ * \brief Break the paragraphs of a layout in lines no wider than a width
+ *
+ * Lines are filled greedily and broken at the last opportunity fitting the width, spaces
+ * at the end of a line hanging past it. Only the advances kept are added up: no text is shaped.
+ *
+ * \param layout            Layout to wrap
+ * \param width             Width of the lines (INFINITY to break lines at hard line breaks only)
+ *
+ * \return Number of lines, 0 on failure
+ *
+ */
+unsigned int emojivur_layout_wrap(emojivur_layout_t *layout, double width);
+
+/*!
+ * \brief Replace part of the text of a layout, shaping again only the clusters the edit changes
+ *
+ * Within a paragraph, shaping starts at the cluster before the edit and ends at the cluster after it,
+ * both widened to the nearest glyphs HarfBuzz marks safe to break at: the glyphs outside of them
+ * are kept as they are, just moved by the change in the advances. Edits bringing or taking away
+ * hard line breaks shape again the paragraphs they touch (and the one before them) only.
+ * Line break opportunities are found again only around the edit, and lines are broken again at the
+ * same width as before only from the line before the one of the first glyph changed to the end of
+ * the paragraphs edited.
+ *
+ * \param layout            Layout to edit
+ * \param buffer            HarfBuzz buffer to shape the text with
+ * \param offset            Offset of the text to replace (clamped to the length of the text)
+ * \param removed           Length in bytes of the text to replace
+ * \param inserted          UTF-8 text to insert in its place
+ * \param inserted_length   Length of the text to insert in bytes
+ * \param first_line        First line broken again (output): the lines and glyphs before it are left untouched
+ * \param end_line          Line after the last one broken again (output): the lines from it on hold the same
+ *                          glyphs as before, moved by the change in the number of glyphs and of lines
+ *
+ * \return `true` on success, `false` if out of memory (the layout has to be destroyed)
+ *
+ */
+bool emojivur_layout_edit(emojivur_layout_t *layout, hb_buffer_t *buffer, size_t offset, size_t removed,
+                          const char *inserted, size_t inserted_length, unsigned int *first_line,
+                          unsigned int *end_line);
+
+/*!
+ * \brief Get the length of the text of a layout
+ *
+ * \param layout            Layout
+ *
+ * \return Length of the text in bytes
+ *
+ */
+size_t emojivur_layout_text_length(const emojivur_layout_t *layout);
+
+/*!
+ * \brief Find where the cluster after an offset of the text of a layout starts
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ *
+ * \return Offset of the next cluster (or of the next paragraph, or the end of the text)
+ *
+ */
+size_t emojivur_layout_cluster_after(const emojivur_layout_t *layout, size_t offset);
+
+/*!
+ * \brief Find where the cluster before an offset of the text of a layout starts
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ *
+ * \return Offset of the previous cluster (or of the end of the previous paragraph, or 0)
+ *
+ */
+size_t emojivur_layout_cluster_before(const emojivur_layout_t *layout, size_t offset);
+
+/*!
+ * \brief Get the width of the widest line of a layout (hanging spaces excluded)
+ *
+ * \param layout            Layout
+ *
+ * \return Width of the widest line
+ *
+ */
+double emojivur_layout_width(const emojivur_layout_t *layout);
+
+/*!
+ * \brief Get the number of lines of a layout
+ *
+ * \param layout            Layout
+ *
+ * \return Number of lines
+ *
+ */
+unsigned int emojivur_layout_line_count(const emojivur_layout_t *layout);
+
+/*!
+ * \brief Get the first glyph of a line
+ *
+ * \param layout            Layout
+ * \param line              Line (clamped to the last one)
+ *
+ * \return Position of the glyph (the one of the next line for empty lines)
+ *
+ */
+unsigned int emojivur_layout_line_glyph(const emojivur_layout_t *layout, unsigned int line);
+
+/*!
+ * \brief Get the line a glyph lies on
+ *
+ * \param layout            Layout
+ * \param glyph             Position of the glyph
+ *
+ * \return Line of the glyph
+ *
+ */
+unsigned int emojivur_layout_glyph_line(const emojivur_layout_t *layout, unsigned int glyph);
+
+/*!
+ * \brief Get where a caret before an offset of the text of a layout is shown
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ * \param first_baseline    Vertical position of the baseline of the first line
+ * \param x                 Horizontal position of the caret (output)
+ * \param baseline          Vertical position of the baseline of the line of the caret (output)
+ *
+ */
+void emojivur_layout_caret(const emojivur_layout_t *layout, size_t offset, double first_baseline, double *x,
+                           double *baseline);
+
+/*!
+ * \brief Position the glyphs of a layout line after line
+ *
+ * Glyphs are laid out just like a text shaped on one line from the origin, each line below the one before.
+ * Only the glyphs from a line on are positioned, so that those of the lines before an edit are left alone.
+ *
+ * \param layout            Layout
+ * \param first_line        First line whose glyphs are positioned
+ * \param first_baseline    Vertical position of the baseline of the first line of the layout
+ * \param glyphs            Vector of `emojivur_layout_glyph_count()` Cairo glyphs (output)
+ *
+ */
+void emojivur_layout_glyphs(const emojivur_layout_t *layout, unsigned int first_line, double first_baseline,
+                            cairo_glyph_t *glyphs);
+
+#endif // LAYOUT_H
@@ -0,0 +1,86 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       line_break.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Line break opportunities of a text (after Unicode UAX #14)
+//
+#ifndef LINE_BREAK_H
+#define LINE_BREAK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * \brief Line break opportunity before a character
+ *
+ */
+typedef enum
+{
+    EMOJIVUR_BREAK_NONE,      /**< Line cannot be broken before the character */
+    EMOJIVUR_BREAK_ALLOWED,   /**< Line can be broken before the character */
+    EMOJIVUR_BREAK_MANDATORY, /**< Line must be broken before the character (it follows a line break) */
+} emojivur_break_t;
+
+/*!
+ * \brief Decode the next character of a UTF-8 text
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param offset            Offset of the character (moved past it)
+ *
+ * \return Codepoint of the character (U+FFFD for malformed sequences, skipping one byte)
+ *
+ */
+uint32_t emojivur_utf8_next(const char *text, size_t text_length, size_t *offset);
+
+/*!
+ * \brief Find the line break opportunities of a UTF-8 text
+ *
+ * Follows the rules of UAX #14 (Unicode Line Breaking Algorithm) relevant to texts made
+ * of emojis, words and punctuation: characters are sorted into line breaking classes by
+ * a compact table of ranges rather than by the full Unicode Character Database.
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param breaks            Vector of `text_length` opportunities, one before each byte (output: bytes
+ *                          continuing a character get `EMOJIVUR_BREAK_NONE`)
+ *
+ */
+void emojivur_line_breaks(const char *text, size_t text_length, uint8_t *breaks);
+
+/*!
+ * \brief Find again the line break opportunities of a UTF-8 text around a range of it which changed
+ *
+ * The opportunities elsewhere have to be the ones of the text before the change (moved with the text
+ * after the range): only the characters from the last one before the range leaving nothing for the
+ * next ones to depend on, to the first one past the range doing the same, are gone through again.
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param breaks            Vector of `text_length` opportunities, one before each byte (updated)
+ * \param start             Offset of the range (output: offset of the first opportunity found again)
+ * \param end               Offset of the end of the range (output: offset past the last opportunity found again)
+ *
+ */
+void emojivur_line_breaks_update(const char *text, size_t text_length, uint8_t *breaks, size_t *start, size_t *end);
+
+#endif // LINE_BREAK_H
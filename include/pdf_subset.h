@@ -0,0 +1,122 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       pdf_subset.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Fonts of a PDF document cut down to the glyphs its pages show
+//
+#ifndef PDF_SUBSET_H
+#define PDF_SUBSET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cairo/cairo.h>
+
+typedef struct emojivur_pdf_subset emojivur_pdf_subset_t;
+
+/*!
+ * \brief Page of a PDF document held back until the fonts are subset
+ *
+ */
+typedef struct
+{
+    unsigned int width;                   /**< Width of the page */
+    unsigned int height;                  /**< Height of the page */
+    unsigned int glyph_size;              /**< Size in pixels for the glyphs to render */
+    cairo_font_face_t *font_face;         /**< Font face the page starts with */
+    cairo_font_face_t *const *font_faces; /**< Font faces the glyphs are shown with */
+    const uint8_t *glyph_fonts;           /**< Position in `font_faces` of the font of each glyph */
+    const cairo_glyph_t *glyphs;          /**< Vector of Cairo glyphs to render */
+    unsigned int glyph_count;             /**< Number of Cairo glyphs to render */
+} emojivur_pdf_subset_page_t;
+
+/*!
+ * \brief Create an empty PDF document waiting for pages
+ *
+ * \return The new document, NULL on failure (or if HarfBuzz was built without its subsetter)
+ *
+ */
+emojivur_pdf_subset_t *emojivur_pdf_subset_create(void);
+
+/*!
+ * \brief Hold a page back taking note of the glyphs it shows with each font
+ *
+ * Glyphs are copied: the page is kept in memory until the document is complete.
+ *
+ * \param subset            Document to add the page to
+ * \param page              Page (with `font_faces` NULL if all glyphs use `font_face`)
+ *
+ * \return `true` on success, `false` if out of memory or showing too many fonts
+ *
+ */
+bool emojivur_pdf_subset_add_page(emojivur_pdf_subset_t *subset, emojivur_pdf_subset_page_t page);
+
+/*!
+ * \brief Subset every font of the document to the glyphs of all its pages
+ *
+ * Each font gets a single subset shared by all pages, so that it is embedded in the PDF document only once.
+ * Glyph indices are retained and color tables (`CBDT`, `sbix`, `COLR`) are kept: pages are shown unchanged.
+ * Fonts which cannot be subset are embedded as they are.
+ *
+ * \param subset            Document
+ *
+ */
+void emojivur_pdf_subset_build(emojivur_pdf_subset_t *subset);
+
+/*!
+ * \brief Get the number of pages held back
+ *
+ * \param subset            Document
+ *
+ * \return Number of pages
+ *
+ */
+unsigned int emojivur_pdf_subset_page_count(const emojivur_pdf_subset_t *subset);
+
+/*!
+ * \brief Get a page held back showing its glyphs with the subset fonts
+ *
+ * \param subset            Document (already built)
+ * \param page              Position of the page
+ *
+ * \return Page, valid until the document is cleared
+ *
+ */
+emojivur_pdf_subset_page_t emojivur_pdf_subset_page(const emojivur_pdf_subset_t *subset, unsigned int page);
+
+/*!
+ * \brief Drop pages and fonts making the document ready for the pages of the next one
+ *
+ * \param subset            Document
+ *
+ */
+void emojivur_pdf_subset_clear(emojivur_pdf_subset_t *subset);
+
+/*!
+ * \brief Destroy a document releasing its pages and fonts
+ *
+ * \param subset            Document to destroy (can be NULL)
+ *
+ */
+void emojivur_pdf_subset_destroy(emojivur_pdf_subset_t *subset);
+
+#endif // PDF_SUBSET_H
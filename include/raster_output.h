@@ -0,0 +1,77 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       raster_output.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Raster (PNG) output backend
+//
+#ifndef RASTER_OUTPUT_H
+#define RASTER_OUTPUT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <cairo/cairo.h>
+
+/*!
+ * \brief Convert Cairo premultiplied ARGB32 pixels to straight alpha RGBA bytes in place
+ *
+ * \param data              Pixels of a Cairo ARGB32 image
+ * \param width             Width of the image in pixels
+ * \param height            Height of the image in pixels
+ * \param stride            Number of bytes between the beginning of two consecutive rows
+ *
+ */
+void emojivur_argb32_to_rgba(unsigned char *data, int width, int height, int stride);
+
+/*!
+ * \brief Write a Cairo ARGB32 image surface as PNG image
+ *
+ * \param surface           Cairo ARGB32 image surface to write (its pixels get converted in place)
+ * \param png_file          File to write the PNG image to
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+bool emojivur_png_write(cairo_surface_t *surface, FILE *png_file);
+
+/*!
+ * \brief Write a Cairo ARGB32 image surface as PNG image through a write function
+ *
+ * \param surface           Cairo ARGB32 image surface to write (its pixels get converted in place)
+ * \param write_func        Function the bytes of the PNG image are handed over to
+ * \param closure           Closure passed to `write_func`
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+bool emojivur_png_write_stream(cairo_surface_t *surface, cairo_write_func_t write_func, void *closure);
+
+/*!
+ * \brief Release the memory used to encode PNG images by the calling thread
+ *
+ * The memory is kept from one image to the next: every thread writing PNG images
+ * should call this function once done.
+ *
+ */
+void emojivur_png_release(void);
+
+#endif // RASTER_OUTPUT_H
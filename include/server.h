@@ -0,0 +1,69 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       server.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Render daemon serving requests over a Unix domain socket
+//
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+
+#include "cli_options.h"
+
+/*!
+ * \brief Keep fonts loaded and render the texts requested by clients over a Unix domain socket
+ *
+ * Every connection is served by its own thread and can send any number of requests, one per line
+ * (up to 64 connections at the same time, further clients wait to be accepted):
+ *
+ *     <pdf|png> <font id> <pxsize> <text>\n
+ *
+ * where the font id is the position of the font in `font_filenames`. Each request is answered with
+ * `OK <length>\n` followed by `length` bytes of PDF document (or PNG image), or with `ERROR <message>\n`.
+ * The server runs until it gets SIGINT or SIGTERM.
+ *
+ * \param socket_path       Path of the Unix domain socket to listen on
+ * \param font_filenames    File names of the fonts to load
+ * \param font_count        Number of fonts to load
+ * \param glyph_cache_size  Memory in bytes used to cache the rasterized glyphs (0 to disable the cache)
+ * \param shape_cache_size  Memory in bytes used to cache the shaped runs (0 to disable the cache)
+ *
+ */
+void emojivur_server(const char *socket_path, char **font_filenames, unsigned int font_count,
+                     size_t glyph_cache_size, size_t shape_cache_size);
+
+/*!
+ * \brief Ask a render daemon to render a text and write the result to a file
+ *
+ * \param socket_path       Path of the Unix domain socket the server listens on
+ * \param format            Format of the output
+ * \param font_id           Position of the font to use in the list loaded by the server
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param text              UTF-8 text to render (on one line)
+ * \param output_filename   File name for the PDF (or PNG) to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ */
+void emojivur_client_output(const char *socket_path, enum enum_format format, int font_id,
+                            unsigned int pxsize, const char *text, const char *output_filename);
+
+#endif // SERVER_H
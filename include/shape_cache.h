@@ -0,0 +1,118 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       shape_cache.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      LRU cache of shaped runs of text
+//
+#ifndef SHAPE_CACHE_H
+#define SHAPE_CACHE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <harfbuzz/hb.h>
+
+#include <cairo/cairo.h>
+
+typedef struct emojivur_shape_cache emojivur_shape_cache_t;
+
+/*!
+ * \brief Everything the result of shaping a run of text depends on
+ *
+ */
+typedef struct
+{
+    hb_face_t *face;            /**< HarfBuzz face used to shape */
+    int x_scale;                /**< Horizontal scale of the HarfBuzz font */
+    int y_scale;                /**< Vertical scale of the HarfBuzz font */
+    unsigned int pxsize;        /**< Size in pixels used to render the glyphs */
+    hb_direction_t direction;   /**< Direction of the text */
+    hb_script_t script;         /**< Script of the text */
+    hb_language_t language;     /**< Language of the text */
+    const char *text;           /**< UTF-8 text (not NUL terminated) */
+    size_t text_length;         /**< Length of the text in bytes */
+} emojivur_shape_key_t;
+
+/*!
+ * \brief Create an empty cache of shaped runs
+ *
+ * The cache can be shared by many threads and it is reference counted.
+ *
+ * \param max_bytes         Memory the cached runs can use at most
+ *
+ * \return The new cache (with a reference count of 1), NULL on failure
+ *
+ */
+emojivur_shape_cache_t *emojivur_shape_cache_create(size_t max_bytes);
+
+/*!
+ * \brief Get a new reference to a cache
+ *
+ * \param cache             Cache to reference (can be NULL)
+ *
+ * \return `cache`
+ *
+ */
+emojivur_shape_cache_t *emojivur_shape_cache_reference(emojivur_shape_cache_t *cache);
+
+/*!
+ * \brief Release a reference to a cache, destroying it together with its runs when it is the last one
+ *
+ * \param cache             Cache to release (can be NULL)
+ *
+ */
+void emojivur_shape_cache_destroy(emojivur_shape_cache_t *cache);
+
+/*!
+ * \brief Look a shaped run up, copying its glyphs on a hit
+ *
+ * \param cache             Cache to look into (can be NULL)
+ * \param key               What the run has been shaped from
+ * \param glyphs            Vector of Cairo glyphs the run is copied to, laid out from the origin (grown if needed)
+ * \param glyphs_allocated  Number of Cairo glyphs that fit in `glyphs` (updated when it grows)
+ * \param glyph_count       Number of Cairo glyphs copied (output)
+ * \param text_width        Width in pixels of the shaped text (output)
+ * \param text_height       Height in pixels of the shaped text (output)
+ *
+ * \return `true` on a hit, `false` if the run has to be shaped
+ *
+ */
+bool emojivur_shape_cache_lookup(emojivur_shape_cache_t *cache, const emojivur_shape_key_t *key,
+                                 cairo_glyph_t **glyphs, unsigned int *glyphs_allocated, unsigned int *glyph_count,
+                                 unsigned int *text_width, unsigned int *text_height);
+
+/*!
+ * \brief Add a shaped run to a cache, evicting the least recently used ones to make room for it
+ *
+ * \param cache             Cache to add the run to (can be NULL)
+ * \param key               What the run has been shaped from
+ * \param glyphs            Vector of Cairo glyphs laid out from the origin (copied)
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param text_width        Width in pixels of the shaped text
+ * \param text_height       Height in pixels of the shaped text
+ *
+ */
+void emojivur_shape_cache_add(emojivur_shape_cache_t *cache, const emojivur_shape_key_t *key,
+                              const cairo_glyph_t *glyphs, unsigned int glyph_count,
+                              unsigned int text_width, unsigned int text_height);
+
+#endif // SHAPE_CACHE_H
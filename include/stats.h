@@ -0,0 +1,84 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       stats.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Per-stage timing and allocation statistics
+//
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * \brief Stages of the rendering pipeline being measured
+ *
+ */
+typedef enum
+{
+    EMOJIVUR_STAGE_FONT_LOAD, /**< Loading font file, HarfBuzz & Cairo font faces */
+    EMOJIVUR_STAGE_SHAPE,     /**< Shaping the text with HarfBuzz */
+    EMOJIVUR_STAGE_GLYPHS,    /**< Building the vector of Cairo glyphs */
+    EMOJIVUR_STAGE_RENDER,    /**< Rendering the glyphs with Cairo */
+    EMOJIVUR_STAGE_OUTPUT,    /**< Emitting the result (PDF pages & document, PNG images) */
+    EMOJIVUR_STAGE_COUNT,
+    EMOJIVUR_STAGE_NONE = EMOJIVUR_STAGE_COUNT,
+} emojivur_stage_t;
+
+/*!
+ * \brief Events being counted
+ *
+ */
+typedef enum
+{
+    EMOJIVUR_COUNTER_SHAPE_CACHE_HITS,      /**< Runs of text found in the shape cache */
+    EMOJIVUR_COUNTER_SHAPE_CACHE_MISSES,    /**< Runs of text shaped by HarfBuzz for lack of a cached run */
+    EMOJIVUR_COUNTER_SHAPE_CACHE_EVICTIONS, /**< Runs of text evicted from the shape cache */
+    EMOJIVUR_COUNTER_COUNT,
+} emojivur_counter_t;
+
+/*!
+ * \brief Running measurement of a stage started by `emojivur_stats_start()`
+ *
+ */
+typedef struct
+{
+    emojivur_stage_t stage;    /**< Stage being measured */
+    emojivur_stage_t previous; /**< Stage being measured before this one started */
+    uint64_t start_ns;         /**< Monotonic time when the stage started */
+} emojivur_stats_timer_t;
+
+void emojivur_stats_enable(void);
+bool emojivur_stats_enabled(void);
+uint64_t emojivur_stats_now(void);
+emojivur_stats_timer_t emojivur_stats_start(emojivur_stage_t stage);
+void emojivur_stats_stop(emojivur_stats_timer_t *timer);
+void emojivur_stats_count(emojivur_counter_t counter, uint64_t count);
+uint64_t emojivur_stats_counter(emojivur_counter_t counter);
+bool emojivur_stats_count_allocations(uint64_t *allocations, uint64_t *allocated_bytes);
+void emojivur_stats_hook_allocations(void);
+void emojivur_stats_allocation(size_t size);
+void emojivur_stats_report(FILE *report_file);
+void emojivur_stats_report_at_exit(const char *report_filename);
+
+#endif // STATS_H
@@ -0,0 +1,105 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       stream.h
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Byte streams Cairo can write documents to
+//
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <cairo/cairo.h>
+
+/*!
+ * \brief Bytes written by Cairo collected in memory or buffered on their way to a file descriptor
+ *
+ */
+typedef struct
+{
+    unsigned char *data;    /**< Bytes written so far (still to be flushed when writing to a file descriptor) */
+    size_t length;          /**< Number of bytes in `data` */
+    size_t allocated;       /**< Number of bytes that fit in `data` */
+    int fd;                 /**< File descriptor the bytes are flushed to (-1 to keep them in memory) */
+    bool failed;            /**< Whether a write failed (the stream is unusable from then on) */
+} emojivur_stream_t;
+
+/*!
+ * \brief Empty stream to write to memory
+ *
+ */
+extern const emojivur_stream_t emojivur_stream_default;
+
+/*!
+ * \brief Get the file descriptor an output file name refers to, if any
+ *
+ * \param filename          Output file name (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ * \return File descriptor to write to, -1 if `filename` names a regular file
+ *
+ */
+int emojivur_output_fd(const char *filename);
+
+/*!
+ * \brief Append bytes to a stream (suitable as `cairo_write_func_t`)
+ *
+ * \param closure           Stream to write to
+ * \param data              Bytes to write
+ * \param length            Number of bytes to write
+ *
+ * \return `CAIRO_STATUS_SUCCESS`, `CAIRO_STATUS_WRITE_ERROR` on failure
+ *
+ */
+cairo_status_t emojivur_stream_write(void *closure, const unsigned char *data, unsigned int length);
+
+/*!
+ * \brief Write the bytes buffered by a stream to its file descriptor
+ *
+ * \param stream            Stream to flush (nothing to do for memory streams)
+ *
+ * \return `true` if every byte written to the stream so far reached its destination, `false` otherwise
+ *
+ */
+bool emojivur_stream_flush(emojivur_stream_t *stream);
+
+/*!
+ * \brief Release the memory of a stream, leaving it empty (buffered bytes are not flushed)
+ *
+ * \param stream            Stream to release
+ *
+ */
+void emojivur_stream_free(emojivur_stream_t *stream);
+
+/*!
+ * \brief Write all the bytes provided to a file descriptor (retrying after partial writes and signals)
+ *
+ * \param fd                File descriptor to write to
+ * \param data              Bytes to write
+ * \param length            Number of bytes to write
+ *
+ * \return `true` on success, `false` otherwise (`errno` tells why)
+ *
+ */
+bool emojivur_write_all(int fd, const void *data, size_t length);
+
+#endif // STREAM_H
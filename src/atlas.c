@@ -0,0 +1,907 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       atlas.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Coverage sheet & sprite atlas of every emoji of a font
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <harfbuzz/hb.h>
+#include <harfbuzz/hb-ot.h>
+
+#include <cairo/cairo.h>
+#include <cairo/cairo-pdf.h>
+
+#include "config.h"
+#include "emojivur.h"
+#include "batch.h"
+#include "stats.h"
+#include "atlas.h"
+
+// Largest width (or height) in pixels of one PNG atlas image
+#define ATLAS_MAX_SIZE 8192
+
+// Grid of tiles on each page of a PDF coverage sheet
+#define ATLAS_PDF_COLUMNS 10
+#define ATLAS_PDF_ROWS 14
+
+// GSUB lookup types of interest
+#define GSUB_LIGATURE_SUBST 4
+#define GSUB_EXTENSION_SUBST 7
+
+/*!
+ * \brief One emoji of the font and the tile it is rendered onto
+ *
+ */
+typedef struct
+{
+    uint32_t *codepoints;      /**< Sequence of codepoints of the emoji */
+    unsigned int codepoint_count; /**< Number of codepoints in the sequence */
+    char *text;                /**< Sequence of codepoints encoded as UTF-8 */
+    size_t text_length;        /**< Length of the text in bytes */
+    cairo_glyph_t *glyphs;     /**< Shaped glyphs laid out on a page of their own (NULL if not a single glyph) */
+    unsigned int glyph_count;  /**< Number of shaped glyphs */
+    emoji_viewport_t viewport; /**< Size of the page the glyphs are laid out on */
+    unsigned int page;         /**< Page (or atlas image) of the tile starting from 0 */
+    unsigned int x;            /**< Left edge of the tile in pixels */
+    unsigned int y;            /**< Top edge of the tile in pixels */
+} emojivur_atlas_tile_t;
+
+/*!
+ * \brief State shared by the threads shaping and rendering the tiles
+ *
+ */
+typedef struct
+{
+    // Read-only data shared by all threads
+    hb_face_t *harfbuzz_face;            /**< Immutable HarfBuzz face (sharing the font blob) */
+    cairo_font_face_t *font_face;        /**< Cairo font face (sharing the font blob too) */
+    emojivur_glyph_cache_t *glyph_cache; /**< Rasterized glyphs (NULL if disabled) */
+    unsigned int pxsize;                 /**< Size in pixels used to render the glyphs */
+
+    emojivur_atlas_tile_t *tiles;        /**< Tiles of the atlas */
+    size_t tile_count;                   /**< Number of tiles */
+    size_t tiles_allocated;              /**< Number of tiles that fit in `tiles` */
+
+    // Grid
+    unsigned int cell_w;                 /**< Width of each tile in pixels */
+    unsigned int cell_h;                 /**< Height of each tile in pixels */
+    unsigned int columns;                /**< Number of tiles on each row */
+    unsigned int rows_per_page;          /**< Largest number of rows on each page */
+    unsigned int pages;                  /**< Number of pages (or atlas images) */
+
+    // Work handed over to the threads
+    size_t next_tile;                    /**< Next tile to pick up (updated atomically) */
+    size_t end_tile;                     /**< Tile right after the last one to process */
+    unsigned char *page_data;            /**< Pixels of the atlas image being rendered (NULL when shaping) */
+    int page_stride;                     /**< Number of bytes between two rows of `page_data` */
+    unsigned int page_y;                 /**< Top edge in pixels of the page in the whole atlas */
+    pthread_mutex_t lock;                /**< Lock protecting `error_msg` */
+    char *error_msg;                     /**< First error met by any thread (NULL if none) */
+} emojivur_atlas_t;
+
+/*!
+ * \brief Encode a codepoint as UTF-8
+ *
+ * \param codepoint         Codepoint to encode
+ * \param buffer            Buffer to write at least 4 bytes to
+ *
+ * \return Number of bytes written
+ *
+ */
+static size_t emojivur_utf8_encode(uint32_t codepoint, char *buffer)
+{
+    if (codepoint < 0x80)
+    {
+        buffer[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800)
+    {
+        buffer[0] = (char)(0xC0 | (codepoint >> 6));
+        buffer[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000)
+    {
+        buffer[0] = (char)(0xE0 | (codepoint >> 12));
+        buffer[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        buffer[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    buffer[0] = (char)(0xF0 | (codepoint >> 18));
+    buffer[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    buffer[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    buffer[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+/*!
+ * \brief Add a tile for a sequence of codepoints
+ *
+ * \param atlas             Atlas to add the tile to
+ * \param codepoints        Sequence of codepoints (copied)
+ * \param codepoint_count   Number of codepoints in the sequence
+ *
+ * \return `false` if out of memory
+ *
+ */
+static bool emojivur_atlas_add(emojivur_atlas_t *atlas, const uint32_t *codepoints, unsigned int codepoint_count)
+{
+    if (atlas->tile_count == atlas->tiles_allocated)
+    {
+        size_t allocated = MAX(atlas->tiles_allocated * 2, 1024);
+        emojivur_atlas_tile_t *tiles = (emojivur_atlas_tile_t *)realloc(atlas->tiles,
+                                                                        allocated * sizeof(emojivur_atlas_tile_t));
+        if (unlikely(!tiles))
+        {
+            return false;
+        }
+        atlas->tiles = tiles;
+        atlas->tiles_allocated = allocated;
+    }
+
+    emojivur_atlas_tile_t *tile = &atlas->tiles[atlas->tile_count];
+    memset(tile, 0, sizeof(emojivur_atlas_tile_t));
+    tile->codepoints = (uint32_t *)malloc(codepoint_count * sizeof(uint32_t));
+    tile->text = (char *)malloc(codepoint_count * 4 + 1);
+    if (unlikely(!tile->codepoints || !tile->text))
+    {
+        free(tile->codepoints);
+        free(tile->text);
+        return false;
+    }
+
+    memcpy(tile->codepoints, codepoints, codepoint_count * sizeof(uint32_t));
+    tile->codepoint_count = codepoint_count;
+    for (unsigned int i = 0; i < codepoint_count; ++i)
+    {
+        tile->text_length += emojivur_utf8_encode(codepoints[i], tile->text + tile->text_length);
+    }
+    tile->text[tile->text_length] = '\0';
+    ++atlas->tile_count;
+
+    return true;
+}
+
+/*!
+ * \brief Release the resources of a tile
+ *
+ * \param tile              Tile to release
+ *
+ */
+static void emojivur_atlas_tile_free(emojivur_atlas_tile_t *tile)
+{
+    free(tile->codepoints);
+    free(tile->text);
+    if (tile->glyphs)
+    {
+        cairo_glyph_free(tile->glyphs);
+    }
+    memset(tile, 0, sizeof(emojivur_atlas_tile_t));
+}
+
+/*!
+ * \brief Compare two tiles by their sequence of codepoints (for `qsort()`)
+ *
+ * \param a                 First tile
+ * \param b                 Second tile
+ *
+ * \return Negative, zero or positive like `strcmp()`
+ *
+ */
+static int emojivur_atlas_tile_compare(const void *a, const void *b)
+{
+    const emojivur_atlas_tile_t *tile_a = (const emojivur_atlas_tile_t *)a;
+    const emojivur_atlas_tile_t *tile_b = (const emojivur_atlas_tile_t *)b;
+    for (unsigned int i = 0; i < tile_a->codepoint_count && i < tile_b->codepoint_count; ++i)
+    {
+        if (tile_a->codepoints[i] != tile_b->codepoints[i])
+        {
+            return tile_a->codepoints[i] < tile_b->codepoints[i] ? -1 : 1;
+        }
+    }
+    return (int)tile_a->codepoint_count - (int)tile_b->codepoint_count;
+}
+
+/*!
+ * \brief Read a big endian 16 bit value from a font table, checking its bounds
+ *
+ * \param data              Font table
+ * \param length            Length of the font table in bytes
+ * \param offset            Offset of the value in the font table
+ *
+ * \return The value, 0 if out of bounds
+ *
+ */
+static inline unsigned int emojivur_read16(const uint8_t *data, size_t length, size_t offset)
+{
+    return offset + 2 <= length ? ((unsigned int)data[offset] << 8) | data[offset + 1] : 0;
+}
+
+/*!
+ * \brief Read a big endian 32 bit value from a font table, checking its bounds
+ *
+ * \param data              Font table
+ * \param length            Length of the font table in bytes
+ * \param offset            Offset of the value in the font table
+ *
+ * \return The value, 0 if out of bounds
+ *
+ */
+static inline uint32_t emojivur_read32(const uint8_t *data, size_t length, size_t offset)
+{
+    return (emojivur_read16(data, length, offset) << 16) | emojivur_read16(data, length, offset + 2);
+}
+
+/*!
+ * \brief Add a tile for each ligature of a GSUB ligature substitution subtable whose components all map to codepoints
+ *
+ * \param atlas             Atlas to add the tiles to
+ * \param data              GSUB table
+ * \param length            Length of the GSUB table in bytes
+ * \param subtable          Offset of the ligature substitution subtable in the GSUB table
+ * \param glyph_codepoints  Codepoint mapped to each glyph of the font (0 if none)
+ * \param glyph_count       Number of glyphs of the font
+ *
+ * \return `false` if out of memory
+ *
+ */
+static bool emojivur_atlas_add_ligatures(emojivur_atlas_t *atlas, const uint8_t *data, size_t length, size_t subtable,
+                                         const uint32_t *glyph_codepoints, unsigned int glyph_count)
+{
+    if (emojivur_read16(data, length, subtable) != 1)
+    {
+        return true;
+    }
+
+    // Coverage lists the first glyph of the ligatures of each ligature set, in the same order
+    size_t coverage = subtable + emojivur_read16(data, length, subtable + 2);
+    unsigned int coverage_format = emojivur_read16(data, length, coverage);
+    unsigned int set_count = emojivur_read16(data, length, subtable + 4);
+    unsigned int range_count = coverage_format == 2 ? emojivur_read16(data, length, coverage + 2) : 0;
+    unsigned int range = 0;
+
+    for (unsigned int set = 0; set < set_count; ++set)
+    {
+        unsigned int first_glyph = 0;
+        if (coverage_format == 1)
+        {
+            if (set >= emojivur_read16(data, length, coverage + 2))
+            {
+                break;
+            }
+            first_glyph = emojivur_read16(data, length, coverage + 4 + 2 * set);
+        }
+        else if (coverage_format == 2)
+        {
+            // Ranges are sorted: coverage indexes grow with them
+            while (range < range_count)
+            {
+                size_t record = coverage + 4 + 6 * range;
+                unsigned int start = emojivur_read16(data, length, record);
+                unsigned int end = emojivur_read16(data, length, record + 2);
+                unsigned int start_index = emojivur_read16(data, length, record + 4);
+                if (set >= start_index && set <= start_index + (end - start) && end >= start)
+                {
+                    first_glyph = start + (set - start_index);
+                    break;
+                }
+                ++range;
+            }
+            if (range == range_count)
+            {
+                break;
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        size_t ligature_set = subtable + emojivur_read16(data, length, subtable + 6 + 2 * set);
+        unsigned int ligature_count = emojivur_read16(data, length, ligature_set);
+        for (unsigned int l = 0; l < ligature_count; ++l)
+        {
+            size_t ligature = ligature_set + emojivur_read16(data, length, ligature_set + 2 + 2 * l);
+            unsigned int component_count = emojivur_read16(data, length, ligature + 2);
+            if (component_count < 2 || ligature + 4 + 2 * (component_count - 1) > length)
+            {
+                continue;
+            }
+
+            uint32_t codepoints[component_count];
+            bool mapped = first_glyph < glyph_count && glyph_codepoints[first_glyph];
+            codepoints[0] = mapped ? glyph_codepoints[first_glyph] : 0;
+            for (unsigned int c = 1; c < component_count && mapped; ++c)
+            {
+                unsigned int glyph = emojivur_read16(data, length, ligature + 4 + 2 * (c - 1));
+                mapped = glyph < glyph_count && glyph_codepoints[glyph];
+                codepoints[c] = mapped ? glyph_codepoints[glyph] : 0;
+            }
+
+            if (mapped && unlikely(!emojivur_atlas_add(atlas, codepoints, component_count)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Add a tile for every codepoint mapped by the font and every GSUB ligature of codepoints
+ *
+ * Ligatures whose components are not all mapped straight from codepoints (e.g. the result of
+ * other substitutions) are skipped. Whether each sequence really ends up as a single glyph is
+ * checked later on, when shaping it.
+ *
+ * \param atlas             Atlas to add the tiles to
+ * \param font              HarfBuzz font of the face to enumerate
+ *
+ * \return `false` if out of memory
+ *
+ */
+static bool emojivur_atlas_enumerate(emojivur_atlas_t *atlas, hb_font_t *font)
+{
+    unsigned int glyph_count = hb_face_get_glyph_count(atlas->harfbuzz_face);
+    uint32_t *glyph_codepoints = (uint32_t *)calloc(MAX(glyph_count, 1), sizeof(uint32_t));
+    hb_set_t *unicodes = hb_set_create();
+    if (unlikely(!glyph_codepoints))
+    {
+        hb_set_destroy(unicodes);
+        return false;
+    }
+
+    // Every codepoint on its own (the lowest codepoint mapped to a glyph names it)
+    hb_face_collect_unicodes(atlas->harfbuzz_face, unicodes);
+    bool added = true;
+    for (hb_codepoint_t codepoint = HB_SET_VALUE_INVALID; added && hb_set_next(unicodes, &codepoint);)
+    {
+        hb_codepoint_t glyph = 0;
+        if (!hb_font_get_nominal_glyph(font, codepoint, &glyph) || glyph >= glyph_count)
+        {
+            continue;
+        }
+        if (!glyph_codepoints[glyph])
+        {
+            glyph_codepoints[glyph] = codepoint;
+        }
+
+        uint32_t sequence = codepoint;
+        added = emojivur_atlas_add(atlas, &sequence, 1);
+    }
+    hb_set_destroy(unicodes);
+    size_t single_count = atlas->tile_count;
+
+    // Ligatures of every GSUB ligature substitution lookup (extensions included)
+    hb_blob_t *gsub_blob = hb_face_reference_table(atlas->harfbuzz_face, HB_TAG('G', 'S', 'U', 'B'));
+    unsigned int length = 0;
+    const uint8_t *data = (const uint8_t *)hb_blob_get_data(gsub_blob, &length);
+    size_t lookup_list = data ? emojivur_read16(data, length, 8) : 0;
+    unsigned int lookup_count = lookup_list ? emojivur_read16(data, length, lookup_list) : 0;
+    for (unsigned int i = 0; added && i < lookup_count; ++i)
+    {
+        size_t lookup = lookup_list + emojivur_read16(data, length, lookup_list + 2 + 2 * i);
+        unsigned int lookup_type = emojivur_read16(data, length, lookup);
+        unsigned int subtable_count = emojivur_read16(data, length, lookup + 4);
+        for (unsigned int j = 0; added && j < subtable_count; ++j)
+        {
+            size_t subtable = lookup + emojivur_read16(data, length, lookup + 6 + 2 * j);
+            unsigned int subtable_type = lookup_type;
+            if (lookup_type == GSUB_EXTENSION_SUBST && emojivur_read16(data, length, subtable) == 1)
+            {
+                subtable_type = emojivur_read16(data, length, subtable + 2);
+                subtable += emojivur_read32(data, length, subtable + 4);
+            }
+            if (subtable_type == GSUB_LIGATURE_SUBST)
+            {
+                added = emojivur_atlas_add_ligatures(atlas, data, length, subtable, glyph_codepoints, glyph_count);
+            }
+        }
+    }
+    hb_blob_destroy(gsub_blob);
+    free(glyph_codepoints);
+
+    // Sequences sorted once and for all, dropping the ones found in more than one lookup
+    qsort(atlas->tiles + single_count, atlas->tile_count - single_count, sizeof(emojivur_atlas_tile_t),
+          emojivur_atlas_tile_compare);
+    size_t unique_count = single_count;
+    for (size_t i = single_count; i < atlas->tile_count; ++i)
+    {
+        if (unique_count > single_count &&
+            emojivur_atlas_tile_compare(&atlas->tiles[unique_count - 1], &atlas->tiles[i]) == 0)
+        {
+            emojivur_atlas_tile_free(&atlas->tiles[i]);
+            continue;
+        }
+        atlas->tiles[unique_count++] = atlas->tiles[i];
+    }
+    atlas->tile_count = unique_count;
+
+    return added;
+}
+
+/*!
+ * \brief Stop the threads processing the tiles because of an error, keeping the first one met
+ *
+ * The error is left to the main thread to report, once all threads are done.
+ *
+ * \param atlas             Atlas the threads work for
+ * \param error_msg         Error message to present to the user
+ *
+ */
+static void emojivur_atlas_fail(emojivur_atlas_t *atlas, char *error_msg)
+{
+    pthread_mutex_lock(&atlas->lock);
+    if (!atlas->error_msg)
+    {
+        atlas->error_msg = error_msg;
+    }
+    pthread_mutex_unlock(&atlas->lock);
+
+    // No more tiles are picked up
+    __atomic_store_n(&atlas->next_tile, atlas->end_tile, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Shape the sequence of a tile keeping it only if it turns into a single visible glyph
+ *
+ * \param atlas             Atlas the tile belongs to
+ * \param thread_data       HarfBuzz font & buffer owned by the calling thread
+ * \param tile              Tile to shape
+ *
+ * \return `false` if the sequence could not be shaped (see `thread_data->error_msg`)
+ *
+ */
+static bool emojivur_atlas_shape_tile(emojivur_atlas_t *atlas, emojivur_shared_ptrs_t *thread_data,
+                                      emojivur_atlas_tile_t *tile)
+{
+    emoji_viewport_t text_size;
+    unsigned int glyph_count = 0;
+    if (unlikely(!emojivur_try_shape_text(thread_data, tile->text, tile->text_length, atlas->pxsize, &text_size,
+                                          &glyph_count)))
+    {
+        return false;
+    }
+    if (glyph_count != 1 || thread_data->cairo_glyphs[0].index == 0)
+    {
+        return true;
+    }
+
+    // Blank glyphs (spaces, joiners, variation selectors...) are not worth a tile
+    hb_glyph_extents_t extents;
+    if (hb_font_get_glyph_extents(thread_data->harfbuzz_font, thread_data->cairo_glyphs[0].index, &extents) &&
+        (extents.width == 0 || extents.height == 0))
+    {
+        return true;
+    }
+
+    tile->glyphs = thread_data->cairo_glyphs;
+    tile->glyph_count = glyph_count;
+    tile->viewport = emojivur_page_layout(tile->glyphs, glyph_count, text_size, atlas->pxsize);
+    thread_data->cairo_glyphs = NULL;
+    thread_data->cairo_glyphs_allocated = 0;
+
+    return true;
+}
+
+/*!
+ * \brief Rasterize a tile and copy it at its place in the atlas image being rendered
+ *
+ * \param atlas             Atlas the tile belongs to
+ * \param cairo_context     Cairo context drawing onto an image as large as a tile, owned by the calling thread
+ * \param tile              Tile to render
+ *
+ */
+static void emojivur_atlas_render_tile(emojivur_atlas_t *atlas, cairo_t *cairo_context, emojivur_atlas_tile_t *tile)
+{
+    cairo_surface_t *tile_surface = cairo_get_target(cairo_context);
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_RENDER);
+    cairo_save(cairo_context);
+    cairo_set_operator(cairo_context, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cairo_context);
+    cairo_restore(cairo_context);
+
+    // Tiles share the baseline and are centered horizontally
+    cairo_save(cairo_context);
+    cairo_translate(cairo_context, (int)(atlas->cell_w - tile->viewport.w) / 2,
+                    (int)(atlas->cell_h - tile->viewport.h));
+    emojivur_glyph_cache_show_glyphs(atlas->glyph_cache, cairo_context, tile->glyphs, tile->glyph_count);
+    cairo_restore(cairo_context);
+    cairo_surface_flush(tile_surface);
+    emojivur_stats_stop(&timer);
+
+    // Tiles never overlap: threads can copy them without locking
+    const unsigned char *tile_data = cairo_image_surface_get_data(tile_surface);
+    int tile_stride = cairo_image_surface_get_stride(tile_surface);
+    for (unsigned int row = 0; row < atlas->cell_h; ++row)
+    {
+        memcpy(atlas->page_data + (size_t)(tile->y - atlas->page_y + row) * atlas->page_stride + (size_t)tile->x * 4,
+               tile_data + (size_t)row * tile_stride, (size_t)atlas->cell_w * 4);
+    }
+}
+
+/*!
+ * \brief Body of a thread shaping (or rendering) the tiles handed over by the atlas
+ *
+ * Errors never exit from here: they are recorded in the atlas for the main thread to report.
+ *
+ * \param arg               Atlas the thread works for
+ *
+ * \return Always NULL
+ *
+ */
+static void *emojivur_atlas_thread(void *arg)
+{
+    emojivur_atlas_t *atlas = (emojivur_atlas_t *)arg;
+
+    emojivur_shared_ptrs_t thread_data = emojivur_shared_ptrs_default;
+    bool ready = true;
+    if (atlas->page_data)
+    {
+        thread_data.cairo_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, atlas->cell_w, atlas->cell_h);
+        if (unlikely(cairo_surface_status(thread_data.cairo_surface) != CAIRO_STATUS_SUCCESS))
+        {
+            ready = emojivur_fail(&thread_data, "An error occured during Cairo Image Surface creation!");
+        }
+        else
+        {
+            thread_data.cairo_context = cairo_create(thread_data.cairo_surface);
+            cairo_set_source_rgba(thread_data.cairo_context, 0, 0, 0, 1.0);
+            cairo_set_font_face(thread_data.cairo_context, atlas->font_face);
+            cairo_set_font_size(thread_data.cairo_context, atlas->pxsize);
+            thread_data.glyph_cache = emojivur_glyph_cache_reference(atlas->glyph_cache);
+        }
+    }
+    else
+    {
+        thread_data.harfbuzz_font = hb_font_create(atlas->harfbuzz_face);
+        thread_data.tmp_buffer = hb_buffer_create();
+        if (unlikely(!thread_data.harfbuzz_font || !thread_data.tmp_buffer))
+        {
+            ready = emojivur_fail(&thread_data, !thread_data.harfbuzz_font ?
+                                  "An error occured during the HarfBuzz Font creation!" :
+                                  "An error occured during the HarfBuzz work Buffer creation!");
+        }
+        else
+        {
+            hb_ot_font_set_funcs(thread_data.harfbuzz_font);
+            hb_font_set_scale(thread_data.harfbuzz_font, atlas->pxsize * 64, atlas->pxsize * 64);
+        }
+    }
+
+    while (ready)
+    {
+        size_t i = __atomic_fetch_add(&atlas->next_tile, 1, __ATOMIC_RELAXED);
+        if (i >= atlas->end_tile)
+        {
+            break;
+        }
+
+        if (atlas->page_data)
+        {
+            emojivur_atlas_render_tile(atlas, thread_data.cairo_context, &atlas->tiles[i]);
+        }
+        else
+        {
+            ready = emojivur_atlas_shape_tile(atlas, &thread_data, &atlas->tiles[i]);
+        }
+    }
+    if (unlikely(!ready))
+    {
+        emojivur_atlas_fail(atlas, thread_data.error_msg);
+    }
+
+    emojivur_release(&thread_data);
+
+    return NULL;
+}
+
+/*!
+ * \brief Process a range of tiles with a pool of threads (shaping them, or rendering them onto `atlas->page_data`)
+ *
+ * \param atlas             Atlas the tiles belong to
+ * \param begin             First tile to process
+ * \param end               Tile right after the last one to process
+ * \param thread_count      Number of threads to use
+ *
+ * \return `false` if any thread failed (see `atlas->error_msg`)
+ *
+ */
+static bool emojivur_atlas_run(emojivur_atlas_t *atlas, size_t begin, size_t end, int thread_count)
+{
+    atlas->next_tile = begin;
+    atlas->end_tile = end;
+
+    // Threads already running must be joined, even if not all of them could start
+    pthread_t threads[thread_count];
+    int threads_started = 0;
+    while (threads_started < thread_count &&
+           pthread_create(&threads[threads_started], NULL, emojivur_atlas_thread, atlas) == 0)
+    {
+        ++threads_started;
+    }
+    if (unlikely(threads_started < thread_count))
+    {
+        emojivur_atlas_fail(atlas, "An error occured starting the atlas threads!");
+    }
+    for (int i = 0; i < threads_started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    return atlas->error_msg == NULL;
+}
+
+/*!
+ * \brief Write a string as JSON string (quotes included)
+ *
+ * \param file              File to write to
+ * \param text              UTF-8 text to write
+ * \param text_length       Length of the text in bytes
+ *
+ */
+static void emojivur_json_string(FILE *file, const char *text, size_t text_length)
+{
+    fputc('"', file);
+    for (size_t i = 0; i < text_length; ++i)
+    {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\')
+        {
+            fprintf(file, "\\%c", c);
+        }
+        else if (c < 0x20 || c == 0x7F)
+        {
+            fprintf(file, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/*!
+ * \brief Write the index of the tiles as JSON
+ *
+ * \param atlas             Atlas to describe
+ * \param index_file        File to write the index to
+ *
+ */
+static void emojivur_atlas_write_index(const emojivur_atlas_t *atlas, FILE *index_file)
+{
+    fprintf(index_file, "{\n  \"pxsize\": %u,\n  \"tile_width\": %u,\n  \"tile_height\": %u,\n"
+                        "  \"pages\": %u,\n  \"tiles\": [\n",
+            atlas->pxsize, atlas->cell_w, atlas->cell_h, atlas->pages);
+    for (size_t i = 0; i < atlas->tile_count; ++i)
+    {
+        const emojivur_atlas_tile_t *tile = &atlas->tiles[i];
+        fprintf(index_file, "    {\"sequence\": \"");
+        for (unsigned int c = 0; c < tile->codepoint_count; ++c)
+        {
+            fprintf(index_file, "%s%04X", c ? " " : "", tile->codepoints[c]);
+        }
+        fprintf(index_file, "\", \"text\": ");
+        emojivur_json_string(index_file, tile->text, tile->text_length);
+        fprintf(index_file, ", \"glyph\": %lu, \"page\": %u, \"x\": %u, \"y\": %u, \"w\": %u, \"h\": %u}%s\n",
+                tile->glyphs[0].index, tile->page + 1, tile->x, tile->y - tile->page * atlas->rows_per_page * atlas->cell_h,
+                atlas->cell_w, atlas->cell_h, i + 1 < atlas->tile_count ? "," : "");
+    }
+    fprintf(index_file, "  ]\n}\n");
+}
+
+/*!
+ * \brief Render every emoji of the font on a grid of tiles, writing an index of the tiles as JSON
+ *
+ * Emojis are every codepoint mapped by the font plus every sequence of codepoints the
+ * font turns into a single glyph through a GSUB ligature. PNG output packs the tiles in
+ * an atlas (split in numbered images if larger than the maximum atlas size), while PDF
+ * output lays them out on a grid spanning as many pages as needed.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param format            Format of the output
+ * \param thread_count      Number of threads rendering (0 to use one for each CPU)
+ * \param output_filename   File name for the PDF (or PNG atlas) to create
+ * \param index_filename    File name of the JSON index mapping each sequence of codepoints to its tile (`-` for the standard output)
+ *
+ */
+void emojivur_atlas_output(emojivur_shared_ptrs_t *shared_data, unsigned int pxsize, enum enum_format format,
+                           int thread_count, char *output_filename, const char *index_filename)
+{
+    if (thread_count <= 0)
+    {
+        thread_count = MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    if (unlikely(strcmp(index_filename, "-") == 0 && emojivur_output_fd(output_filename) == STDOUT_FILENO))
+    {
+        emojivur_exit(shared_data, "The atlas and its index cannot be both written to the standard output!", 1);
+    }
+
+    // HarfBuzz face is shared by all threads
+    hb_face_make_immutable(shared_data->harfbuzz_face);
+
+    emojivur_atlas_t atlas = {
+        .harfbuzz_face = shared_data->harfbuzz_face,
+        .font_face = shared_data->cairo_font_face,
+        .glyph_cache = shared_data->glyph_cache,
+        .pxsize = pxsize,
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+    };
+    if (unlikely(!emojivur_atlas_enumerate(&atlas, shared_data->harfbuzz_font)))
+    {
+        emojivur_exit(shared_data, "An error occured allocating the atlas tiles!", 1);
+    }
+
+    // Only sequences turning into a single visible glyph get a tile
+    if (unlikely(!emojivur_atlas_run(&atlas, 0, atlas.tile_count, thread_count)))
+    {
+        emojivur_exit(shared_data, atlas.error_msg, 1);
+    }
+    size_t tile_count = 0;
+    for (size_t i = 0; i < atlas.tile_count; ++i)
+    {
+        if (!atlas.tiles[i].glyphs)
+        {
+            emojivur_atlas_tile_free(&atlas.tiles[i]);
+            continue;
+        }
+        atlas.tiles[tile_count++] = atlas.tiles[i];
+        atlas.cell_w = MAX(atlas.cell_w, atlas.tiles[tile_count - 1].viewport.w);
+        atlas.cell_h = MAX(atlas.cell_h, atlas.tiles[tile_count - 1].viewport.h);
+    }
+    atlas.tile_count = tile_count;
+    if (unlikely(tile_count == 0))
+    {
+        free(atlas.tiles);
+        emojivur_exit(shared_data, "No emoji to render found in the font!", 1);
+    }
+
+    // Lay the tiles out on the grid
+    if (format == format_arg_png)
+    {
+        unsigned int max_columns = MAX(ATLAS_MAX_SIZE / atlas.cell_w, 1);
+        atlas.columns = ceil(sqrt((double)tile_count * atlas.cell_h / atlas.cell_w));
+        atlas.columns = MAX(MIN(atlas.columns, max_columns), 1);
+        atlas.rows_per_page = MAX(ATLAS_MAX_SIZE / atlas.cell_h, 1);
+    }
+    else
+    {
+        atlas.columns = ATLAS_PDF_COLUMNS;
+        atlas.rows_per_page = ATLAS_PDF_ROWS;
+    }
+    atlas.columns = MIN(atlas.columns, tile_count);
+    size_t tiles_per_page = (size_t)atlas.columns * atlas.rows_per_page;
+    atlas.pages = (tile_count + tiles_per_page - 1) / tiles_per_page;
+    for (size_t i = 0; i < tile_count; ++i)
+    {
+        atlas.tiles[i].page = i / tiles_per_page;
+        atlas.tiles[i].x = (i % atlas.columns) * atlas.cell_w;
+        atlas.tiles[i].y = (i / atlas.columns) * atlas.cell_h;
+    }
+
+    if (unlikely(atlas.pages > 1 && format == format_arg_png && emojivur_output_fd(output_filename) >= 0))
+    {
+        emojivur_exit(shared_data, "An atlas spanning many PNG images can only be written to files!", 1);
+    }
+
+    for (unsigned int page = 0; page < atlas.pages; ++page)
+    {
+        size_t begin = page * tiles_per_page;
+        size_t end = MIN(begin + tiles_per_page, tile_count);
+        unsigned int rows = (end - begin + atlas.columns - 1) / atlas.columns;
+        emoji_viewport_t viewport = {atlas.columns * atlas.cell_w, (format == format_arg_png ? rows : atlas.rows_per_page) * atlas.cell_h};
+        atlas.page_y = page * atlas.rows_per_page * atlas.cell_h;
+
+        if (format == format_arg_png)
+        {
+            cairo_surface_t *page_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, viewport.w, viewport.h);
+            if (unlikely(cairo_surface_status(page_surface) != CAIRO_STATUS_SUCCESS))
+            {
+                emojivur_exit(shared_data, "An error occured during Cairo Image Surface creation!", 1);
+            }
+            cairo_surface_flush(page_surface);
+            atlas.page_data = cairo_image_surface_get_data(page_surface);
+            atlas.page_stride = cairo_image_surface_get_stride(page_surface);
+
+            if (unlikely(!emojivur_atlas_run(&atlas, begin, end, thread_count)))
+            {
+                cairo_surface_destroy(page_surface);
+                emojivur_exit(shared_data, atlas.error_msg, 1);
+            }
+            cairo_surface_mark_dirty(page_surface);
+
+            char png_filename[FILENAME_MAX];
+            snprintf(png_filename, sizeof(png_filename), "%s", output_filename);
+            if (atlas.pages > 1)
+            {
+                emojivur_numbered_filename(png_filename, sizeof(png_filename), output_filename, page + 1);
+            }
+            emojivur_png_surface_output(shared_data, page_surface, png_filename);
+            cairo_surface_destroy(page_surface);
+            atlas.page_data = NULL;
+            continue;
+        }
+
+        // PDF pages are vectors: nothing worth doing in parallel
+        if (!shared_data->cairo_surface)
+        {
+            emojivur_pdf_open(shared_data, viewport, output_filename);
+        }
+        cairo_pdf_surface_set_size(shared_data->cairo_surface, viewport.w, viewport.h);
+        cairo_set_source_rgba(shared_data->cairo_context, 0, 0, 0, 1.0);
+        cairo_set_font_face(shared_data->cairo_context, atlas.font_face);
+        cairo_set_font_size(shared_data->cairo_context, pxsize);
+
+        emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_RENDER);
+        for (size_t i = begin; i < end; ++i)
+        {
+            emojivur_atlas_tile_t *tile = &atlas.tiles[i];
+            cairo_save(shared_data->cairo_context);
+            cairo_translate(shared_data->cairo_context,
+                            tile->x + (int)(atlas.cell_w - tile->viewport.w) / 2,
+                            tile->y - atlas.page_y + (int)(atlas.cell_h - tile->viewport.h));
+            cairo_show_glyphs(shared_data->cairo_context, tile->glyphs, tile->glyph_count);
+            cairo_restore(shared_data->cairo_context);
+        }
+        emojivur_stats_stop(&timer);
+
+        timer = emojivur_stats_start(EMOJIVUR_STAGE_OUTPUT);
+        cairo_show_page(shared_data->cairo_context);
+        emojivur_stats_stop(&timer);
+    }
+    if (shared_data->cairo_surface)
+    {
+        emojivur_pdf_close(shared_data);
+    }
+
+    FILE *index_file = strcmp(index_filename, "-") == 0 ? stdout : fopen(index_filename, "w");
+    emojivur_ptr_valid_or_exit(shared_data, index_file, "An error occured opening the atlas index for writing!", 1);
+    emojivur_atlas_write_index(&atlas, index_file);
+    if (unlikely((index_file == stdout ? fflush(index_file) : fclose(index_file)) != 0))
+    {
+        emojivur_exit(shared_data, "An error occured writing the atlas index!", 1);
+    }
+
+    for (size_t i = 0; i < atlas.tile_count; ++i)
+    {
+        emojivur_atlas_tile_free(&atlas.tiles[i]);
+    }
+    free(atlas.tiles);
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
+}
@@ -0,0 +1,648 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       batch.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Multi-threaded batch renderer
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <harfbuzz/hb.h>
+#include <harfbuzz/hb-ot.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "emojivur.h"
+#include "batch.h"
+
+// Number of jobs in flight for each rendering thread
+#define BATCH_JOBS_PER_THREAD 4
+
+/*!
+ * \brief One line of the batch input and the result of its rendering
+ *
+ */
+typedef struct
+{
+    char *text;                     /**< UTF-8 text to render (owned by the job) */
+    size_t text_allocated;          /**< Number of bytes that fit in `text` */
+    ssize_t text_length;            /**< Length of the text in bytes */
+    unsigned long number;           /**< Number of the page (or image) starting from 1 */
+    emoji_to_render_t emoji;        /**< Shaped glyphs to render on a PDF page (in font units with many sizes) */
+    cairo_glyph_t *glyphs;          /**< Vector of glyphs (owned by the job) `emoji` refers to */
+    unsigned int glyphs_allocated;  /**< Number of glyphs that fit in `glyphs` */
+    bool done;                      /**< Whether a thread completed the job */
+} emojivur_batch_job_t;
+
+/*!
+ * \brief State shared by the threads of a batch
+ *
+ * Jobs are stored in a ring buffer and identified by a sequence number growing with the
+ * input lines: the main thread reads jobs in, rendering threads pick them up in the same order
+ * and the main thread finally emits their results in order, as soon as they are done.
+ * Each slot of the ring buffer keeps its text and glyph vectors from one job to the next:
+ * they only ever grow, so that once warmed up jobs do not allocate any memory of their own.
+ *
+ */
+typedef struct
+{
+    pthread_mutex_t lock;                /**< Lock protecting the fields below */
+    pthread_cond_t job_queued;           /**< Signaled when a job is queued or when the input ends */
+    pthread_cond_t job_done;             /**< Signaled when a job is done */
+    emojivur_batch_job_t *jobs;          /**< Ring buffer of jobs */
+    unsigned long job_slots;             /**< Number of jobs in the ring buffer */
+    unsigned long next_to_queue;         /**< Sequence number of the next job to read from the input */
+    unsigned long next_to_render;        /**< Sequence number of the next job to render */
+    unsigned long next_to_emit;          /**< Sequence number of the next job to emit */
+    bool input_done;                     /**< Whether all the jobs have been read */
+    char *error_msg;                     /**< First error met by any thread (NULL if none), stopping the batch */
+
+    // Read-only data shared by all rendering threads
+    hb_face_t *harfbuzz_face;            /**< Immutable HarfBuzz face (sharing the font blob) */
+    cairo_font_face_t *font_face;        /**< Cairo font face (sharing the font blob too) */
+    emojivur_glyph_cache_t *glyph_cache; /**< Rasterized glyphs (NULL if disabled) */
+    emojivur_shape_cache_t *shape_cache; /**< Shaped runs (NULL if disabled) */
+    const int *pxsizes;                  /**< Sizes in pixels used to render the glyphs */
+    unsigned int pxsize_count;           /**< Number of sizes (texts are shaped in font units if more than one) */
+    unsigned int units_per_em;           /**< Units per em of the HarfBuzz face */
+    enum enum_format format;             /**< Format of the output */
+    char *output_filename;               /**< File name of the output */
+
+    // Owned by the main thread
+    cairo_glyph_t *scaled_glyphs;        /**< Glyphs scaled to each size when emitting PDF pages (with many sizes) */
+    unsigned int scaled_glyphs_allocated; /**< Number of glyphs that fit in `scaled_glyphs` */
+} emojivur_batch_t;
+
+/*!
+ * \brief Build the name of the file numbered `number` of a sequence of files named after `filename`
+ *
+ * \param buffer            Buffer to write the file name to
+ * \param size              Size of the buffer
+ * \param filename          Name of the file (e.g. "emoji.png")
+ * \param number            Number of the file in the sequence (e.g. 42 to get "emoji-000042.png")
+ *
+ */
+void emojivur_numbered_filename(char *buffer, size_t size, const char *filename, unsigned long number)
+{
+    // Only a dot in the last path component starts the extension
+    const char *basename = strrchr(filename, '/');
+    const char *extension = strrchr(basename ? basename : filename, '.');
+    int stem_length = extension ? (int)(extension - filename) : (int)strlen(filename);
+
+    snprintf(buffer, size, "%.*s-%06lu%s", stem_length, filename, number, extension ? extension : "");
+}
+
+/*!
+ * \brief Build the name of the file rendered at `pxsize` pixels of a set of files named after `filename`
+ *
+ * \param buffer            Buffer to write the file name to
+ * \param size              Size of the buffer
+ * \param filename          Name of the file (e.g. "emoji.png")
+ * \param pxsize            Size in pixels used to render the glyphs (e.g. 64 to get "emoji-64px.png")
+ *
+ */
+void emojivur_sized_filename(char *buffer, size_t size, const char *filename, unsigned int pxsize)
+{
+    const char *basename = strrchr(filename, '/');
+    const char *extension = strrchr(basename ? basename : filename, '.');
+    int stem_length = extension ? (int)(extension - filename) : (int)strlen(filename);
+
+    snprintf(buffer, size, "%.*s-%upx%s", stem_length, filename, pxsize, extension ? extension : "");
+}
+
+/*!
+ * \brief Render glyphs shaped in font units at many sizes, on one PDF page (or PNG image) each
+ *
+ * PDF pages are added to the document open in `shared_data` (opening it if needed),
+ * while PNG images are named after `output_filename` and the size they are rendered at.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param unit_emoji        Glyphs laid out in font units (with the size of the text in font units as viewport)
+ * \param units_per_em      Units per em of the font face
+ * \param pxsizes           Sizes in pixels to render the glyphs at
+ * \param pxsize_count      Number of sizes
+ * \param format            Format of the output
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ * \param glyphs            Vector of Cairo glyphs the scaled ones are written to (grown if needed)
+ * \param glyphs_allocated  Number of Cairo glyphs that fit in `glyphs` (updated when it grows)
+ *
+ * \return `false` if any page (or image) could not be written (see `shared_data->error_msg`)
+ *
+ */
+static bool emojivur_sizes_emit(emojivur_shared_ptrs_t *shared_data, const emoji_to_render_t *unit_emoji,
+                                unsigned int units_per_em, const int *pxsizes, unsigned int pxsize_count,
+                                enum enum_format format, char *output_filename,
+                                cairo_glyph_t **glyphs, unsigned int *glyphs_allocated)
+{
+    if (unlikely(!emojivur_glyphs_reserve(glyphs, glyphs_allocated, unit_emoji->glyph_count)))
+    {
+        return emojivur_fail(shared_data, "An error occured allocating the scaled glyphs!");
+    }
+
+    for (unsigned int i = 0; i < pxsize_count; ++i)
+    {
+        emoji_viewport_t text_size = emojivur_scale_glyphs(unit_emoji->glyphs, unit_emoji->glyph_count,
+                                                           unit_emoji->viewport, units_per_em, pxsizes[i], *glyphs);
+        emoji_to_render_t emoji = {
+            .viewport = emojivur_page_layout(*glyphs, unit_emoji->glyph_count, text_size, pxsizes[i]),
+            .font_face = unit_emoji->font_face,
+            .glyphs = *glyphs,
+            .glyph_count = unit_emoji->glyph_count,
+            .glyph_size = pxsizes[i],
+        };
+
+        if (format == format_arg_png)
+        {
+            char png_filename[FILENAME_MAX];
+            emojivur_sized_filename(png_filename, sizeof(png_filename), output_filename, pxsizes[i]);
+            if (unlikely(!emojivur_try_png_file_output(shared_data, emoji, png_filename)))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (!shared_data->cairo_surface &&
+                unlikely(!emojivur_try_pdf_open(shared_data, emoji.viewport, output_filename)))
+            {
+                return false;
+            }
+            if (unlikely(!emojivur_try_pdf_page(shared_data, emoji)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Render a text at many sizes shaping it just once, on one PDF page (or PNG image) each
+ *
+ * The text is shaped in font units and its glyph positions are scaled to each size.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param text              UTF-8 text to render
+ * \param pxsizes           Sizes in pixels to render the glyphs at
+ * \param pxsize_count      Number of sizes
+ * \param format            Format of the output
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ *
+ */
+void emojivur_sizes_output(emojivur_shared_ptrs_t *shared_data, const char *text, const int *pxsizes,
+                           unsigned int pxsize_count, enum enum_format format, char *output_filename)
+{
+    emoji_viewport_t unit_size;
+    unsigned int glyph_count = emojivur_shape_text_units(shared_data, text, -1, &unit_size);
+
+    emoji_to_render_t unit_emoji = {
+        .viewport = unit_size,
+        .font_face = shared_data->cairo_font_face,
+        .glyphs = shared_data->cairo_glyphs,
+        .glyph_count = glyph_count,
+    };
+    cairo_glyph_t *glyphs = NULL;
+    unsigned int glyphs_allocated = 0;
+    bool emitted = emojivur_sizes_emit(shared_data, &unit_emoji, hb_face_get_upem(shared_data->harfbuzz_face),
+                                       pxsizes, pxsize_count, format, output_filename, &glyphs, &glyphs_allocated);
+    cairo_glyph_free(glyphs);
+    if (unlikely(!emitted))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+
+    if (shared_data->cairo_surface)
+    {
+        emojivur_pdf_close(shared_data);
+    }
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
+}
+
+/*!
+ * \brief Stop a batch because of an error, keeping the first one met for the main thread to report it
+ *
+ * Must be called holding the batch lock. Threads stop picking up jobs and the main thread,
+ * woken up if waiting for a job, stops emitting them, joins all threads and exits.
+ *
+ * \param batch             Batch to stop
+ * \param error_msg         Error message to present to the user
+ *
+ */
+static void emojivur_batch_fail(emojivur_batch_t *batch, char *error_msg)
+{
+    if (!batch->error_msg)
+    {
+        batch->error_msg = error_msg;
+    }
+    pthread_cond_signal(&batch->job_done);
+}
+
+/*!
+ * \brief Hand the glyphs shaped by a rendering thread over to a job, taking the vector of the job in exchange
+ *
+ * \param thread_data       Data of the rendering thread (with the glyphs shaped for the job)
+ * \param job               Job the glyphs have been shaped for
+ *
+ */
+static void emojivur_batch_swap_glyphs(emojivur_shared_ptrs_t *thread_data, emojivur_batch_job_t *job)
+{
+    cairo_glyph_t *glyphs = job->glyphs;
+    unsigned int glyphs_allocated = job->glyphs_allocated;
+
+    job->glyphs = thread_data->cairo_glyphs;
+    job->glyphs_allocated = thread_data->cairo_glyphs_allocated;
+    thread_data->cairo_glyphs = glyphs;
+    thread_data->cairo_glyphs_allocated = glyphs_allocated;
+}
+
+/*!
+ * \brief Body of a rendering thread
+ *
+ * Every thread owns its HarfBuzz font & buffer and, when writing PNG images, its
+ * Cairo surface & context, while HarfBuzz face, Cairo font face and caches are shared.
+ * All of them are reused from one job to the next. Errors never exit from here:
+ * they stop the batch, left to the main thread to report.
+ *
+ * \param arg               Batch the thread belongs to
+ *
+ * \return Always NULL
+ *
+ */
+static void *emojivur_batch_render_thread(void *arg)
+{
+    emojivur_batch_t *batch = (emojivur_batch_t *)arg;
+
+    emojivur_shared_ptrs_t thread_data = emojivur_shared_ptrs_default;
+
+    thread_data.harfbuzz_font = hb_font_create(batch->harfbuzz_face);
+    thread_data.tmp_buffer = hb_buffer_create();
+    if (unlikely(!thread_data.harfbuzz_font || !thread_data.tmp_buffer))
+    {
+        pthread_mutex_lock(&batch->lock);
+        emojivur_batch_fail(batch, !thread_data.harfbuzz_font ?
+                            "An error occured during the HarfBuzz Font creation!" :
+                            "An error occured during the HarfBuzz work Buffer creation!");
+        pthread_mutex_unlock(&batch->lock);
+        emojivur_release(&thread_data);
+        return NULL;
+    }
+    hb_ot_font_set_funcs(thread_data.harfbuzz_font);
+    hb_font_set_scale(thread_data.harfbuzz_font, batch->pxsizes[0] * 64, batch->pxsizes[0] * 64);
+
+    thread_data.glyph_cache = emojivur_glyph_cache_reference(batch->glyph_cache);
+    thread_data.shape_cache = emojivur_shape_cache_reference(batch->shape_cache);
+
+    // Glyphs scaled to each size (with many sizes only)
+    cairo_glyph_t *scaled_glyphs = NULL;
+    unsigned int scaled_glyphs_allocated = 0;
+
+    bool rendered = true;
+    while (rendered)
+    {
+        pthread_mutex_lock(&batch->lock);
+        while (batch->next_to_render == batch->next_to_queue && !batch->input_done && !batch->error_msg)
+        {
+            pthread_cond_wait(&batch->job_queued, &batch->lock);
+        }
+        if (batch->next_to_render == batch->next_to_queue || batch->error_msg)
+        {
+            pthread_mutex_unlock(&batch->lock);
+            break;
+        }
+        emojivur_batch_job_t *job = &batch->jobs[batch->next_to_render % batch->job_slots];
+        ++batch->next_to_render;
+        pthread_mutex_unlock(&batch->lock);
+
+        if (batch->pxsize_count > 1)
+        {
+            // Shaped once in font units, the text gets scaled to each size
+            emoji_viewport_t unit_size = {0};
+            unsigned int glyph_count = 0;
+            rendered = emojivur_try_shape_text_units(&thread_data, job->text, job->text_length, &unit_size,
+                                                     &glyph_count);
+            job->emoji = (emoji_to_render_t){
+                .viewport = unit_size,
+                .font_face = batch->font_face,
+                .glyphs = thread_data.cairo_glyphs,
+                .glyph_count = glyph_count,
+            };
+
+            if (batch->format == format_arg_png)
+            {
+                char png_filename[FILENAME_MAX];
+                emojivur_numbered_filename(png_filename, sizeof(png_filename), batch->output_filename, job->number);
+                rendered = rendered &&
+                           emojivur_sizes_emit(&thread_data, &job->emoji, batch->units_per_em, batch->pxsizes,
+                                               batch->pxsize_count, batch->format, png_filename,
+                                               &scaled_glyphs, &scaled_glyphs_allocated);
+                job->emoji.glyphs = NULL;
+            }
+            else
+            {
+                emojivur_batch_swap_glyphs(&thread_data, job);
+            }
+        }
+        else
+        {
+            unsigned int pxsize = batch->pxsizes[0];
+            emoji_viewport_t text_size = {0};
+            unsigned int glyph_count = 0;
+            rendered = emojivur_try_shape_text(&thread_data, job->text, job->text_length, pxsize, &text_size,
+                                               &glyph_count);
+
+            job->emoji = (emoji_to_render_t){
+                .viewport = emojivur_page_layout(thread_data.cairo_glyphs, glyph_count, text_size, pxsize),
+                .font_face = batch->font_face,
+                .glyphs = thread_data.cairo_glyphs,
+                .glyph_count = glyph_count,
+                .glyph_size = pxsize,
+            };
+
+            if (batch->format == format_arg_png)
+            {
+                // Every image goes to its own file: they can be written in parallel
+                char png_filename[FILENAME_MAX];
+                emojivur_numbered_filename(png_filename, sizeof(png_filename), batch->output_filename, job->number);
+                rendered = rendered && emojivur_try_png_file_output(&thread_data, job->emoji, png_filename);
+                job->emoji.glyphs = NULL;
+            }
+            else
+            {
+                // Glyphs are handed over to the job to be rendered later on by the main thread
+                emojivur_batch_swap_glyphs(&thread_data, job);
+            }
+        }
+
+        // A failed job is never emitted: the error is set along with it being done
+        pthread_mutex_lock(&batch->lock);
+        if (unlikely(!rendered))
+        {
+            emojivur_batch_fail(batch, thread_data.error_msg);
+        }
+        job->done = true;
+        pthread_cond_signal(&batch->job_done);
+        pthread_mutex_unlock(&batch->lock);
+    }
+
+    cairo_glyph_free(scaled_glyphs);
+    emojivur_release(&thread_data);
+
+    return NULL;
+}
+
+/*!
+ * \brief Emit (in order) the results of the jobs already done, waiting for the next one if needed
+ *
+ * Must be called by the main thread holding the batch lock. Nothing more is emitted once the batch failed.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param batch             Batch the jobs belong to
+ * \param wait              Whether to wait for the next job to be done if it is not yet
+ *
+ */
+static void emojivur_batch_emit(emojivur_shared_ptrs_t *shared_data, emojivur_batch_t *batch, bool wait)
+{
+    while (batch->next_to_emit < batch->next_to_queue && !batch->error_msg)
+    {
+        emojivur_batch_job_t *job = &batch->jobs[batch->next_to_emit % batch->job_slots];
+        if (!job->done)
+        {
+            if (!wait)
+            {
+                return;
+            }
+            pthread_cond_wait(&batch->job_done, &batch->lock);
+            continue;
+        }
+
+        // Completed jobs are not touched by rendering threads any more
+        pthread_mutex_unlock(&batch->lock);
+        bool emitted = true;
+        if (batch->format == format_arg_pdf)
+        {
+            if (batch->pxsize_count > 1)
+            {
+                emitted = emojivur_sizes_emit(shared_data, &job->emoji, batch->units_per_em, batch->pxsizes,
+                                              batch->pxsize_count, batch->format, batch->output_filename,
+                                              &batch->scaled_glyphs, &batch->scaled_glyphs_allocated);
+            }
+            else
+            {
+                if (!shared_data->cairo_surface)
+                {
+                    emitted = emojivur_try_pdf_open(shared_data, job->emoji.viewport, batch->output_filename);
+                }
+                emitted = emitted && emojivur_try_pdf_page(shared_data, job->emoji);
+            }
+        }
+
+        // Text & glyph vectors stay with the slot, for the next job to reuse them
+        job->text_length = 0;
+        job->number = 0;
+        job->emoji = (emoji_to_render_t){0};
+        job->done = false;
+        pthread_mutex_lock(&batch->lock);
+        if (unlikely(!emitted))
+        {
+            emojivur_batch_fail(batch, shared_data->error_msg);
+        }
+
+        ++batch->next_to_emit;
+        wait = false;
+    }
+}
+
+/*!
+ * \brief Render each line of a text file on its own PDF page (or PNG image) using a pool of threads
+ *
+ * The main thread reads the lines and emits the PDF pages in input order, while the rendering
+ * threads shape the lines (and write the PNG images) in parallel. All threads share the same
+ * font data, loaded once. Empty lines are skipped. With many sizes each line is shaped once,
+ * in font units, and rendered at every size.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param batch_filename    File name of the text file to read (`-` to read from the standard input)
+ * \param pxsizes           Sizes in pixels used to render the glyphs (one page or image each)
+ * \param pxsize_count      Number of sizes
+ * \param format            Format of the output
+ * \param thread_count      Number of threads rendering (0 to use one for each CPU)
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ *
+ */
+void emojivur_batch_output(emojivur_shared_ptrs_t *shared_data, char *batch_filename, const int *pxsizes,
+                           unsigned int pxsize_count, enum enum_format format, int thread_count,
+                           char *output_filename)
+{
+    if (thread_count <= 0)
+    {
+        thread_count = MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    FILE *batch_file = stdin;
+    if (strcmp(batch_filename, "-") != 0)
+    {
+        batch_file = fopen(batch_filename, "r");
+        emojivur_ptr_valid_or_exit(shared_data, batch_file,
+                                   "An error occured opening the batch input file!", 1);
+    }
+
+    // HarfBuzz face is shared by all rendering threads
+    hb_face_make_immutable(shared_data->harfbuzz_face);
+
+    emojivur_batch_t batch = {
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+        .job_queued = PTHREAD_COND_INITIALIZER,
+        .job_done = PTHREAD_COND_INITIALIZER,
+        .job_slots = thread_count * BATCH_JOBS_PER_THREAD,
+        .harfbuzz_face = shared_data->harfbuzz_face,
+        .font_face = shared_data->cairo_font_face,
+        .glyph_cache = shared_data->glyph_cache,
+        .shape_cache = shared_data->shape_cache,
+        .pxsizes = pxsizes,
+        .pxsize_count = pxsize_count,
+        .units_per_em = hb_face_get_upem(shared_data->harfbuzz_face),
+        .format = format,
+        .output_filename = output_filename,
+    };
+    batch.jobs = (emojivur_batch_job_t *)calloc(batch.job_slots, sizeof(emojivur_batch_job_t));
+    emojivur_ptr_valid_or_exit(shared_data, batch.jobs,
+                               "An error occured allocating the batch jobs!", 1);
+
+    pthread_t *threads = (pthread_t *)calloc(thread_count, sizeof(pthread_t));
+    emojivur_ptr_valid_or_exit(shared_data, threads,
+                               "An error occured allocating the batch threads!", 1);
+
+    // Threads already running must be joined before exiting, even if not all of them could start
+    int threads_started = 0;
+    while (threads_started < thread_count &&
+           pthread_create(&threads[threads_started], NULL, emojivur_batch_render_thread, &batch) == 0)
+    {
+        ++threads_started;
+    }
+    if (unlikely(threads_started < thread_count))
+    {
+        batch.error_msg = "An error occured starting the batch threads!";
+    }
+
+    // Lines are read into a buffer swapped with the text of the job they are queued as
+    char *line = NULL;
+    size_t line_allocated = 0;
+    while (true)
+    {
+        ssize_t line_length = getline(&line, &line_allocated, batch_file);
+
+        // Strip line terminators (files with DOS line endings included)
+        while (line_length > 0 && (line[line_length - 1] == '\n' || line[line_length - 1] == '\r'))
+        {
+            line[--line_length] = '\0';
+        }
+        if (line_length == 0)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&batch.lock);
+
+        // Make room for the next job emitting the ones already done
+        emojivur_batch_emit(shared_data, &batch, false);
+        while (batch.next_to_queue - batch.next_to_emit == batch.job_slots && !batch.error_msg)
+        {
+            emojivur_batch_emit(shared_data, &batch, true);
+        }
+
+        if (line_length < 0 || batch.error_msg)
+        {
+            batch.input_done = true;
+            pthread_cond_broadcast(&batch.job_queued);
+            pthread_mutex_unlock(&batch.lock);
+            break;
+        }
+
+        emojivur_batch_job_t *job = &batch.jobs[batch.next_to_queue % batch.job_slots];
+        char *text = job->text;
+        size_t text_allocated = job->text_allocated;
+        job->text = line;
+        job->text_allocated = line_allocated;
+        job->text_length = line_length;
+        line = text;
+        line_allocated = text_allocated;
+        job->number = batch.next_to_queue + 1;
+        ++batch.next_to_queue;
+        pthread_cond_signal(&batch.job_queued);
+
+        pthread_mutex_unlock(&batch.lock);
+    }
+
+    // Emit all the jobs still in flight (unless the batch failed)
+    pthread_mutex_lock(&batch.lock);
+    while (batch.next_to_emit < batch.next_to_queue && !batch.error_msg)
+    {
+        emojivur_batch_emit(shared_data, &batch, true);
+    }
+    pthread_mutex_unlock(&batch.lock);
+
+    for (int i = 0; i < threads_started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free(line);
+    for (unsigned long i = 0; i < batch.job_slots; ++i)
+    {
+        free(batch.jobs[i].text);
+        cairo_glyph_free(batch.jobs[i].glyphs);
+    }
+    free(batch.jobs);
+    cairo_glyph_free(batch.scaled_glyphs);
+
+    if (batch_file != stdin)
+    {
+        fclose(batch_file);
+    }
+
+    // Only reported now that no other thread uses the shared data
+    if (unlikely(batch.error_msg))
+    {
+        emojivur_exit(shared_data, batch.error_msg, 1);
+    }
+    if (unlikely(batch.next_to_queue == 0))
+    {
+        emojivur_exit(shared_data, "No text to render found in the batch input!", 1);
+    }
+
+    if (shared_data->cairo_surface)
+    {
+        emojivur_pdf_close(shared_data);
+    }
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
+}
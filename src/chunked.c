@@ -0,0 +1,319 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       chunked.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Shaping & rendering of arbitrarily large texts chunk by chunk
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <harfbuzz/hb.h>
+#include <harfbuzz/hb-ot.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "emojivur.h"
+#include "batch.h"
+#include "stats.h"
+#include "chunked.h"
+
+// Longest row in bytes of text (longer lines wrap on the following rows)
+#define CHUNK_ROW_BYTES 256
+
+// Number of rows on each PDF page (or PNG image)
+#define CHUNK_ROWS 32
+
+/*!
+ * \brief Window over the text being read, holding the next row and as much text following it
+ *
+ * The text after the row gives HarfBuzz the context to tell where the row can be cut safely.
+ *
+ */
+typedef struct
+{
+    FILE *input;                       /**< File the text is read from */
+    char buffer[2 * CHUNK_ROW_BYTES];  /**< Text read and not laid out yet */
+    size_t buffered;                   /**< Number of bytes in `buffer` */
+    bool eof;                          /**< Whether the whole file has been read */
+} emojivur_chunk_reader_t;
+
+/*!
+ * \brief Glyphs of the rows of the page being filled
+ *
+ */
+typedef struct
+{
+    cairo_glyph_t *glyphs;             /**< Glyphs laid out on the page (only ever growing) */
+    unsigned int glyph_count;          /**< Number of glyphs on the page */
+    unsigned int glyphs_allocated;     /**< Number of glyphs that fit in `glyphs` */
+    unsigned int rows;                 /**< Number of rows on the page */
+    unsigned int width;                /**< Width in pixels of the widest row */
+} emojivur_chunk_page_t;
+
+/*!
+ * \brief Read more text filling up the window of the reader
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param reader            Reader to fill up
+ *
+ */
+static void emojivur_chunk_fill(emojivur_shared_ptrs_t *shared_data, emojivur_chunk_reader_t *reader)
+{
+    while (!reader->eof && reader->buffered < sizeof(reader->buffer))
+    {
+        size_t read_length = fread(reader->buffer + reader->buffered, 1,
+                                   sizeof(reader->buffer) - reader->buffered, reader->input);
+        reader->buffered += read_length;
+        if (read_length == 0)
+        {
+            if (unlikely(ferror(reader->input)))
+            {
+                emojivur_exit(shared_data, "An error occured reading the text file!", 1);
+            }
+            reader->eof = true;
+        }
+    }
+}
+
+/*!
+ * \brief Shape the next row of text and lay its glyphs out at the bottom of the page
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font scaled to `pxsize`)
+ * \param reader            Reader of the text
+ * \param page              Page to add the row to
+ * \param pxsize            Size in pixels used to render the glyphs
+ *
+ * \return `false` if the whole text has already been laid out
+ *
+ */
+static bool emojivur_chunk_row(emojivur_shared_ptrs_t *shared_data, emojivur_chunk_reader_t *reader,
+                               emojivur_chunk_page_t *page, unsigned int pxsize)
+{
+    emojivur_chunk_fill(shared_data, reader);
+    if (reader->buffered == 0)
+    {
+        return false;
+    }
+
+    // Rows never span line breaks (files with DOS line endings included)
+    const char *newline = (const char *)memchr(reader->buffer, '\n', reader->buffered);
+    size_t window = newline ? (size_t)(newline - reader->buffer) : reader->buffered;
+    size_t consumed = newline ? window + 1 : window;
+    if (newline && window > 0 && reader->buffer[window - 1] == '\r')
+    {
+        --window;
+    }
+
+    // Same segment properties used to shape the texts rendered on one line
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_SHAPE);
+    hb_buffer_clear_contents(shared_data->tmp_buffer);
+    hb_buffer_set_direction(shared_data->tmp_buffer, HB_DIRECTION_LTR);
+    hb_buffer_set_script(shared_data->tmp_buffer, HB_SCRIPT_COMMON);
+    hb_buffer_set_language(shared_data->tmp_buffer, hb_language_get_default());
+    hb_buffer_add_utf8(shared_data->tmp_buffer, reader->buffer, window, 0, window);
+    hb_shape(shared_data->harfbuzz_font, shared_data->tmp_buffer, NULL, 0);
+    emojivur_stats_stop(&timer);
+
+    timer = emojivur_stats_start(EMOJIVUR_STAGE_GLYPHS);
+    unsigned int glyph_count = 0;
+    const hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(shared_data->tmp_buffer, &glyph_count);
+    const hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(shared_data->tmp_buffer, NULL);
+
+    // Too long a line is cut at the last cluster boundary in the row HarfBuzz marks safe to break,
+    // where glyphs come out the same as shaping the row on its own (any cluster boundary otherwise)
+    if (window > CHUNK_ROW_BYTES)
+    {
+        unsigned int safe_cut = 0;
+        unsigned int cluster_cut = 0;
+        for (unsigned int i = 1; i < glyph_count && glyph_info[i].cluster <= CHUNK_ROW_BYTES; ++i)
+        {
+            if (glyph_info[i].cluster == glyph_info[i - 1].cluster)
+            {
+                continue;
+            }
+            cluster_cut = i;
+            if (!(hb_glyph_info_get_glyph_flags(&glyph_info[i]) & HB_GLYPH_FLAG_UNSAFE_TO_BREAK))
+            {
+                safe_cut = i;
+            }
+        }
+
+        unsigned int cut = safe_cut ? safe_cut : cluster_cut;
+        if (cut)
+        {
+            glyph_count = cut;
+            consumed = glyph_info[cut].cluster;
+        }
+    }
+
+    if (page->glyph_count + glyph_count > page->glyphs_allocated)
+    {
+        unsigned int glyphs_allocated = MAX(page->glyphs_allocated * 2, page->glyph_count + glyph_count);
+        cairo_glyph_t *glyphs = (cairo_glyph_t *)realloc(page->glyphs, glyphs_allocated * sizeof(cairo_glyph_t));
+        emojivur_ptr_valid_or_exit(shared_data, glyphs, "An error occured allocating the glyphs of the page!", 1);
+        page->glyphs = glyphs;
+        page->glyphs_allocated = glyphs_allocated;
+    }
+
+    // Rows are laid out top to bottom, with margins just like a text rendered on one line
+    double margin = round(pxsize / (64.0));
+    double x = 0;
+    double y = 0;
+    double baseline = margin / 2 + (page->rows + 1) * pxsize;
+    cairo_glyph_t *glyphs = page->glyphs + page->glyph_count;
+    for (unsigned int i = 0; i < glyph_count; ++i)
+    {
+        glyphs[i].index = glyph_info[i].codepoint;
+        glyphs[i].x = margin / 2 + x + glyph_pos[i].x_offset / (64.0);
+        glyphs[i].y = baseline - (y + glyph_pos[i].y_offset / (64.0));
+        x += glyph_pos[i].x_advance / (64.0);
+        y += glyph_pos[i].y_advance / (64.0);
+    }
+    page->glyph_count += glyph_count;
+    page->width = MAX(page->width, (unsigned int)ceil(x));
+    ++page->rows;
+    emojivur_stats_stop(&timer);
+
+    reader->buffered -= consumed;
+    memmove(reader->buffer, reader->buffer + consumed, reader->buffered);
+
+    return true;
+}
+
+/*!
+ * \brief Render a text of any length read from a file, shaping and emitting it chunk by chunk
+ *
+ * The text is split in rows at line breaks and, when a line is too long, at cluster boundaries
+ * HarfBuzz marks safe to break. Rows are stacked on PDF pages (or PNG images) of a fixed number
+ * of rows, each one written as soon as it is full, so that memory usage does not depend on the
+ * length of the text and the output starts flowing right after the first page.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param text_filename     File with the UTF-8 text to render (`-` for the standard input)
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param format            Format of the output
+ * \param output_filename   File name for the PDF to create (or used to name the PNG images)
+ *
+ */
+void emojivur_chunked_output(emojivur_shared_ptrs_t *shared_data, const char *text_filename, unsigned int pxsize,
+                             enum enum_format format, char *output_filename)
+{
+    emojivur_chunk_reader_t reader = {
+        .input = stdin,
+    };
+    if (strcmp(text_filename, "-") != 0)
+    {
+        reader.input = fopen(text_filename, "r");
+        emojivur_ptr_valid_or_exit(shared_data, reader.input,
+                                   "An error occured opening the text file!", 1);
+    }
+
+    emojivur_chunk_page_t page = {0};
+    unsigned long page_number = 0;
+    while (true)
+    {
+        // Look ahead for more text only once the page is full
+        bool more_rows = emojivur_chunk_row(shared_data, &reader, &page, pxsize);
+        if (more_rows && page.rows < CHUNK_ROWS)
+        {
+            continue;
+        }
+        if (page.rows == 0)
+        {
+            break;
+        }
+        emojivur_chunk_fill(shared_data, &reader);
+        bool last_page = !more_rows || reader.buffered == 0;
+
+        double margin = round(pxsize / (64.0));
+        emoji_to_render_t emoji = {
+            .viewport = {MAX(page.width + margin, 1), page.rows * pxsize + margin},
+            .font_face = shared_data->cairo_font_face,
+            .glyphs = page.glyphs,
+            .glyph_count = page.glyph_count,
+            .glyph_size = pxsize,
+        };
+        ++page_number;
+
+        if (format == format_arg_png)
+        {
+            // A text fitting one image gets the name asked for, numbered images otherwise
+            char png_filename[FILENAME_MAX];
+            snprintf(png_filename, sizeof(png_filename), "%s", output_filename);
+            if (page_number > 1 || !last_page)
+            {
+                if (unlikely(emojivur_output_fd(output_filename) >= 0))
+                {
+                    free(page.glyphs);
+                    emojivur_exit(shared_data, "Many PNG images can only be written to files!", 1);
+                }
+                emojivur_numbered_filename(png_filename, sizeof(png_filename), output_filename, page_number);
+            }
+            emojivur_png_file_output(shared_data, emoji, png_filename);
+        }
+        else
+        {
+            if (!shared_data->cairo_surface)
+            {
+                emojivur_pdf_open(shared_data, emoji.viewport, output_filename);
+            }
+            emojivur_pdf_page(shared_data, emoji);
+
+            // Hand each page over to the reader right away instead of waiting for the stream buffer to fill up
+            if (shared_data->output_stream && unlikely(!emojivur_stream_flush(shared_data->output_stream)))
+            {
+                free(page.glyphs);
+                emojivur_exit(shared_data, "An error occured writing the PDF document!", 1);
+            }
+        }
+
+        if (last_page)
+        {
+            break;
+        }
+        page.glyph_count = 0;
+        page.rows = 0;
+        page.width = 0;
+    }
+    free(page.glyphs);
+    if (reader.input != stdin)
+    {
+        fclose(reader.input);
+    }
+
+    if (unlikely(page_number == 0))
+    {
+        emojivur_exit(shared_data, "The text file is empty!", 1);
+    }
+    if (shared_data->cairo_surface)
+    {
+        emojivur_pdf_close(shared_data);
+    }
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
+}
@@ -0,0 +1,435 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       conformance.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Conformance of a font to the Unicode emoji-test.txt list
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <harfbuzz/hb.h>
+#include <harfbuzz/hb-ot.h>
+
+#include "config.h"
+#include "emojivur.h"
+#include "stats.h"
+#include "conformance.h"
+
+// Longest sequence accepted (the longest ones listed by Unicode so far are 10 codepoints)
+#define CONFORMANCE_MAX_CODEPOINTS 16
+
+// Number of sequences picked up at once by each shaping thread
+#define CONFORMANCE_CHUNK 64
+
+/*!
+ * \brief Status of a sequence as listed by emoji-test.txt
+ *
+ */
+typedef enum
+{
+    EMOJIVUR_STATUS_COMPONENT,           /**< Skin tones & hair styles, not emojis on their own */
+    EMOJIVUR_STATUS_FULLY_QUALIFIED,     /**< Sequences keyboards and fonts are expected to support */
+    EMOJIVUR_STATUS_MINIMALLY_QUALIFIED, /**< Sequences missing some of their variation selectors */
+    EMOJIVUR_STATUS_UNQUALIFIED,         /**< Sequences missing the first variation selector */
+    EMOJIVUR_STATUS_COUNT,
+} emojivur_status_t;
+
+static const char *const emojivur_status_names[EMOJIVUR_STATUS_COUNT] = {
+    "component",
+    "fully-qualified",
+    "minimally-qualified",
+    "unqualified",
+};
+
+/*!
+ * \brief One sequence of emoji-test.txt and the outcome of shaping it
+ *
+ */
+typedef struct
+{
+    hb_codepoint_t codepoints[CONFORMANCE_MAX_CODEPOINTS]; /**< Codepoints of the sequence */
+    unsigned int codepoint_count;                          /**< Number of codepoints of the sequence */
+    emojivur_status_t status;                              /**< Status of the sequence */
+    char *name;                                            /**< CLDR short name of the emoji */
+    unsigned long line;                                    /**< Line of the file listing the sequence */
+    unsigned int glyph_count;                              /**< Number of glyphs the sequence is shaped to */
+    bool notdef;                                           /**< Whether any of the glyphs is `.notdef` */
+} emojivur_sequence_t;
+
+/*!
+ * \brief Sequences shared by the threads shaping them
+ *
+ */
+typedef struct
+{
+    hb_face_t *harfbuzz_face;       /**< Immutable HarfBuzz face (sharing the font blob) */
+    emojivur_sequence_t *sequences; /**< Sequences to check */
+    size_t sequence_count;          /**< Number of sequences */
+    size_t next_sequence;           /**< Next sequence to pick up (updated atomically) */
+    pthread_mutex_t lock;           /**< Lock protecting `error_msg` */
+    char *error_msg;                /**< First error met by any thread (NULL if none) */
+} emojivur_conformance_t;
+
+/*!
+ * \brief Parse a line of emoji-test.txt
+ *
+ * Lines look like `1F468 200D 1F469 ; fully-qualified # 👨‍👩 E2.0 man, woman` where
+ * the part after `#` holds the emoji itself, the version introducing it and its name.
+ *
+ * \param line              Line to parse (modified in place)
+ * \param sequence          Sequence to fill in
+ *
+ * \return `false` if the line lists no sequence (comments & empty lines included)
+ *
+ */
+static bool emojivur_sequence_parse(char *line, emojivur_sequence_t *sequence)
+{
+    char *separator = strchr(line, ';');
+    if (!separator || line[0] == '#')
+    {
+        return false;
+    }
+    *separator = '\0';
+
+    char *cursor = line;
+    sequence->codepoint_count = 0;
+    while (true)
+    {
+        char *end = NULL;
+        unsigned long codepoint = strtoul(cursor, &end, 16);
+        if (end == cursor)
+        {
+            break;
+        }
+        if (sequence->codepoint_count == CONFORMANCE_MAX_CODEPOINTS || codepoint > 0x10FFFF)
+        {
+            return false;
+        }
+        sequence->codepoints[sequence->codepoint_count++] = codepoint;
+        cursor = end;
+    }
+    if (sequence->codepoint_count == 0)
+    {
+        return false;
+    }
+
+    char *status = separator + 1;
+    while (isspace((unsigned char)*status))
+    {
+        ++status;
+    }
+    size_t status_length = 0;
+    while (status[status_length] && !isspace((unsigned char)status[status_length]) && status[status_length] != '#')
+    {
+        ++status_length;
+    }
+    sequence->status = EMOJIVUR_STATUS_COUNT;
+    for (int i = 0; i < EMOJIVUR_STATUS_COUNT; ++i)
+    {
+        if (strlen(emojivur_status_names[i]) == status_length &&
+            strncmp(status, emojivur_status_names[i], status_length) == 0)
+        {
+            sequence->status = i;
+        }
+    }
+    if (sequence->status == EMOJIVUR_STATUS_COUNT)
+    {
+        return false;
+    }
+
+    // Name follows the version (e.g. "E2.0") in the comment, if any
+    const char *name = strchr(status + status_length, '#');
+    const char *version = name ? strstr(name, " E") : NULL;
+    while (version && !isdigit((unsigned char)version[2]))
+    {
+        version = strstr(version + 2, " E");
+    }
+    name = version ? strchr(version + 2, ' ') : NULL;
+    name = name ? name + 1 : "";
+    sequence->name = strndup(name, strcspn(name, "\r\n"));
+
+    return sequence->name != NULL;
+}
+
+/*!
+ * \brief Stop the threads shaping the sequences because of an error, keeping the first one met
+ *
+ * The error is left to the main thread to report, once all threads are done.
+ *
+ * \param conformance       Conformance check the threads work for
+ * \param error_msg         Error message to present to the user
+ *
+ */
+static void emojivur_conformance_fail(emojivur_conformance_t *conformance, char *error_msg)
+{
+    pthread_mutex_lock(&conformance->lock);
+    if (!conformance->error_msg)
+    {
+        conformance->error_msg = error_msg;
+    }
+    pthread_mutex_unlock(&conformance->lock);
+
+    // No more sequences are picked up
+    __atomic_store_n(&conformance->next_sequence, conformance->sequence_count, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Body of a thread shaping the sequences handed over by the conformance check
+ *
+ * Errors never exit from here: they are recorded in the conformance check for the main thread to report.
+ *
+ * \param arg               Conformance check the thread works for
+ *
+ * \return Always NULL
+ *
+ */
+static void *emojivur_conformance_thread(void *arg)
+{
+    emojivur_conformance_t *conformance = (emojivur_conformance_t *)arg;
+
+    // Glyphs picked do not depend on the size: the font is left at its default scale
+    emojivur_shared_ptrs_t thread_data = emojivur_shared_ptrs_default;
+    thread_data.harfbuzz_font = hb_font_create(conformance->harfbuzz_face);
+    if (unlikely(!thread_data.harfbuzz_font))
+    {
+        emojivur_conformance_fail(conformance, "An error occured during the HarfBuzz Font creation!");
+        emojivur_release(&thread_data);
+        return NULL;
+    }
+    hb_ot_font_set_funcs(thread_data.harfbuzz_font);
+
+    // One buffer is reused for all the sequences, never growing after the first few of them
+    thread_data.tmp_buffer = hb_buffer_create();
+    if (unlikely(!hb_buffer_pre_allocate(thread_data.tmp_buffer, CONFORMANCE_MAX_CODEPOINTS)))
+    {
+        emojivur_conformance_fail(conformance, "An error occured during the HarfBuzz work Buffer creation!");
+        emojivur_release(&thread_data);
+        return NULL;
+    }
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_SHAPE);
+    while (true)
+    {
+        size_t begin = __atomic_fetch_add(&conformance->next_sequence, CONFORMANCE_CHUNK, __ATOMIC_RELAXED);
+        if (begin >= conformance->sequence_count)
+        {
+            break;
+        }
+        size_t end = MIN(begin + CONFORMANCE_CHUNK, conformance->sequence_count);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            emojivur_sequence_t *sequence = &conformance->sequences[i];
+
+            // Same segment properties used to shape the texts to render
+            hb_buffer_clear_contents(thread_data.tmp_buffer);
+            hb_buffer_set_direction(thread_data.tmp_buffer, HB_DIRECTION_LTR);
+            hb_buffer_set_script(thread_data.tmp_buffer, HB_SCRIPT_COMMON);
+            hb_buffer_set_language(thread_data.tmp_buffer, hb_language_get_default());
+            hb_buffer_add_codepoints(thread_data.tmp_buffer, sequence->codepoints, sequence->codepoint_count,
+                                     0, -1);
+            hb_shape(thread_data.harfbuzz_font, thread_data.tmp_buffer, NULL, 0);
+
+            unsigned int glyph_count = 0;
+            const hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(thread_data.tmp_buffer, &glyph_count);
+            sequence->glyph_count = glyph_count;
+            sequence->notdef = false;
+            for (unsigned int g = 0; g < glyph_count; ++g)
+            {
+                sequence->notdef |= glyph_info[g].codepoint == 0;
+            }
+        }
+    }
+    emojivur_stats_stop(&timer);
+
+    emojivur_release(&thread_data);
+
+    return NULL;
+}
+
+/*!
+ * \brief Shape every sequence listed by a Unicode emoji-test.txt file checking it turns into a single glyph
+ *
+ * Nothing gets rasterized: sequences are just shaped (in parallel) and their glyphs inspected.
+ * The report lists the fully-qualified and component sequences falling back to many glyphs or
+ * to `.notdef`, followed by a summary for each status of the sequences.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics (with the font loaded)
+ * \param test_filename     Path of the emoji-test.txt file (`-` for the standard input)
+ * \param thread_count      Number of threads shaping (0 to use one for each CPU)
+ * \param report_file       File to write the report to
+ *
+ * \return Number of fully-qualified and component sequences not rendered as a single glyph
+ *
+ */
+unsigned long emojivur_conformance_check(emojivur_shared_ptrs_t *shared_data, const char *test_filename,
+                                         int thread_count, FILE *report_file)
+{
+    if (thread_count <= 0)
+    {
+        thread_count = MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    FILE *test_file = stdin;
+    if (strcmp(test_filename, "-") != 0)
+    {
+        test_file = fopen(test_filename, "r");
+        emojivur_ptr_valid_or_exit(shared_data, test_file,
+                                   "An error occured opening the emoji test file!", 1);
+    }
+
+    uint64_t start_ns = emojivur_stats_now();
+
+    // HarfBuzz face is shared by all shaping threads
+    hb_face_make_immutable(shared_data->harfbuzz_face);
+
+    emojivur_conformance_t conformance = {
+        .harfbuzz_face = shared_data->harfbuzz_face,
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+    };
+    size_t sequences_allocated = 0;
+    char *line = NULL;
+    size_t line_allocated = 0;
+    unsigned long line_number = 0;
+    while (getline(&line, &line_allocated, test_file) >= 0)
+    {
+        ++line_number;
+        if (conformance.sequence_count == sequences_allocated)
+        {
+            sequences_allocated = MAX(sequences_allocated * 2, 4096);
+            conformance.sequences = (emojivur_sequence_t *)realloc(conformance.sequences,
+                                                                   sequences_allocated * sizeof(emojivur_sequence_t));
+            emojivur_ptr_valid_or_exit(shared_data, conformance.sequences,
+                                       "An error occured allocating the emoji sequences!", 1);
+        }
+
+        emojivur_sequence_t *sequence = &conformance.sequences[conformance.sequence_count];
+        if (emojivur_sequence_parse(line, sequence))
+        {
+            sequence->line = line_number;
+            ++conformance.sequence_count;
+        }
+    }
+    free(line);
+    if (test_file != stdin)
+    {
+        fclose(test_file);
+    }
+    if (unlikely(conformance.sequence_count == 0))
+    {
+        emojivur_exit(shared_data, "No emoji sequence found in the emoji test file!", 1);
+    }
+
+    pthread_t *threads = (pthread_t *)calloc(thread_count, sizeof(pthread_t));
+    emojivur_ptr_valid_or_exit(shared_data, threads,
+                               "An error occured allocating the conformance threads!", 1);
+
+    // Threads already running must be joined before exiting, even if not all of them could start
+    int threads_started = 0;
+    while (threads_started < thread_count &&
+           pthread_create(&threads[threads_started], NULL, emojivur_conformance_thread, &conformance) == 0)
+    {
+        ++threads_started;
+    }
+    if (unlikely(threads_started < thread_count))
+    {
+        emojivur_conformance_fail(&conformance, "An error occured starting the conformance threads!");
+    }
+    for (int i = 0; i < threads_started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    if (unlikely(conformance.error_msg))
+    {
+        emojivur_exit(shared_data, conformance.error_msg, 1);
+    }
+
+    uint64_t elapsed_ns = emojivur_stats_now() - start_ns;
+
+    // Sequences expected to be supported which are not, in the order they are listed
+    unsigned long failures = 0;
+    unsigned long totals[EMOJIVUR_STATUS_COUNT] = {0};
+    unsigned long singles[EMOJIVUR_STATUS_COUNT] = {0};
+    unsigned long multiples[EMOJIVUR_STATUS_COUNT] = {0};
+    unsigned long notdefs[EMOJIVUR_STATUS_COUNT] = {0};
+    for (size_t i = 0; i < conformance.sequence_count; ++i)
+    {
+        emojivur_sequence_t *sequence = &conformance.sequences[i];
+        ++totals[sequence->status];
+        if (sequence->glyph_count == 1 && !sequence->notdef)
+        {
+            ++singles[sequence->status];
+            continue;
+        }
+        ++(sequence->notdef ? notdefs : multiples)[sequence->status];
+
+        if (sequence->status != EMOJIVUR_STATUS_FULLY_QUALIFIED && sequence->status != EMOJIVUR_STATUS_COMPONENT)
+        {
+            continue;
+        }
+        if (failures++ == 0)
+        {
+            fprintf(report_file, "Sequences not rendered as a single glyph:\n");
+        }
+
+        char codepoints[CONFORMANCE_MAX_CODEPOINTS * 7 + 1];
+        size_t length = 0;
+        for (unsigned int c = 0; c < sequence->codepoint_count; ++c)
+        {
+            length += snprintf(codepoints + length, sizeof(codepoints) - length, "%s%04X", c ? " " : "",
+                               sequence->codepoints[c]);
+        }
+        fprintf(report_file, "  line %-6lu %-40s %-16s %2u glyph%s%s  %s\n", sequence->line, codepoints,
+                emojivur_status_names[sequence->status], sequence->glyph_count,
+                sequence->glyph_count == 1 ? " " : "s", sequence->notdef ? " (.notdef)" : "          ",
+                sequence->name);
+    }
+    if (failures)
+    {
+        fprintf(report_file, "\n");
+    }
+
+    fprintf(report_file, "%-20s %8s %8s %8s %8s\n", "Status", "Total", "Single", "Multiple", ".notdef");
+    for (int i = 0; i < EMOJIVUR_STATUS_COUNT; ++i)
+    {
+        fprintf(report_file, "%-20s %8lu %8lu %8lu %8lu\n", emojivur_status_names[i], totals[i], singles[i],
+                multiples[i], notdefs[i]);
+    }
+    fprintf(report_file, "\n%zu sequences checked in %.3f ms: %lu fully-qualified or component ones not supported\n",
+            conformance.sequence_count, elapsed_ns / 1e6, failures);
+
+    for (size_t i = 0; i < conformance.sequence_count; ++i)
+    {
+        free(conformance.sequences[i].name);
+    }
+    free(conformance.sequences);
+
+    return failures;
+}
@@ -28,7 +28,11 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <strings.h>
+#include <math.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
@@ -43,35 +47,52 @@
 #include <cairo/cairo-ft.h>
 #include <cairo/cairo-pdf.h>
 
+#include FT_MODULE_H
+
 #include "config.h"
-#include "cli_options.h"
 #include "emojivur.h"
+#include "raster_output.h"
+#include "stats.h"
+
+// Key used to attach the FreeType face to the Cairo font face owning it
+static const cairo_user_data_key_t emojivur_ft_face_key;
+
+// SDL2 user event type used to ask the GUI to render its content again
+static Uint32 emojivur_content_changed_event = (Uint32)-1;
+
+// Cells of the index of the glyphs shown by the GUI and how far glyphs can draw from their origin (in glyphs)
+#define GUI_INDEX_CELL_GLYPHS 4
+#define GUI_INDEX_REACH_GLYPHS 2
+
+// Distance scrolled by each step of the mouse wheel or of the arrow keys (in glyphs)
+#define GUI_SCROLL_STEP_GLYPHS 0.5
+
+// Range of the zoom of the GUI and factor applied by each step of the mouse wheel or of the +/- keys
+#define GUI_ZOOM_MIN 0.1
+#define GUI_ZOOM_MAX 16.0
+#define GUI_ZOOM_WHEEL_STEP 1.1
+#define GUI_ZOOM_KEY_STEP 1.25
+
+// Width of the caret of the GUI (in pixels) and how far it reaches above and below the baseline (in glyphs)
+#define GUI_CARET_WIDTH 2
+#define GUI_CARET_ASCENT 1.0
+#define GUI_CARET_DESCENT 0.25
+
+const emojivur_shared_ptrs_t emojivur_shared_ptrs_default = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                             0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-#define UNUSED(x) ((void)(x))
-#define MIN(a, b)               \
-    ({                          \
-        __typeof__(a) _a = (a); \
-        __typeof__(b) _b = (b); \
-        _a < _b ? _a : _b;      \
-    })
-#define MAX(a, b)               \
-    ({                          \
-        __typeof__(a) _a = (a); \
-        __typeof__(b) _b = (b); \
-        _a > _b ? _a : _b;      \
-    })
+bool emojivur_verbose = false;
 
 /*!
- * \brief Clean up all data allocated in a safe way to avoid any memory leak
+ * \brief Release all the resources referenced by the shared data in a safe way
  *
- * It is safe to call this function in any case to destroy all resources associated
- * with the program at any point (e.g. after an error occurs to make sure memory is released
- * before exiting)
+ * Unlike `emojivur_cleanup()` the SDL2 library is left untouched, so that it is
+ * safe to call this function to release the state owned by any single thread.
  *
  * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
  *
  */
-void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data)
+void emojivur_release(emojivur_shared_ptrs_t *shared_data)
 {
     if (!shared_data)
     {
@@ -91,6 +112,68 @@ void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data)
         shared_data->cairo_surface = NULL;
     }
 
+    // The surface may still write to the stream while being destroyed: release it afterwards
+    if (shared_data->output_stream)
+    {
+        emojivur_stream_free(shared_data->output_stream);
+        free(shared_data->output_stream);
+        shared_data->output_stream = NULL;
+    }
+
+    if (shared_data->pdf_subset)
+    {
+        emojivur_pdf_subset_destroy(shared_data->pdf_subset);
+        shared_data->pdf_subset = NULL;
+    }
+
+    if (shared_data->image_context)
+    {
+        cairo_destroy(shared_data->image_context);
+        shared_data->image_context = NULL;
+    }
+
+    if (shared_data->image_surface)
+    {
+        cairo_surface_destroy(shared_data->image_surface);
+        shared_data->image_surface = NULL;
+    }
+
+    if (shared_data->image_stream)
+    {
+        emojivur_stream_free(shared_data->image_stream);
+        free(shared_data->image_stream);
+        shared_data->image_stream = NULL;
+    }
+
+    // Memory of the PNG encoder belongs to the calling thread
+    emojivur_png_release();
+
+    // Cached glyphs reference the font face: release them first
+    if (shared_data->glyph_cache)
+    {
+        emojivur_glyph_cache_destroy(shared_data->glyph_cache);
+        shared_data->glyph_cache = NULL;
+    }
+
+    if (shared_data->shape_cache)
+    {
+        emojivur_shape_cache_destroy(shared_data->shape_cache);
+        shared_data->shape_cache = NULL;
+    }
+
+    // Fonts loaded by the chain are its own: only the first one is released below
+    if (shared_data->font_chain)
+    {
+        emojivur_font_chain_destroy(shared_data->font_chain);
+        shared_data->font_chain = NULL;
+    }
+
+    if (shared_data->layout)
+    {
+        emojivur_layout_destroy(shared_data->layout);
+        shared_data->layout = NULL;
+    }
+
     if (shared_data->cairo_font_face)
     {
         cairo_font_face_destroy(shared_data->cairo_font_face);
@@ -101,6 +184,7 @@ void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data)
     {
         cairo_glyph_free(shared_data->cairo_glyphs);
         shared_data->cairo_glyphs = NULL;
+        shared_data->cairo_glyphs_allocated = 0;
     }
 
     if (shared_data->harfbuzz_font)
@@ -115,29 +199,58 @@ void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data)
         shared_data->tmp_buffer = NULL;
     }
 
-    if (shared_data->window)
+    if (shared_data->harfbuzz_face)
     {
-        SDL_DestroyWindow(shared_data->window);
-        shared_data->window = NULL;
+        hb_face_destroy(shared_data->harfbuzz_face);
+        shared_data->harfbuzz_face = NULL;
     }
 
-    if (shared_data->renderer)
+    if (shared_data->harfbuzz_blob)
     {
-        SDL_DestroyRenderer(shared_data->renderer);
-        shared_data->renderer = NULL;
+        hb_blob_destroy(shared_data->harfbuzz_blob);
+        shared_data->harfbuzz_blob = NULL;
     }
 
-    if (shared_data->sdl_surface)
+    // The FreeType face is owned by the Cairo font face (and it is released together with it)
+    if (shared_data->ft_library)
     {
-        SDL_FreeSurface(shared_data->sdl_surface);
-        shared_data->sdl_surface = NULL;
+        FT_Done_FreeType(shared_data->ft_library);
+        shared_data->ft_library = NULL;
     }
 
     if (shared_data->sdl_texture)
     {
         SDL_DestroyTexture(shared_data->sdl_texture);
-        shared_data->sdl_surface = NULL;
+        shared_data->sdl_texture = NULL;
+    }
+
+    // Textures belong to the renderer which belongs to the window: destroy them in this order
+    if (shared_data->renderer)
+    {
+        SDL_DestroyRenderer(shared_data->renderer);
+        shared_data->renderer = NULL;
+    }
+
+    if (shared_data->window)
+    {
+        SDL_DestroyWindow(shared_data->window);
+        shared_data->window = NULL;
     }
+}
+
+/*!
+ * \brief Clean up all data allocated in a safe way to avoid any memory leak
+ *
+ * It is safe to call this function in any case to destroy all resources associated
+ * with the program at any point (e.g. after an error occurs to make sure memory is released
+ * before exiting)
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ *
+ */
+void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data)
+{
+    emojivur_release(shared_data);
 
     // SDL_Quit is safe to be called on any possibile exit condition
     // to make sure the SDL2 memory is completely and correctly released...
@@ -158,7 +271,8 @@ void emojivur_cleanup(emojivur_shared_ptrs_t *shared_data)
  */
 void emojivur_exit(emojivur_shared_ptrs_t *shared_data, char *error_msg, int exit_code)
 {
-    printf("[ERROR] %s (%d)", error_msg, exit_code);
+    // Errors go to the standard error so that output streamed to the standard output stays clean
+    fprintf(stderr, "[ERROR] %s (%d)\n", error_msg, exit_code);
     emojivur_cleanup(shared_data);
     exit(exit_code);
 }
@@ -180,6 +294,49 @@ void emojivur_ptr_valid_or_exit(emojivur_shared_ptrs_t *shared_data, void *ptr,
     }
 }
 
+/*!
+ * \brief Record an error in the shared data instead of exiting, for the caller to report it
+ *
+ * Functions which may fail on threads other than the main one (e.g. `emojivur_try_shape_text()`)
+ * use it to give up, leaving the shared data in a state `emojivur_release()` can still clean up.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param error_msg         Error message to present to the user
+ *
+ * \return Always `false`
+ *
+ */
+bool emojivur_fail(emojivur_shared_ptrs_t *shared_data, char *error_msg)
+{
+    shared_data->error_msg = error_msg;
+    return false;
+}
+
+/*!
+ * \brief Release the Cairo Surface & Context a function failed to create, then record the error like `emojivur_fail()`
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param error_msg         Error message to present to the user
+ *
+ * \return Always `false`
+ *
+ */
+static bool emojivur_fail_surface(emojivur_shared_ptrs_t *shared_data, char *error_msg)
+{
+    if (shared_data->cairo_context)
+    {
+        cairo_destroy(shared_data->cairo_context);
+        shared_data->cairo_context = NULL;
+    }
+    if (shared_data->cairo_surface)
+    {
+        cairo_surface_destroy(shared_data->cairo_surface);
+        shared_data->cairo_surface = NULL;
+    }
+
+    return emojivur_fail(shared_data, error_msg);
+}
+
 /*!
  * \brief Set PDF document metatags
  *
@@ -194,345 +351,2007 @@ void emojivur_set_pdf_metadata(cairo_surface_t *cairo_pdf_surface)
 }
 
 /*!
- * \brief Create a single page PDF document containing all emojis provided on one line
+ * \brief Release the font data referenced by a FreeType face being destroyed
  *
- * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
- * \param emoji             Configuration for the Cairo surface to create and render
- * \param pdf_filename      File name for the PDF to create
+ * \param object            FreeType face under finalization
  *
  */
-void emojivur_pdf_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *pdf_filename)
+void emojivur_ft_face_finalizer(void *object)
 {
-    // Creating a cairo PDF Surface (using SDL2 window width & height to size it)
-    shared_data->cairo_surface = cairo_pdf_surface_create(
-        pdf_filename,
-        emoji.viewport.w,
-        emoji.viewport.h);
-    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_surface,
-                               "An error occured during Cairo PDF Surface creation!", 1);
-
-    // Creating a Cairo context
-    shared_data->cairo_context = cairo_create(shared_data->cairo_surface);
-    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_context,
-                               "An error occured during Cairo PDF Context creation!", 1);
-
-    emojivur_set_pdf_metadata(shared_data->cairo_surface);
-
-    cairo_set_source_rgba(shared_data->cairo_context, 0, 0, 0, 1.0);
-    cairo_set_font_face(shared_data->cairo_context, emoji.font_face);
-    cairo_set_font_size(shared_data->cairo_context, emoji.glyph_size);
-
-    // Render glyph onto cairo context (which render onto SDL2 surface)
-    cairo_show_glyphs(shared_data->cairo_context, emoji.glyphs, emoji.glyph_count);
-
-    // Flush page to render it and clear the context eventually for following pages
-    cairo_show_page(shared_data->cairo_context);
-
-    // Clean up destroying Cairo & HarfBuzz resources
-    emojivur_cleanup(shared_data);
+    FT_Face ft_face = (FT_Face)object;
+    hb_blob_destroy((hb_blob_t *)ft_face->generic.data);
 }
 
 /*!
- * \brief Create a window based on SDL2 to display the emojis provided rendered on one line
+ * \brief Destroy a FreeType face and release the reference it holds on its FreeType library
  *
- * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
- * \param emoji             Configuration for the Cairo surface to create and render
+ * \param data              FreeType face to destroy
  *
  */
-void emojivur_gui(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+void emojivur_ft_face_destroy(void *data)
 {
-    // Draw text in SDL2 with Cairo
-    SDL_WindowFlags videoFlags = SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI;
+    FT_Face ft_face = (FT_Face)data;
+    FT_Library ft_library = ft_face->glyph->library;
+    FT_Done_Face(ft_face);
+    FT_Done_Library(ft_library);
+}
 
-    shared_data->window = SDL_CreateWindow(APP_NAME, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-                                           emoji.viewport.w, emoji.viewport.h, videoFlags);
-    if (unlikely(!shared_data->window))
+/*!
+ * \brief Create a Cairo font face backed by a FreeType face reading the font data of a HarfBuzz blob
+ *
+ * The FreeType face holds a reference to the blob and to the FreeType library, and it is owned
+ * by the Cairo font face: they are released only when Cairo does not use the font face any more.
+ *
+ * \param ft_library        FreeType library to create the FreeType face with
+ * \param harfbuzz_blob     HarfBuzz blob holding the font data
+ * \param face_index        Index of the face in the font data (0 unless it is a collection)
+ *
+ * \return The new Cairo font face, NULL on failure
+ *
+ */
+cairo_font_face_t *emojivur_font_face_create(FT_Library ft_library, hb_blob_t *harfbuzz_blob, unsigned int face_index)
+{
+    unsigned int font_data_length = 0;
+    const char *font_data = hb_blob_get_data(harfbuzz_blob, &font_data_length);
+    FT_Face ft_face = NULL;
+    if (unlikely(!font_data || font_data_length == 0 ||
+                 FT_New_Memory_Face(ft_library, (const FT_Byte *)font_data, font_data_length, face_index,
+                                    &ft_face) != 0))
     {
-        char sdl_error_msg[128];
-
-        snprintf(sdl_error_msg, 127, "Window could not be created! SDL2: %s\n", SDL_GetError());
-        emojivur_exit(shared_data, sdl_error_msg, 1);
+        return NULL;
     }
 
-    shared_data->renderer = SDL_CreateRenderer(shared_data->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (unlikely(!shared_data->renderer))
-    {
-        char sdl_error_msg[128];
+    // Font data and FreeType library must outlive the FreeType face
+    ft_face->generic.data = hb_blob_reference(harfbuzz_blob);
+    ft_face->generic.finalizer = emojivur_ft_face_finalizer;
+    FT_Reference_Library(ft_library);
 
-        snprintf(sdl_error_msg, 127, "SDL_CreateRenderer failed: %s\n", SDL_GetError());
-        emojivur_exit(shared_data, sdl_error_msg, 1);
+    // From now on the Cairo font face owns the FreeType face
+    cairo_font_face_t *cairo_font_face = cairo_ft_font_face_create_for_ft_face(ft_face, 0);
+    if (unlikely(cairo_font_face_status(cairo_font_face) != CAIRO_STATUS_SUCCESS ||
+                 cairo_font_face_set_user_data(cairo_font_face, &emojivur_ft_face_key,
+                                               ft_face, emojivur_ft_face_destroy) != CAIRO_STATUS_SUCCESS))
+    {
+        cairo_font_face_destroy(cairo_font_face);
+        emojivur_ft_face_destroy(ft_face);
+        return NULL;
     }
 
-    // Compute screen resolution
-    // On a HiDPI screen like Apple Retina Displays, renderer size is twice as window size
-    int window_width;
-    int window_height;
-    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+    return cairo_font_face;
+}
 
-    int renderer_width;
-    int renderer_height;
-    SDL_GetRendererOutputSize(shared_data->renderer, &renderer_width, &renderer_height);
+/*!
+ * \brief Get the FreeType face backing a Cairo font face created by `emojivur_font_face_create()`
+ *
+ * \param cairo_font_face   Cairo font face
+ *
+ * \return The FreeType face (its `generic.data` is the HarfBuzz blob of the font data), NULL for other font faces
+ *
+ */
+FT_Face emojivur_font_face_ft_face(cairo_font_face_t *cairo_font_face)
+{
+    return (FT_Face)cairo_font_face_get_user_data(cairo_font_face, &emojivur_ft_face_key);
+}
+
+/*!
+ * \brief Load the font file once sharing its content between HarfBuzz and FreeType (for Cairo)
+ *
+ * The font file is loaded as a HarfBuzz blob (memory mapped whenever possible) whose data
+ * backs the FreeType face used by Cairo as well, so that only one copy of the font is in memory.
+ * The FreeType face holds a reference to the blob and it is owned by the Cairo font face:
+ * font data is released only when neither HarfBuzz nor Cairo use it any more.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param font_filename     File name of the font to load
+ * \param face_index        Index of the face to load from the font file (0 unless it is a collection)
+ *
+ */
+void emojivur_load_font(emojivur_shared_ptrs_t *shared_data, const char *font_filename, unsigned int face_index)
+{
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_FONT_LOAD);
 
-    int cairo_x_multiplier = renderer_width / window_width;
-    int cairo_y_multiplier = renderer_height / window_height;
+    // For Harfbuzz, load using OpenType (HarfBuzz FT does not support bitmap font)
+    shared_data->harfbuzz_blob = hb_blob_create_from_file(font_filename);
+    emojivur_ptr_valid_or_exit(shared_data, shared_data->harfbuzz_blob,
+                               "An error occured during the HarfBuzz Blob creation!", 1);
 
-    // Create a SDL2 surface for Cairo to render onto
-    shared_data->sdl_surface = SDL_CreateRGBSurface(
-        0,
-        renderer_width,
-        renderer_height,
-        32,
-        0x00ff0000,
-        0x0000ff00,
-        0x000000ff,
-        0);
-    if (unlikely(!shared_data->sdl_surface))
+    unsigned int font_data_length = 0;
+    const char *font_data = hb_blob_get_data(shared_data->harfbuzz_blob, &font_data_length);
+    if (unlikely(!font_data || font_data_length == 0))
     {
-        char sdl_error_msg[128];
-
-        snprintf(sdl_error_msg, 127, "SDL_CreateRGBSurface failed: %s\n", SDL_GetError());
-        emojivur_exit(shared_data, sdl_error_msg, 1);
+        emojivur_exit(shared_data, "An error occured loading the font file!", 1);
     }
 
-    // Get Cairo surface from a SDL2 surface
-    shared_data->cairo_surface = cairo_image_surface_create_for_data(
-        (unsigned char *)shared_data->sdl_surface->pixels,
-        CAIRO_FORMAT_RGB24,
-        shared_data->sdl_surface->w,
-        shared_data->sdl_surface->h,
-        shared_data->sdl_surface->pitch);
-    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_surface,
-                               "An error occured during the creation of the Cairo Surface associated with SDL2!", 1);
+    shared_data->harfbuzz_face = hb_face_create(shared_data->harfbuzz_blob, face_index);
+    emojivur_ptr_valid_or_exit(shared_data, shared_data->harfbuzz_face,
+                               "An error occured during the HarfBuzz Font Face creation!", 1);
 
-    // Scale cairo to use screen resolution
-    cairo_surface_set_device_scale(shared_data->cairo_surface, cairo_x_multiplier, cairo_y_multiplier);
+    shared_data->harfbuzz_font = hb_font_create(shared_data->harfbuzz_face);
+    emojivur_ptr_valid_or_exit(shared_data, shared_data->harfbuzz_font,
+                               "An error occured during the HarfBuzz Font creation!", 1);
 
-    // Get Cairo context from Cairo surface
-    shared_data->cairo_context = cairo_create(shared_data->cairo_surface);
-    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_context,
-                               "An error occured during main Cairo Context creation!", 1);
-    cairo_set_source_rgba(shared_data->cairo_context, 0, 0, 0, 1.0);
-    cairo_set_font_face(shared_data->cairo_context, shared_data->cairo_font_face);
-    cairo_set_font_size(shared_data->cairo_context, emoji.glyph_size);
+    hb_ot_font_set_funcs(shared_data->harfbuzz_font);
 
-    bool done = false;
-    while (!done)
+    // Load font using FreeType for Cairo straight from the data of the HarfBuzz blob
+    if (unlikely(FT_Init_FreeType(&shared_data->ft_library) != 0))
     {
-        // Fill background in white
-        SDL_FillRect(shared_data->sdl_surface, NULL, SDL_MapRGB(shared_data->sdl_surface->format, 255, 255, 255));
-
-        // Render glyph onto cairo context (which render onto SDL2 surface)
-        cairo_show_glyphs(shared_data->cairo_context, shared_data->cairo_glyphs, emoji.glyph_count);
-
-        // Render SDL2 surface onto SDL2 renderer
-        shared_data->sdl_texture = SDL_CreateTextureFromSurface(shared_data->renderer, shared_data->sdl_surface);
-        SDL_RenderCopy(shared_data->renderer, shared_data->sdl_texture, 0, 0);
-        SDL_RenderPresent(shared_data->renderer);
-
-        // Quit app on close event
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
-        {
-            switch (event.type)
-            {
-            case SDL_QUIT:
-                done = true;
-                break;
-
-            default:
-                break;
-            }
-        }
+        emojivur_exit(shared_data,
+                      "An error occured during the FreeType library initialization!", 1);
     }
+    shared_data->cairo_font_face = emojivur_font_face_create(shared_data->ft_library, shared_data->harfbuzz_blob,
+                                                             face_index);
+    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_font_face,
+                               "An error occurred during the Cairo Font Face creation!", 1);
 
-    // Clean up destroying Cairo & HarfBuzz resources
-    emojivur_cleanup(shared_data);
+    emojivur_stats_stop(&timer);
 }
 
-//    __  __    _    ___ _   _
-//   |  \/  |  / \  |_ _| \ | |
-//   | |\/| | / _ \  | ||  \| |
-//   | |  | |/ ___ \ | || |\  |
-//   |_|  |_/_/   \_\___|_| \_|
-//
-//   #pragma MAIN
-
-int main(int argc, char *argv[])
+/*!
+ * \brief Make sure a vector of Cairo glyphs can hold some glyphs, growing it geometrically if needed
+ *
+ * The vector never shrinks: once large enough for the longest text it is reused as it is,
+ * without any further allocation. Its content is not preserved when it grows.
+ *
+ * \param glyphs            Vector of Cairo glyphs (can be NULL, replaced when it grows)
+ * \param glyphs_allocated  Number of Cairo glyphs that fit in the vector (updated when it grows)
+ * \param glyph_count       Number of Cairo glyphs the vector has to hold
+ *
+ * \return `false` if out of memory (the vector is left untouched), `true` otherwise
+ *
+ */
+bool emojivur_glyphs_reserve(cairo_glyph_t **glyphs, unsigned int *glyphs_allocated, unsigned int glyph_count)
 {
-    struct gengetopt_args_info cli_args_info;
-    if (unlikely(cmdline_parser(argc, argv, &cli_args_info) != 0))
+    if (likely(*glyphs && glyph_count <= *glyphs_allocated))
     {
-        return 1;
+        return true;
     }
 
-    // All pointers used are stored in this struct so that freeing them
-    // at any point is trivial and code remains DRYer
-    emojivur_shared_ptrs_t pshared = emojivur_shared_ptrs_default;
-
-    // Load font using FreeType for Cairo
-    FT_Library ft_library;
-    if (unlikely(FT_Init_FreeType(&ft_library) != 0))
-    {
-        emojivur_exit(&pshared,
-                      "An error occured during the FreeType library initialization!", 1);
-    }
-    FT_Face ft_face = NULL;
-    if (unlikely(FT_New_Face(ft_library, cli_args_info.font_arg, 0, &ft_face) != 0))
+    unsigned int allocated = MAX(MAX(glyph_count, 1), *glyphs_allocated * 2);
+    cairo_glyph_t *grown = cairo_glyph_allocate(allocated);
+    if (unlikely(!grown))
     {
-        emojivur_exit(&pshared,
-                      "An error occured during the FreeType Font Face creation!", 1);
+        return false;
     }
-    pshared.cairo_font_face = cairo_ft_font_face_create_for_ft_face(ft_face, 0);
-    emojivur_ptr_valid_or_exit(&pshared, pshared.cairo_font_face,
-                               "An error occurred during the Cairo Font Face creation!", 1);
-
-    // For Harfbuzz, load using OpenType (HarfBuzz FT does not support bitmap font)
-    hb_blob_t *blob = hb_blob_create_from_file(cli_args_info.font_arg);
-    emojivur_ptr_valid_or_exit(&pshared, blob,
-                               "An error occured during the HarfBuzz Blob creation!", 1);
-
-    hb_face_t *face = hb_face_create(blob, 0);
-    emojivur_ptr_valid_or_exit(&pshared, face,
-                               "An error occured during the HarfBuzz Font Face creation!", 1);
 
-    pshared.harfbuzz_font = hb_font_create(face);
-    emojivur_ptr_valid_or_exit(&pshared, pshared.harfbuzz_font,
-                               "An error occured during the HarfBuzz Font creation!", 1);
+    cairo_glyph_free(*glyphs);
+    *glyphs = grown;
+    *glyphs_allocated = allocated;
 
-    hb_ot_font_set_funcs(pshared.harfbuzz_font);
-    hb_font_set_scale(pshared.harfbuzz_font, cli_args_info.pxsize_arg * 64, cli_args_info.pxsize_arg * 64);
+    return true;
+}
 
-    // Create  HarfBuzz buffer
-    pshared.tmp_buffer = hb_buffer_create();
-    emojivur_ptr_valid_or_exit(&pshared, pshared.tmp_buffer,
-                               "An error occured during the HarfBuzz work Buffer creation!", 1);
+/*!
+ * \brief Shape a UTF-8 text with HarfBuzz and convert the result into a vector of Cairo glyphs
+ *
+ * The HarfBuzz work buffer is reused (its contents are cleared before adding the new text)
+ * while the vector of Cairo glyphs in `shared_data` is replaced by a new one.
+ * Glyphs are laid out on one line starting from the origin. Runs already shaped with the
+ * same font, size and segment properties are copied from the shape cache (if any) instead.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param text              UTF-8 text to shape
+ * \param text_length       Length of the text in bytes (-1 if the text is NUL terminated)
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param text_size         Size in pixels of the shaped text (output)
+ * \param glyph_count       Number of glyphs available in `shared_data->cairo_glyphs` (output)
+ *
+ * \return `false` if the text could not be shaped (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_shape_text(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                             unsigned int pxsize, emoji_viewport_t *text_size, unsigned int *glyph_count)
+{
+    // Text is shaped LTR using the common script and the default language
+    emojivur_shape_key_t shape_key = {
+        .face = hb_font_get_face(shared_data->harfbuzz_font),
+        .pxsize = pxsize,
+        .direction = HB_DIRECTION_LTR,
+        .script = HB_SCRIPT_COMMON,
+        .language = hb_language_get_default(),
+        .text = text,
+        .text_length = text_length < 0 ? strlen(text) : (size_t)text_length,
+    };
+    hb_font_get_scale(shared_data->harfbuzz_font, &shape_key.x_scale, &shape_key.y_scale);
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_SHAPE);
+    if (emojivur_shape_cache_lookup(shared_data->shape_cache, &shape_key, &shared_data->cairo_glyphs,
+                                    &shared_data->cairo_glyphs_allocated, glyph_count,
+                                    &text_size->w, &text_size->h))
+    {
+        emojivur_stats_stop(&timer);
+        return true;
+    }
 
-    // Set buffer to LTR direction, common script and default language
-    hb_buffer_set_direction(pshared.tmp_buffer, HB_DIRECTION_LTR);
-    hb_buffer_set_script(pshared.tmp_buffer, HB_SCRIPT_COMMON);
-    hb_buffer_set_language(pshared.tmp_buffer, hb_language_get_default());
+    // Clearing the contents resets the segment properties as well
+    hb_buffer_clear_contents(shared_data->tmp_buffer);
+    hb_buffer_set_direction(shared_data->tmp_buffer, shape_key.direction);
+    hb_buffer_set_script(shared_data->tmp_buffer, shape_key.script);
+    hb_buffer_set_language(shared_data->tmp_buffer, shape_key.language);
 
     // Add text and layout it
-    hb_buffer_add_utf8(pshared.tmp_buffer, cli_args_info.text_arg, -1, 0, -1);
-    hb_shape(pshared.harfbuzz_font, pshared.tmp_buffer, NULL, 0);
+    hb_buffer_add_utf8(shared_data->tmp_buffer, text, text_length, 0, -1);
+    hb_shape(shared_data->harfbuzz_font, shared_data->tmp_buffer, NULL, 0);
+    emojivur_stats_stop(&timer);
 
     // Get buffer data
-    unsigned int glyph_count = hb_buffer_get_length(pshared.tmp_buffer);
-    hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(pshared.tmp_buffer, NULL);
-    emojivur_ptr_valid_or_exit(&pshared, glyph_info,
-                               "An error occured during the HarfBuzz Glyph Information data creation!", 1);
-    hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(pshared.tmp_buffer, NULL);
-    emojivur_ptr_valid_or_exit(&pshared, glyph_pos,
-                               "An error occured during the HarfBuzz Glyph Positions vector creation!", 1);
-
-    unsigned int text_width_in_pixels = 0;
-    unsigned int text_height_in_pixels = cli_args_info.pxsize_arg;
-    for (int i = 0; i < glyph_count; ++i)
+    timer = emojivur_stats_start(EMOJIVUR_STAGE_GLYPHS);
+    *glyph_count = hb_buffer_get_length(shared_data->tmp_buffer);
+    hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(shared_data->tmp_buffer, NULL);
+    hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(shared_data->tmp_buffer, NULL);
+    if (unlikely(!glyph_info || !glyph_pos))
+    {
+        emojivur_stats_stop(&timer);
+        return emojivur_fail(shared_data, !glyph_info ?
+                             "An error occured during the HarfBuzz Glyph Information data creation!" :
+                             "An error occured during the HarfBuzz Glyph Positions vector creation!");
+    }
+
+    text_size->w = 0;
+    text_size->h = pxsize;
+    for (int i = 0; i < *glyph_count; ++i)
     {
-        text_width_in_pixels += glyph_pos[i].x_advance / (64.0);
-        text_height_in_pixels = MAX(text_height_in_pixels, glyph_pos[i].y_advance / (64.0));
+        text_size->w += glyph_pos[i].x_advance / (64.0);
+        text_size->h = MAX(text_size->h, glyph_pos[i].y_advance / (64.0));
     }
 
-    printf("glyph count=%d\n", glyph_count);
-    printf("text width=%d pixels\n", text_width_in_pixels);
-    printf("text height=%d pixels\n", text_height_in_pixels);
+    if (unlikely(emojivur_verbose))
+    {
+        printf("glyph count=%d\n", *glyph_count);
+        printf("text width=%d pixels\n", text_size->w);
+        printf("text height=%d pixels\n", text_size->h);
+    }
 
-    // Shape glyph for Cairo
-    pshared.cairo_glyphs = cairo_glyph_allocate(glyph_count);
+    // Shape glyph for Cairo (reusing the vector of the previous text whenever it is large enough)
+    if (unlikely(!emojivur_glyphs_reserve(&shared_data->cairo_glyphs, &shared_data->cairo_glyphs_allocated,
+                                          *glyph_count)))
+    {
+        emojivur_stats_stop(&timer);
+        return emojivur_fail(shared_data, "An error occured allocating the Cairo glyphs!");
+    }
 
     int x = 0;
     int y = 0;
-    for (int i = 0; i < glyph_count; ++i)
+    for (int i = 0; i < *glyph_count; ++i)
     {
-        pshared.cairo_glyphs[i].index = glyph_info[i].codepoint;
-        pshared.cairo_glyphs[i].x = x + (glyph_pos[i].x_offset / (64.0));
-        pshared.cairo_glyphs[i].y = -(y + glyph_pos[i].y_offset / (64.0));
+        shared_data->cairo_glyphs[i].index = glyph_info[i].codepoint;
+        shared_data->cairo_glyphs[i].x = x + (glyph_pos[i].x_offset / (64.0));
+        shared_data->cairo_glyphs[i].y = -(y + glyph_pos[i].y_offset / (64.0));
         x += glyph_pos[i].x_advance / (64.0);
         y += glyph_pos[i].y_advance / (64.0);
 
-        printf("glyph codepoint=%lu size=(%g, %g) advance=(%g, %g)\n",
-               pshared.cairo_glyphs[i].index,
-               glyph_pos[i].x_advance / (64.0),
-               glyph_pos[i].y_advance / (64.0),
-               glyph_pos[i].x_advance / (64.0),
-               glyph_pos[i].y_advance / (64.0));
+        if (unlikely(emojivur_verbose))
+        {
+            printf("glyph codepoint=%lu size=(%g, %g) advance=(%g, %g)\n",
+                   shared_data->cairo_glyphs[i].index,
+                   glyph_pos[i].x_advance / (64.0),
+                   glyph_pos[i].y_advance / (64.0),
+                   glyph_pos[i].x_advance / (64.0),
+                   glyph_pos[i].y_advance / (64.0));
+        }
     }
 
-    SDL_DisplayMode dm;
-    if (!cli_args_info.output_given)
-    {
-        // Initializing SDL2 makes sense only if not saving output to PDF
-        if (unlikely(SDL_Init(SDL_INIT_VIDEO) != 0))
-        {
-            char sdl_error_msg[128];
+    emojivur_shape_cache_add(shared_data->shape_cache, &shape_key, shared_data->cairo_glyphs, *glyph_count,
+                             text_size->w, text_size->h);
 
-            snprintf(sdl_error_msg, 127, "SDL_Init failed: %s\n", SDL_GetError());
-            emojivur_exit(&pshared, sdl_error_msg, 1);
-        }
+    emojivur_stats_stop(&timer);
 
-        // Get info about the screen size
-        // TODO: What if there are more screens? Here checking only screen 0
-        if (unlikely(SDL_GetDesktopDisplayMode(0, &dm) != 0))
-        {
-            char sdl_error_msg[128];
+    return true;
+}
 
-            snprintf(sdl_error_msg, 127, "SDL_GetDesktopDisplayMode failed: %s\n", SDL_GetError());
-            emojivur_exit(&pshared, sdl_error_msg, 1);
-        }
+/*!
+ * \brief Shape a UTF-8 text like `emojivur_try_shape_text()`, exiting if it could not be shaped
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param text              UTF-8 text to shape
+ * \param text_length       Length of the text in bytes (-1 if the text is NUL terminated)
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param text_size         Size in pixels of the shaped text (output)
+ *
+ * \return Number of glyphs available in `shared_data->cairo_glyphs`
+ *
+ */
+unsigned int emojivur_shape_text(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                                 unsigned int pxsize, emoji_viewport_t *text_size)
+{
+    unsigned int glyph_count = 0;
+    if (unlikely(!emojivur_try_shape_text(shared_data, text, text_length, pxsize, text_size, &glyph_count)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+
+    return glyph_count;
+}
+
+/*!
+ * \brief Shape a UTF-8 text in font units, so that it can be scaled to any size afterwards
+ *
+ * Like `emojivur_try_shape_text()` but the HarfBuzz font is scaled to the units per em of its face:
+ * glyph positions and text size come out in font units, ready for `emojivur_scale_glyphs()`.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param text              UTF-8 text to shape
+ * \param text_length       Length of the text in bytes (-1 if the text is NUL terminated)
+ * \param text_size         Size in font units of the shaped text (output)
+ * \param glyph_count       Number of glyphs available in `shared_data->cairo_glyphs` (output)
+ *
+ * \return `false` if the text could not be shaped (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_shape_text_units(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                                   emoji_viewport_t *text_size, unsigned int *glyph_count)
+{
+    unsigned int units_per_em = hb_face_get_upem(hb_font_get_face(shared_data->harfbuzz_font));
+    hb_font_set_scale(shared_data->harfbuzz_font, units_per_em * 64, units_per_em * 64);
+
+    return emojivur_try_shape_text(shared_data, text, text_length, units_per_em, text_size, glyph_count);
+}
+
+/*!
+ * \brief Shape a UTF-8 text in font units like `emojivur_try_shape_text_units()`, exiting if it could not be shaped
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param text              UTF-8 text to shape
+ * \param text_length       Length of the text in bytes (-1 if the text is NUL terminated)
+ * \param text_size         Size in font units of the shaped text (output)
+ *
+ * \return Number of glyphs available in `shared_data->cairo_glyphs`
+ *
+ */
+unsigned int emojivur_shape_text_units(emojivur_shared_ptrs_t *shared_data, const char *text, int text_length,
+                                       emoji_viewport_t *text_size)
+{
+    unsigned int glyph_count = 0;
+    if (unlikely(!emojivur_try_shape_text_units(shared_data, text, text_length, text_size, &glyph_count)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
     }
 
-    // Decide what the viewport size is going to be like
-    int margin_x = cli_args_info.pxsize_arg;
-    int margin_y = cli_args_info.pxsize_arg;
-    int max_width = MIN(text_width_in_pixels + margin_x, dm.w);
-    int width = MAX(MIN_WINDOW_WIDTH, max_width);
-    int max_height = MIN(text_height_in_pixels + margin_y, dm.h);
-    int height = MAX(MIN_WINDOW_HEIGHT, max_height);
+    return glyph_count;
+}
 
-    // For PDF files reduce the margins not caring of SDL2 window size
-    if (cli_args_info.output_given)
+/*!
+ * \brief Scale glyphs shaped in font units to a size in pixels
+ *
+ * \param unit_glyphs       Vector of Cairo glyphs laid out in font units by `emojivur_shape_text_units()`
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param unit_size         Size in font units of the shaped text
+ * \param units_per_em      Units per em of the font face
+ * \param pxsize            Size in pixels to scale the glyphs to
+ * \param glyphs            Vector of `glyph_count` Cairo glyphs to write the scaled ones to (output)
+ *
+ * \return Size in pixels of the scaled text
+ *
+ */
+emoji_viewport_t emojivur_scale_glyphs(const cairo_glyph_t *unit_glyphs, unsigned int glyph_count,
+                                       emoji_viewport_t unit_size, unsigned int units_per_em,
+                                       unsigned int pxsize, cairo_glyph_t *glyphs)
+{
+    double scale = (double)pxsize / units_per_em;
+    for (unsigned int i = 0; i < glyph_count; ++i)
     {
-        margin_x = round(cli_args_info.pxsize_arg / (64.0));
-        margin_y = round(cli_args_info.pxsize_arg / (64.0));
-        width = text_width_in_pixels + margin_x;
-        height = text_height_in_pixels + margin_y;
+        glyphs[i].index = unit_glyphs[i].index;
+        glyphs[i].x = unit_glyphs[i].x * scale;
+        glyphs[i].y = unit_glyphs[i].y * scale;
     }
 
-    // Move glyph to be at the center of the viewport
+    emoji_viewport_t text_size = {ceil(unit_size.w * scale), MAX((double)pxsize, ceil(unit_size.h * scale))};
+    return text_size;
+}
+
+/*!
+ * \brief Compute the size of a page (PDF or PNG) fitting a shaped text and move its glyphs inside it
+ *
+ * \param glyphs            Vector of Cairo glyphs laid out on one line from the origin
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param text_size         Size in pixels of the shaped text
+ * \param pxsize            Size in pixels used to render the glyphs
+ *
+ * \return Size of the page
+ *
+ */
+emoji_viewport_t emojivur_page_layout(cairo_glyph_t *glyphs, unsigned int glyph_count,
+                                      emoji_viewport_t text_size, unsigned int pxsize)
+{
+    // For PDF & PNG files reduce the margins not caring of SDL2 window size
+    int margin_x = round(pxsize / (64.0));
+    int margin_y = round(pxsize / (64.0));
+    emoji_viewport_t page = {text_size.w + margin_x, text_size.h + margin_y};
+
+    // PDF & PNG have coordinates origin in the top left corner of the page...
     for (int i = 0; i < glyph_count; ++i)
     {
-        // PDF & Screen have coordianates origin in different places...
-        if (cli_args_info.output_given)
+        glyphs[i].x += (margin_x / 2);
+        glyphs[i].y += page.h - (margin_y / 2);
+    }
+
+    return page;
+}
+
+/*!
+ * \brief Draw glyphs switching the font face of the context between runs of glyphs of different fonts
+ *
+ * \param cache             Glyph cache to draw the glyphs through (NULL to draw them straight with Cairo)
+ * \param cairo_context     Cairo context to draw onto (its font face is left set to `emoji.font_face`)
+ * \param emoji             Configuration for the Cairo surface the glyphs belong to
+ * \param glyphs            Vector of Cairo glyphs to draw
+ * \param glyph_ids         Positions in `emoji.glyphs` of the glyphs to draw (NULL if they are `emoji.glyphs`)
+ * \param glyph_count       Number of Cairo glyphs to draw
+ *
+ */
+void emojivur_show_glyphs(emojivur_glyph_cache_t *cache, cairo_t *cairo_context, emoji_to_render_t emoji,
+                          const cairo_glyph_t *glyphs, const unsigned int *glyph_ids, unsigned int glyph_count)
+{
+    if (!emoji.glyph_fonts)
+    {
+        emojivur_glyph_cache_show_glyphs(cache, cairo_context, glyphs, glyph_count);
+        return;
+    }
+
+    unsigned int run_start = 0;
+    while (run_start < glyph_count)
+    {
+        uint8_t font = emoji.glyph_fonts[glyph_ids ? glyph_ids[run_start] : run_start];
+        unsigned int run_end = run_start + 1;
+        while (run_end < glyph_count && emoji.glyph_fonts[glyph_ids ? glyph_ids[run_end] : run_end] == font)
         {
-            pshared.cairo_glyphs[i].x += (margin_x / 2);
-            pshared.cairo_glyphs[i].y += height - (margin_y / 2);
+            ++run_end;
         }
-        else
+
+        cairo_set_font_face(cairo_context, emoji.font_faces[font]);
+        emojivur_glyph_cache_show_glyphs(cache, cairo_context, &glyphs[run_start], run_end - run_start);
+        run_start = run_end;
+    }
+    cairo_set_font_face(cairo_context, emoji.font_face);
+}
+
+/*!
+ * \brief Create the Cairo PDF Surface & Context to use to add pages to a new PDF document
+ *
+ * Writing to the standard output (`-`) or to an inherited file descriptor (`fd:N`) goes
+ * through a large buffer, so that the document can flow straight into a pipe.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param viewport          Size of the first page of the PDF document
+ * \param pdf_filename      File name for the PDF to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ * \return `false` if the PDF document could not be created (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_pdf_open(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport, char *pdf_filename)
+{
+    int pdf_fd = emojivur_output_fd(pdf_filename);
+    if (pdf_fd >= 0)
+    {
+        shared_data->output_stream = (emojivur_stream_t *)malloc(sizeof(emojivur_stream_t));
+        if (unlikely(!shared_data->output_stream))
         {
-            pshared.cairo_glyphs[i].x += (width / 2) - (text_width_in_pixels / 2);
-            pshared.cairo_glyphs[i].y += (height / 2) + (margin_y / 2);
+            return emojivur_fail(shared_data, "An error occured allocating the PDF output stream!");
         }
+        *shared_data->output_stream = emojivur_stream_default;
+        shared_data->output_stream->fd = pdf_fd;
+
+        return emojivur_try_pdf_open_stream(shared_data, viewport, emojivur_stream_write, shared_data->output_stream);
+    }
+
+    // Creating a cairo PDF Surface (each page gets resized to fit its own content)
+    shared_data->cairo_surface = cairo_pdf_surface_create(
+        pdf_filename,
+        viewport.w,
+        viewport.h);
+    if (unlikely(!shared_data->cairo_surface))
+    {
+        return emojivur_fail_surface(shared_data, "An error occured during Cairo PDF Surface creation!");
+    }
+
+    // Creating a Cairo context
+    shared_data->cairo_context = cairo_create(shared_data->cairo_surface);
+    if (unlikely(!shared_data->cairo_context))
+    {
+        return emojivur_fail_surface(shared_data, "An error occured during Cairo PDF Context creation!");
+    }
+
+    emojivur_set_pdf_metadata(shared_data->cairo_surface);
+
+    return true;
+}
+
+/*!
+ * \brief Create a new PDF document like `emojivur_try_pdf_open()`, exiting if it could not be created
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param viewport          Size of the first page of the PDF document
+ * \param pdf_filename      File name for the PDF to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ */
+void emojivur_pdf_open(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport, char *pdf_filename)
+{
+    if (unlikely(!emojivur_try_pdf_open(shared_data, viewport, pdf_filename)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Create the Cairo PDF Surface & Context to use to add pages to a new PDF document written through a function
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param viewport          Size of the first page of the PDF document
+ * \param write_func        Function the bytes of the PDF document are handed over to
+ * \param closure           Closure passed to `write_func`
+ *
+ * \return `false` if the PDF document could not be created (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_pdf_open_stream(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport,
+                                  cairo_write_func_t write_func, void *closure)
+{
+    // Creating a cairo PDF Surface (each page gets resized to fit its own content)
+    shared_data->cairo_surface = cairo_pdf_surface_create_for_stream(
+        write_func,
+        closure,
+        viewport.w,
+        viewport.h);
+    if (unlikely(cairo_surface_status(shared_data->cairo_surface) != CAIRO_STATUS_SUCCESS))
+    {
+        return emojivur_fail_surface(shared_data, "An error occured during Cairo PDF Surface creation!");
+    }
+
+    // Creating a Cairo context
+    shared_data->cairo_context = cairo_create(shared_data->cairo_surface);
+    if (unlikely(!shared_data->cairo_context))
+    {
+        return emojivur_fail_surface(shared_data, "An error occured during Cairo PDF Context creation!");
+    }
+
+    emojivur_set_pdf_metadata(shared_data->cairo_surface);
+
+    return true;
+}
+
+/*!
+ * \brief Create a new PDF document like `emojivur_try_pdf_open_stream()`, exiting if it could not be created
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param viewport          Size of the first page of the PDF document
+ * \param write_func        Function the bytes of the PDF document are handed over to
+ * \param closure           Closure passed to `write_func`
+ *
+ */
+void emojivur_pdf_open_stream(emojivur_shared_ptrs_t *shared_data, emoji_viewport_t viewport,
+                              cairo_write_func_t write_func, void *closure)
+{
+    if (unlikely(!emojivur_try_pdf_open_stream(shared_data, viewport, write_func, closure)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Draw a page of the PDF document
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+static void emojivur_pdf_draw_page(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    // Page size can only be changed before anything is drawn onto the page
+    cairo_pdf_surface_set_size(shared_data->cairo_surface, emoji.viewport.w, emoji.viewport.h);
+
+    cairo_set_source_rgba(shared_data->cairo_context, 0, 0, 0, 1.0);
+    cairo_set_font_face(shared_data->cairo_context, emoji.font_face);
+    cairo_set_font_size(shared_data->cairo_context, emoji.glyph_size);
+
+    // Render glyph onto cairo context
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_RENDER);
+    emojivur_show_glyphs(NULL, shared_data->cairo_context, emoji, emoji.glyphs, NULL, emoji.glyph_count);
+    emojivur_stats_stop(&timer);
+
+    // Flush page to render it and clear the context eventually for following pages
+    timer = emojivur_stats_start(EMOJIVUR_STAGE_OUTPUT);
+    cairo_show_page(shared_data->cairo_context);
+    emojivur_stats_stop(&timer);
+}
+
+/*!
+ * \brief Add a page containing all emojis provided on one line to the PDF document
+ *
+ * When fonts are subset the page is only drawn once the document is complete and all its glyphs are known.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ * \return `false` if the page could not be added (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_pdf_page(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    if (!shared_data->pdf_subset)
+    {
+        emojivur_pdf_draw_page(shared_data, emoji);
+        return true;
     }
 
-    emoji_to_render_t text_to_render =
+    emojivur_pdf_subset_page_t page =
         {
-            .viewport = {width, height},
-            .font_face = pshared.cairo_font_face,
-            .glyphs = pshared.cairo_glyphs,
-            .glyph_count = glyph_count,
-            .glyph_size = cli_args_info.pxsize_arg,
+            .width = emoji.viewport.w,
+            .height = emoji.viewport.h,
+            .glyph_size = emoji.glyph_size,
+            .font_face = emoji.font_face,
+            .font_faces = emoji.glyph_fonts ? emoji.font_faces : NULL,
+            .glyph_fonts = emoji.glyph_fonts,
+            .glyphs = emoji.glyphs,
+            .glyph_count = emoji.glyph_count,
         };
+    if (unlikely(!emojivur_pdf_subset_add_page(shared_data->pdf_subset, page)))
+    {
+        return emojivur_fail(shared_data, "An error occured holding back a page of the PDF document!");
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Add a page to the PDF document like `emojivur_try_pdf_page()`, exiting if it could not be added
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_pdf_page(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    if (unlikely(!emojivur_try_pdf_page(shared_data, emoji)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Complete the PDF document writing everything still pending to the file
+ *
+ * Cairo Surface & Context and the output stream (if any) are released even when writing fails.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ *
+ * \return `false` if the PDF document could not be written (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_pdf_close(emojivur_shared_ptrs_t *shared_data)
+{
+    if (shared_data->pdf_subset)
+    {
+        // Every font is subset once for the whole document so that all pages share the same embedded font
+        emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_OUTPUT);
+        emojivur_pdf_subset_build(shared_data->pdf_subset);
+        emojivur_stats_stop(&timer);
+
+        for (unsigned int i = 0; i < emojivur_pdf_subset_page_count(shared_data->pdf_subset); ++i)
+        {
+            emojivur_pdf_subset_page_t page = emojivur_pdf_subset_page(shared_data->pdf_subset, i);
+            emoji_to_render_t emoji =
+                {
+                    .viewport = {page.width, page.height},
+                    .font_face = page.font_face,
+                    .glyphs = (cairo_glyph_t *)page.glyphs,
+                    .glyph_count = page.glyph_count,
+                    .glyph_size = page.glyph_size,
+                    .font_faces = page.font_faces,
+                    .glyph_fonts = page.glyph_fonts,
+                };
+            emojivur_pdf_draw_page(shared_data, emoji);
+        }
+        emojivur_pdf_subset_clear(shared_data->pdf_subset);
+    }
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_OUTPUT);
+    cairo_destroy(shared_data->cairo_context);
+    shared_data->cairo_context = NULL;
+    cairo_surface_finish(shared_data->cairo_surface);
+    bool pdf_written = cairo_surface_status(shared_data->cairo_surface) == CAIRO_STATUS_SUCCESS;
+    cairo_surface_destroy(shared_data->cairo_surface);
+    shared_data->cairo_surface = NULL;
 
-    if (cli_args_info.output_given)
+    if (shared_data->output_stream)
     {
-        emojivur_pdf_output(&pshared, text_to_render, cli_args_info.output_arg);
+        pdf_written = emojivur_stream_flush(shared_data->output_stream) && pdf_written;
+        emojivur_stream_free(shared_data->output_stream);
+        free(shared_data->output_stream);
+        shared_data->output_stream = NULL;
+    }
+    emojivur_stats_stop(&timer);
+
+    if (unlikely(!pdf_written))
+    {
+        return emojivur_fail(shared_data, "An error occured writing the PDF document!");
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Complete the PDF document like `emojivur_try_pdf_close()`, exiting if it could not be written
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ *
+ */
+void emojivur_pdf_close(emojivur_shared_ptrs_t *shared_data)
+{
+    if (unlikely(!emojivur_try_pdf_close(shared_data)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Create a single page PDF document containing all emojis provided on one line
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param pdf_filename      File name for the PDF to create
+ *
+ */
+void emojivur_pdf_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *pdf_filename)
+{
+    emojivur_pdf_open(shared_data, emoji.viewport, pdf_filename);
+    emojivur_pdf_page(shared_data, emoji);
+    emojivur_pdf_close(shared_data);
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
+}
+
+/*!
+ * \brief Create a Cairo Image Surface & Context and render all emojis provided on one line onto it
+ *
+ * The image has a transparent background. The image put aside by `emojivur_image_recycle()`
+ * is cleared and reused instead of creating a new one when it has the same size.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ * \return `false` if the image could not be created (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_image_render(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    if (shared_data->image_surface &&
+        cairo_image_surface_get_width(shared_data->image_surface) == emoji.viewport.w &&
+        cairo_image_surface_get_height(shared_data->image_surface) == emoji.viewport.h)
+    {
+        shared_data->cairo_surface = shared_data->image_surface;
+        shared_data->cairo_context = shared_data->image_context;
+        shared_data->image_surface = NULL;
+        shared_data->image_context = NULL;
+
+        // Pixels were converted in place by the PNG encoder behind the back of Cairo
+        cairo_surface_mark_dirty(shared_data->cairo_surface);
+        cairo_set_operator(shared_data->cairo_context, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(shared_data->cairo_context);
+        cairo_set_operator(shared_data->cairo_context, CAIRO_OPERATOR_OVER);
+    }
+    else
+    {
+        shared_data->cairo_surface = cairo_image_surface_create(
+            CAIRO_FORMAT_ARGB32,
+            emoji.viewport.w,
+            emoji.viewport.h);
+        if (unlikely(cairo_surface_status(shared_data->cairo_surface) != CAIRO_STATUS_SUCCESS))
+        {
+            return emojivur_fail_surface(shared_data, "An error occured during Cairo Image Surface creation!");
+        }
 
-        // When generating a PDF no UI is going to be provided
-        // therefore nothing beyond this point should be executed!
-        return 0;
+        shared_data->cairo_context = cairo_create(shared_data->cairo_surface);
+        if (unlikely(!shared_data->cairo_context))
+        {
+            return emojivur_fail_surface(shared_data, "An error occured during Cairo Image Context creation!");
+        }
     }
 
-    emojivur_gui(&pshared, text_to_render);
+    cairo_set_source_rgba(shared_data->cairo_context, 0, 0, 0, 1.0);
+    cairo_set_font_face(shared_data->cairo_context, emoji.font_face);
+    cairo_set_font_size(shared_data->cairo_context, emoji.glyph_size);
+
+    // Render glyph onto cairo context (which render onto the image)
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_RENDER);
+    emojivur_show_glyphs(shared_data->glyph_cache, shared_data->cairo_context, emoji,
+                         emoji.glyphs, NULL, emoji.glyph_count);
+    cairo_surface_flush(shared_data->cairo_surface);
+    emojivur_stats_stop(&timer);
 
-    return 0;
+    return true;
+}
+
+/*!
+ * \brief Render all emojis provided on one line onto an image like `emojivur_try_image_render()`, exiting on errors
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_image_render(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    if (unlikely(!emojivur_try_image_render(shared_data, emoji)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Put the image rendered by `emojivur_image_render()` aside, to be reused by the next image of the same size
+ *
+ * Only one image is kept: the one put aside before (if any) is released.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ *
+ */
+void emojivur_image_recycle(emojivur_shared_ptrs_t *shared_data)
+{
+    if (shared_data->image_context)
+    {
+        cairo_destroy(shared_data->image_context);
+    }
+    if (shared_data->image_surface)
+    {
+        cairo_surface_destroy(shared_data->image_surface);
+    }
+
+    shared_data->image_context = shared_data->cairo_context;
+    shared_data->image_surface = shared_data->cairo_surface;
+    shared_data->cairo_context = NULL;
+    shared_data->cairo_surface = NULL;
+}
+
+/*!
+ * \brief Write a Cairo Image Surface as PNG image (its pixels get converted in place)
+ *
+ * Bytes are buffered by a stream kept in `shared_data` from one image to the next.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param surface           Cairo ARGB32 Image Surface to write
+ * \param png_filename      File name for the PNG to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ * \return `false` if the PNG image could not be written (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_png_surface_output(emojivur_shared_ptrs_t *shared_data, cairo_surface_t *surface,
+                                     char *png_filename)
+{
+    if (!shared_data->image_stream)
+    {
+        shared_data->image_stream = (emojivur_stream_t *)malloc(sizeof(emojivur_stream_t));
+        if (unlikely(!shared_data->image_stream))
+        {
+            return emojivur_fail(shared_data, "An error occured allocating the PNG output stream!");
+        }
+        *shared_data->image_stream = emojivur_stream_default;
+    }
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_OUTPUT);
+    int png_fd = emojivur_output_fd(png_filename);
+    bool png_file = png_fd < 0;
+    if (png_file)
+    {
+        png_fd = open(png_filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (unlikely(png_fd < 0))
+        {
+            emojivur_stats_stop(&timer);
+            return emojivur_fail(shared_data, "An error occured opening the PNG file for writing!");
+        }
+    }
+    shared_data->image_stream->fd = png_fd;
+
+    bool png_written = emojivur_png_write_stream(surface, emojivur_stream_write, shared_data->image_stream);
+    png_written = emojivur_stream_flush(shared_data->image_stream) && png_written;
+    if (png_file)
+    {
+        png_written = (close(png_fd) == 0) && png_written;
+    }
+    shared_data->image_stream->fd = -1;
+    emojivur_stats_stop(&timer);
+    if (unlikely(!png_written))
+    {
+        return emojivur_fail(shared_data, "An error occured writing the PNG image!");
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Write a Cairo Image Surface as PNG image like `emojivur_try_png_surface_output()`, exiting on errors
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param surface           Cairo ARGB32 Image Surface to write
+ * \param png_filename      File name for the PNG to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ */
+void emojivur_png_surface_output(emojivur_shared_ptrs_t *shared_data, cairo_surface_t *surface, char *png_filename)
+{
+    if (unlikely(!emojivur_try_png_surface_output(shared_data, surface, png_filename)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Write a PNG image containing all emojis provided on one line
+ *
+ * Unlike `emojivur_png_output()` the Cairo Image Surface & Context are only put
+ * aside once done, so that they can be reused along with font and HarfBuzz resources.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param png_filename      File name for the PNG to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ * \return `false` if the PNG image could not be written (see `shared_data->error_msg`)
+ *
+ */
+bool emojivur_try_png_file_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *png_filename)
+{
+    if (unlikely(!emojivur_try_image_render(shared_data, emoji)))
+    {
+        return false;
+    }
+    bool png_written = emojivur_try_png_surface_output(shared_data, shared_data->cairo_surface, png_filename);
+    emojivur_image_recycle(shared_data);
+
+    return png_written;
+}
+
+/*!
+ * \brief Write a PNG image like `emojivur_try_png_file_output()`, exiting if it could not be written
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param png_filename      File name for the PNG to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ */
+void emojivur_png_file_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *png_filename)
+{
+    if (unlikely(!emojivur_try_png_file_output(shared_data, emoji, png_filename)))
+    {
+        emojivur_exit(shared_data, shared_data->error_msg, 1);
+    }
+}
+
+/*!
+ * \brief Create a PNG image containing all emojis provided on one line
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param png_filename      File name for the PNG to create
+ *
+ */
+void emojivur_png_output(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, char *png_filename)
+{
+    emojivur_png_file_output(shared_data, emoji, png_filename);
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
+}
+
+/*!
+ * \brief Release the canvas used by Cairo to render the emojis onto the SDL2 window
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ *
+ */
+void emojivur_gui_destroy_canvas(emojivur_shared_ptrs_t *shared_data)
+{
+    if (shared_data->cairo_context)
+    {
+        cairo_destroy(shared_data->cairo_context);
+        shared_data->cairo_context = NULL;
+    }
+
+    if (shared_data->cairo_surface)
+    {
+        cairo_surface_destroy(shared_data->cairo_surface);
+        shared_data->cairo_surface = NULL;
+    }
+
+    if (shared_data->sdl_texture)
+    {
+        SDL_DestroyTexture(shared_data->sdl_texture);
+        shared_data->sdl_texture = NULL;
+    }
+}
+
+/*!
+ * \brief Create the canvas used by Cairo to render the emojis onto the SDL2 window
+ *
+ * The canvas is the streaming texture presented in the window, sized after the renderer output
+ * (which is HiDPI aware): Cairo renders straight into its pixels while the texture is locked.
+ * A tiny Cairo surface & context are created as well just to measure the glyphs.
+ * The canvas is meant to be created again only when the window size changes.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_gui_create_canvas(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    emojivur_gui_destroy_canvas(shared_data);
+
+    int renderer_width;
+    int renderer_height;
+    SDL_GetRendererOutputSize(shared_data->renderer, &renderer_width, &renderer_height);
+
+    // Create the only texture used to present the emojis (Cairo RGB24 has the same memory layout)
+    shared_data->sdl_texture = SDL_CreateTexture(
+        shared_data->renderer,
+        SDL_PIXELFORMAT_RGB888,
+        SDL_TEXTUREACCESS_STREAMING,
+        renderer_width,
+        renderer_height);
+    if (unlikely(!shared_data->sdl_texture))
+    {
+        char sdl_error_msg[128];
+
+        snprintf(sdl_error_msg, 127, "SDL_CreateTexture failed: %s\n", SDL_GetError());
+        emojivur_exit(shared_data, sdl_error_msg, 1);
+    }
+
+    // Get a Cairo context to measure glyphs without touching the texture
+    shared_data->cairo_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, 1, 1);
+    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_surface,
+                               "An error occured during the creation of the Cairo Surface used for measuring!", 1);
+    shared_data->cairo_context = cairo_create(shared_data->cairo_surface);
+    emojivur_ptr_valid_or_exit(shared_data, shared_data->cairo_context,
+                               "An error occured during main Cairo Context creation!", 1);
+    cairo_set_font_face(shared_data->cairo_context, emoji.font_face);
+    cairo_set_font_size(shared_data->cairo_context, emoji.glyph_size);
+}
+
+/*!
+ * \brief Measure the ink of a range of the glyphs to display
+ *
+ * Glyphs of fallback fonts are measured with their own font, one run of glyphs after the other.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param first             First glyph to measure
+ * \param end               Glyph after the last one to measure
+ * \param bounds            Bounding box of the ink of the glyphs (output, empty if they draw nothing)
+ *
+ * \return `true` if any of the glyphs draws something
+ *
+ */
+bool emojivur_gui_measure(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji, unsigned int first,
+                          unsigned int end, cairo_rectangle_t *bounds)
+{
+    double x0 = 0;
+    double y0 = 0;
+    double x1 = 0;
+    double y1 = 0;
+    bool measured = false;
+    for (unsigned int run_start = first; run_start < end;)
+    {
+        unsigned int run_end = emoji.glyph_fonts ? run_start + 1 : end;
+        while (run_end < end && emoji.glyph_fonts[run_end] == emoji.glyph_fonts[run_start])
+        {
+            ++run_end;
+        }
+        if (emoji.glyph_fonts)
+        {
+            cairo_set_font_face(shared_data->cairo_context, emoji.font_faces[emoji.glyph_fonts[run_start]]);
+        }
+
+        cairo_text_extents_t extents;
+        cairo_glyph_extents(shared_data->cairo_context, &emoji.glyphs[run_start], run_end - run_start, &extents);
+        // Runs with nothing to draw (e.g. just spaces) do not count
+        if (extents.width > 0 || extents.height > 0)
+        {
+            x0 = measured ? MIN(x0, extents.x_bearing) : extents.x_bearing;
+            y0 = measured ? MIN(y0, extents.y_bearing) : extents.y_bearing;
+            x1 = measured ? MAX(x1, extents.x_bearing + extents.width) : extents.x_bearing + extents.width;
+            y1 = measured ? MAX(y1, extents.y_bearing + extents.height) : extents.y_bearing + extents.height;
+            measured = true;
+        }
+        run_start = run_end;
+    }
+    if (emoji.glyph_fonts)
+    {
+        cairo_set_font_face(shared_data->cairo_context, emoji.font_face);
+    }
+    *bounds = (cairo_rectangle_t){x0, y0, x1 - x0, y1 - y0};
+
+    return measured;
+}
+
+/*!
+ * \brief Measure the ink of some lines of the laid out text, each from the origin of its baseline
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View keeping the extents of the lines (grown to hold them all)
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param first_line        First line to measure
+ * \param end_line          Line after the last one to measure
+ * \param line_delta        Change in the number of lines: the extents kept from line `end_line - line_delta`
+ *                          on are moved to line `end_line`
+ *
+ */
+void emojivur_gui_view_measure_lines(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view,
+                                     emoji_to_render_t emoji, unsigned int first_line, unsigned int end_line,
+                                     int line_delta)
+{
+    emojivur_layout_t *layout = shared_data->layout;
+    unsigned int line_count = emojivur_layout_line_count(layout);
+    if (line_count > view->line_extents_allocated)
+    {
+        unsigned int line_extents_allocated = MAX(line_count, view->line_extents_allocated * 2);
+        cairo_rectangle_t *line_extents = (cairo_rectangle_t *)realloc(
+            view->line_extents, line_extents_allocated * sizeof(cairo_rectangle_t));
+        emojivur_ptr_valid_or_exit(shared_data, line_extents, "An error occured allocating the extents of the lines!",
+                                   1);
+        view->line_extents = line_extents;
+        view->line_extents_allocated = line_extents_allocated;
+    }
+    if (line_delta != 0)
+    {
+        memmove(&view->line_extents[end_line], &view->line_extents[end_line - line_delta],
+                (line_count - end_line) * sizeof(cairo_rectangle_t));
+    }
+
+    for (unsigned int line = first_line; line < end_line; ++line)
+    {
+        unsigned int first = emojivur_layout_line_glyph(layout, line);
+        unsigned int end = line + 1 < line_count ? emojivur_layout_line_glyph(layout, line + 1) : emoji.glyph_count;
+        cairo_rectangle_t *extents = &view->line_extents[line];
+        if (emojivur_gui_measure(shared_data, emoji, first, end, extents))
+        {
+            extents->y -= line * (double)emoji.glyph_size;
+        }
+    }
+}
+
+/*!
+ * \brief Find the bounding box of the laid out text from the extents of its lines
+ *
+ * Only the extents kept are added up, nothing is measured: the time taken is proportional to the lines.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View whose content is updated
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_gui_view_content(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view,
+                               emoji_to_render_t emoji)
+{
+    // Empty lines and the caret past the end of a line are within reach of the view too
+    unsigned int line_count = emojivur_layout_line_count(shared_data->layout);
+    double x0 = 0;
+    double y0 = -GUI_CARET_ASCENT * emoji.glyph_size;
+    double x1 = emojivur_layout_width(shared_data->layout);
+    double y1 = (line_count - 1 + GUI_CARET_DESCENT) * emoji.glyph_size;
+    for (unsigned int line = 0; line < line_count; ++line)
+    {
+        const cairo_rectangle_t *extents = &view->line_extents[line];
+        if (extents->width > 0 || extents->height > 0)
+        {
+            double baseline = line * (double)emoji.glyph_size;
+            x0 = MIN(x0, extents->x);
+            y0 = MIN(y0, baseline + extents->y);
+            x1 = MAX(x1, extents->x + extents->width);
+            y1 = MAX(y1, baseline + extents->y + extents->height);
+        }
+    }
+    view->content = (cairo_rectangle_t){x0, y0, x1 - x0, y1 - y0};
+}
+
+/*!
+ * \brief Index the glyphs to display and measure them
+ *
+ * Measuring all glyphs takes a time proportional to their number: it is done only when they all move.
+ * Lines of a laid out text are measured one by one, so that edits measure again only the lines they change.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View to set up
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_gui_view_index(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, emoji_to_render_t emoji)
+{
+    emojivur_glyph_index_destroy(view->glyph_index);
+
+    // Cells a few glyphs wide keep both the index and the cells visited by each frame small
+    view->glyph_index = emojivur_glyph_index_create(emoji.glyphs, emoji.glyph_count,
+                                                    GUI_INDEX_CELL_GLYPHS * emoji.glyph_size,
+                                                    GUI_INDEX_REACH_GLYPHS * emoji.glyph_size);
+    emojivur_ptr_valid_or_exit(shared_data, view->glyph_index,
+                               "An error occured during the creation of the index of the glyphs!", 1);
+
+    if (shared_data->layout)
+    {
+        emojivur_gui_view_measure_lines(shared_data, view, emoji, 0, emojivur_layout_line_count(shared_data->layout),
+                                        0);
+        emojivur_gui_view_content(shared_data, view, emoji);
+    }
+    else
+    {
+        emojivur_gui_measure(shared_data, emoji, 0, emoji.glyph_count, &view->content);
+    }
+}
+
+/*!
+ * \brief Break the laid out text in lines fitting the window again, keeping the same line at the top of it
+ *
+ * Only the line breaks are computed again from the advances kept by the layout (no text is shaped),
+ * then the glyphs are moved to their new lines.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View showing the text
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ * \return `true` if the glyphs moved (and have to be indexed again)
+ *
+ */
+bool emojivur_gui_view_wrap(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, emoji_to_render_t emoji)
+{
+    emojivur_layout_t *layout = shared_data->layout;
+    if (!layout)
+    {
+        return false;
+    }
+
+    int window_width;
+    int window_height;
+    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+
+    // Half a glyph of margin on each side, as when the window is first sized
+    double width = MAX(window_width / view->zoom - emoji.glyph_size, emoji.glyph_size);
+    if (width == view->wrap_width)
+    {
+        return false;
+    }
+
+    // Lines are stacked below the first one, whose baseline is at 0
+    double line_height = emoji.glyph_size;
+    double top_line = MAX(floor(view->scroll_y / line_height) + 1, 0);
+    double top_offset = view->scroll_y - (top_line - 1) * line_height;
+    unsigned int anchor = emojivur_layout_line_glyph(layout, top_line);
+
+    if (unlikely(!emojivur_layout_wrap(layout, width)))
+    {
+        emojivur_exit(shared_data, "An error occured breaking the text in lines!", 1);
+    }
+    emojivur_layout_glyphs(layout, 0, 0, emoji.glyphs);
+    view->wrap_width = width;
+
+    unsigned int line_count = emojivur_layout_line_count(layout);
+    top_line = anchor < emoji.glyph_count ? emojivur_layout_glyph_line(layout, anchor) : line_count - 1;
+    view->scroll_y = (top_line - 1) * line_height + top_offset;
+
+    return true;
+}
+
+/*!
+ * \brief Replace part of the laid out text, patching the glyphs displayed instead of positioning them all again
+ *
+ * Only the clusters around the edit are shaped again (see `emojivur_layout_edit()`), and only the
+ * glyphs from the first line broken again on are positioned again: the ones before it stay where they are.
+ * Likewise only the lines broken again are measured, and only their glyphs are sorted in the index: the
+ * glyphs of the lines after them are just moved there.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View showing the text (its caret is moved past the text inserted)
+ * \param emoji             Configuration for the Cairo surface to create and render (updated)
+ * \param offset            Offset of the text to replace
+ * \param removed           Length in bytes of the text to replace
+ * \param inserted          UTF-8 text to insert in its place (NUL terminated)
+ *
+ */
+void emojivur_gui_view_edit(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, emoji_to_render_t *emoji,
+                            size_t offset, size_t removed, const char *inserted)
+{
+    emojivur_layout_t *layout = shared_data->layout;
+    size_t inserted_length = strlen(inserted);
+    unsigned int line_count = emojivur_layout_line_count(layout);
+    unsigned int first_line;
+    unsigned int end_line;
+    if (unlikely(!emojivur_layout_edit(layout, shared_data->tmp_buffer, offset, removed, inserted, inserted_length,
+                                       &first_line, &end_line)))
+    {
+        emojivur_exit(shared_data, "An error occured editing the text!", 1);
+    }
+    int glyph_delta = (int)emojivur_layout_glyph_count(layout) - (int)emoji->glyph_count;
+    int line_delta = (int)emojivur_layout_line_count(layout) - (int)line_count;
+    line_count = emojivur_layout_line_count(layout);
+    unsigned int first_glyph = emojivur_layout_line_glyph(layout, first_line);
+
+    // The vector grows geometrically, only the glyphs before the edit being copied over
+    unsigned int glyph_count = emojivur_layout_glyph_count(layout);
+    if (glyph_count > view->glyphs_allocated)
+    {
+        unsigned int glyphs_allocated = MAX(glyph_count, view->glyphs_allocated * 2);
+        cairo_glyph_t *glyphs = cairo_glyph_allocate(glyphs_allocated);
+        emojivur_ptr_valid_or_exit(shared_data, glyphs, "An error occured allocating the edited glyphs!", 1);
+        memcpy(glyphs, emoji->glyphs, first_glyph * sizeof(cairo_glyph_t));
+        cairo_glyph_free(emoji->glyphs);
+        emoji->glyphs = shared_data->cairo_glyphs = glyphs;
+        view->glyphs_allocated = shared_data->cairo_glyphs_allocated = glyphs_allocated;
+    }
+    emoji->glyph_count = glyph_count;
+    emoji->glyph_fonts = emojivur_layout_glyph_fonts(layout);
+
+    // Lines before the first one broken again stay the same, the ones after the lines broken again just move
+    emojivur_layout_glyphs(layout, first_line, 0, emoji->glyphs);
+    unsigned int end_glyph = end_line < line_count ? emojivur_layout_line_glyph(layout, end_line) : glyph_count;
+    emojivur_glyph_index_t *glyph_index = emojivur_glyph_index_update(view->glyph_index, emoji->glyphs, glyph_count,
+                                                                      first_glyph, end_glyph, glyph_delta);
+    emojivur_ptr_valid_or_exit(shared_data, glyph_index, "An error occured updating the index of the glyphs!", 1);
+    view->glyph_index = glyph_index;
+
+    emojivur_gui_view_measure_lines(shared_data, view, *emoji, first_line, end_line, line_delta);
+    emojivur_gui_view_content(shared_data, view, *emoji);
+    view->caret = MIN(offset, emojivur_layout_text_length(layout)) + inserted_length;
+}
+
+/*!
+ * \brief Keep as much of the emojis as possible in the window, centering them when they fit
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View to adjust
+ *
+ */
+void emojivur_gui_view_clamp(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view)
+{
+    int window_width;
+    int window_height;
+    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+
+    double visible_width = window_width / view->zoom;
+    double visible_height = window_height / view->zoom;
+
+    if (view->content.width <= visible_width)
+    {
+        view->scroll_x = view->content.x - (visible_width - view->content.width) / 2;
+    }
+    else
+    {
+        view->scroll_x = MIN(MAX(view->scroll_x, view->content.x),
+                             view->content.x + view->content.width - visible_width);
+    }
+
+    if (view->content.height <= visible_height)
+    {
+        view->scroll_y = view->content.y - (visible_height - view->content.height) / 2;
+    }
+    else
+    {
+        view->scroll_y = MIN(MAX(view->scroll_y, view->content.y),
+                             view->content.y + view->content.height - visible_height);
+    }
+}
+
+/*!
+ * \brief Scroll the emojis shown in the window
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View to scroll
+ * \param dx                Horizontal distance to scroll by in window coordinates
+ * \param dy                Vertical distance to scroll by in window coordinates
+ *
+ */
+void emojivur_gui_view_scroll(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, double dx, double dy)
+{
+    view->scroll_x += dx / view->zoom;
+    view->scroll_y += dy / view->zoom;
+    emojivur_gui_view_clamp(shared_data, view);
+}
+
+/*!
+ * \brief Zoom the emojis shown in the window keeping still the point under the anchor
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View to zoom
+ * \param zoom              New scale factor (clamped to the supported range)
+ * \param anchor_x          Horizontal position of the anchor in window coordinates
+ * \param anchor_y          Vertical position of the anchor in window coordinates
+ *
+ */
+void emojivur_gui_view_zoom(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, double zoom,
+                            double anchor_x, double anchor_y)
+{
+    double anchor_content_x = view->scroll_x + anchor_x / view->zoom;
+    double anchor_content_y = view->scroll_y + anchor_y / view->zoom;
+
+    view->zoom = MIN(MAX(zoom, GUI_ZOOM_MIN), GUI_ZOOM_MAX);
+    view->scroll_x = anchor_content_x - anchor_x / view->zoom;
+    view->scroll_y = anchor_content_y - anchor_y / view->zoom;
+    emojivur_gui_view_clamp(shared_data, view);
+}
+
+/*!
+ * \brief Scroll the view as little as needed to show the caret
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View to scroll
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_gui_view_reveal_caret(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view,
+                                    emoji_to_render_t emoji)
+{
+    int window_width;
+    int window_height;
+    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+
+    double caret_x;
+    double caret_baseline;
+    emojivur_layout_caret(shared_data->layout, view->caret, 0, &caret_x, &caret_baseline);
+    double caret_top = caret_baseline - GUI_CARET_ASCENT * emoji.glyph_size;
+    double caret_bottom = caret_baseline + GUI_CARET_DESCENT * emoji.glyph_size;
+
+    // Half a glyph of margin on each side of the caret
+    double margin = emoji.glyph_size / 2.0;
+    double visible_width = window_width / view->zoom;
+    double visible_height = window_height / view->zoom;
+    view->scroll_x = MIN(MAX(view->scroll_x, caret_x + margin - visible_width), caret_x - margin);
+    view->scroll_y = MIN(MAX(view->scroll_y, caret_bottom - visible_height), caret_top);
+    emojivur_gui_view_clamp(shared_data, view);
+}
+
+/*!
+ * \brief Release the resources of a view
+ *
+ * \param view              View to release
+ *
+ */
+void emojivur_gui_view_free(emojivur_gui_view_t *view)
+{
+    emojivur_glyph_index_destroy(view->glyph_index);
+    free(view->line_extents);
+    free(view->visible_ids);
+    free(view->visible_glyphs);
+    *view = (emojivur_gui_view_t){0};
+}
+
+/*!
+ * \brief Compute the area of the window covered by the emojis
+ *
+ * \param view              View of the emojis shown in the window
+ *
+ * \return Bounding box of the glyphs in window coordinates
+ *
+ */
+SDL_Rect emojivur_gui_glyphs_area(const emojivur_gui_view_t *view)
+{
+    // Round outwards to whole pixels so that antialiased edges are included
+    int x0 = floor((view->content.x - view->scroll_x) * view->zoom) - 1;
+    int y0 = floor((view->content.y - view->scroll_y) * view->zoom) - 1;
+    int x1 = ceil((view->content.x + view->content.width - view->scroll_x) * view->zoom) + 1;
+    int y1 = ceil((view->content.y + view->content.height - view->scroll_y) * view->zoom) + 1;
+
+    return (SDL_Rect){x0, y0, x1 - x0, y1 - y0};
+}
+
+/*!
+ * \brief Render the emojis straight into the pixels of the streaming texture
+ *
+ * Only the requested area of the texture is locked, redrawn and then uploaded, and
+ * only the glyphs which can be visible in that area are handed over to Cairo.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View of the emojis shown in the window
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param area              Area of the window to redraw in window coordinates (NULL for the whole window)
+ *
+ */
+void emojivur_gui_render(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, emoji_to_render_t emoji,
+                         const SDL_Rect *area)
+{
+    // Compute screen resolution
+    // On a HiDPI screen like Apple Retina Displays, renderer size is twice as window size
+    int window_width;
+    int window_height;
+    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+
+    int renderer_width;
+    int renderer_height;
+    SDL_GetRendererOutputSize(shared_data->renderer, &renderer_width, &renderer_height);
+
+    int cairo_x_multiplier = MAX(1, renderer_width / MAX(1, window_width));
+    int cairo_y_multiplier = MAX(1, renderer_height / MAX(1, window_height));
+
+    SDL_Rect window_rect = {0, 0, window_width, window_height};
+    SDL_Rect dirty_rect = window_rect;
+    if (area && !SDL_IntersectRect(area, &window_rect, &dirty_rect))
+    {
+        return;
+    }
+
+    SDL_Rect texture_rect = {0, 0, renderer_width, renderer_height};
+    SDL_Rect scaled_rect = {
+        dirty_rect.x * cairo_x_multiplier,
+        dirty_rect.y * cairo_y_multiplier,
+        dirty_rect.w * cairo_x_multiplier,
+        dirty_rect.h * cairo_y_multiplier,
+    };
+    SDL_Rect locked_rect;
+    if (!SDL_IntersectRect(&scaled_rect, &texture_rect, &locked_rect))
+    {
+        return;
+    }
+
+    // Only the glyphs which can be visible in the area to redraw, moved to window coordinates
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_GLYPHS);
+    unsigned int visible_count = 0;
+    if (unlikely(!emojivur_glyph_index_query(view->glyph_index,
+                                             view->scroll_x + dirty_rect.x / view->zoom,
+                                             view->scroll_y + dirty_rect.y / view->zoom,
+                                             view->scroll_x + (dirty_rect.x + dirty_rect.w) / view->zoom,
+                                             view->scroll_y + (dirty_rect.y + dirty_rect.h) / view->zoom,
+                                             &view->visible_ids, &view->visible_ids_allocated, &visible_count)))
+    {
+        emojivur_exit(shared_data, "An error occured looking up the visible glyphs!", 1);
+    }
+    if (visible_count > view->visible_glyphs_allocated)
+    {
+        free(view->visible_glyphs);
+        view->visible_glyphs_allocated = MAX(visible_count, view->visible_glyphs_allocated * 2);
+        view->visible_glyphs = (cairo_glyph_t *)malloc(view->visible_glyphs_allocated * sizeof(cairo_glyph_t));
+        emojivur_ptr_valid_or_exit(shared_data, view->visible_glyphs,
+                                   "An error occured allocating the visible glyphs!", 1);
+    }
+
+    // Zooming scales the font size rather than the context, so that cached glyphs are still used
+    for (unsigned int i = 0; i < visible_count; ++i)
+    {
+        const cairo_glyph_t *glyph = &emoji.glyphs[view->visible_ids[i]];
+        view->visible_glyphs[i].index = glyph->index;
+        view->visible_glyphs[i].x = (glyph->x - view->scroll_x) * view->zoom;
+        view->visible_glyphs[i].y = (glyph->y - view->scroll_y) * view->zoom;
+    }
+    emojivur_stats_stop(&timer);
+
+    void *pixels;
+    int pitch;
+    if (unlikely(SDL_LockTexture(shared_data->sdl_texture, &locked_rect, &pixels, &pitch) != 0))
+    {
+        char sdl_error_msg[128];
+
+        snprintf(sdl_error_msg, 127, "SDL_LockTexture failed: %s\n", SDL_GetError());
+        emojivur_exit(shared_data, sdl_error_msg, 1);
+    }
+
+    // Get Cairo surface from the locked texture pixels (no intermediate copy involved)
+    cairo_surface_t *cairo_surface = cairo_image_surface_create_for_data(
+        (unsigned char *)pixels,
+        CAIRO_FORMAT_RGB24,
+        locked_rect.w,
+        locked_rect.h,
+        pitch);
+
+    // Scale cairo to use screen resolution and move its origin to the top left corner of the window
+    cairo_surface_set_device_scale(cairo_surface, cairo_x_multiplier, cairo_y_multiplier);
+    cairo_surface_set_device_offset(cairo_surface, -locked_rect.x, -locked_rect.y);
+
+    cairo_t *cairo_context = cairo_create(cairo_surface);
+
+    // Locked pixels are write-only: the whole area has to be filled (in white)
+    cairo_set_source_rgba(cairo_context, 1.0, 1.0, 1.0, 1.0);
+    cairo_paint(cairo_context);
+
+    // Render glyph onto cairo context (which render onto the texture)
+    timer = emojivur_stats_start(EMOJIVUR_STAGE_RENDER);
+    cairo_set_source_rgba(cairo_context, 0, 0, 0, 1.0);
+    cairo_set_font_face(cairo_context, emoji.font_face);
+    cairo_set_font_size(cairo_context, emoji.glyph_size * view->zoom);
+    emojivur_show_glyphs(shared_data->glyph_cache, cairo_context, emoji, view->visible_glyphs, view->visible_ids,
+                         visible_count);
+    emojivur_stats_stop(&timer);
+
+    // The caret of the text being edited, before the cluster it inserts characters at
+    if (shared_data->layout)
+    {
+        double caret_x;
+        double caret_baseline;
+        emojivur_layout_caret(shared_data->layout, view->caret, 0, &caret_x, &caret_baseline);
+        cairo_rectangle(cairo_context, round((caret_x - view->scroll_x) * view->zoom) - GUI_CARET_WIDTH / 2.0,
+                        (caret_baseline - GUI_CARET_ASCENT * emoji.glyph_size - view->scroll_y) * view->zoom,
+                        GUI_CARET_WIDTH, (GUI_CARET_ASCENT + GUI_CARET_DESCENT) * emoji.glyph_size * view->zoom);
+        cairo_fill(cairo_context);
+    }
+
+    cairo_destroy(cairo_context);
+    cairo_surface_finish(cairo_surface);
+    cairo_surface_destroy(cairo_surface);
+
+    // Unlocking uploads the locked area only
+    SDL_UnlockTexture(shared_data->sdl_texture);
+}
+
+/*!
+ * \brief Notify the window created by `emojivur_gui()` that the emojis to display changed
+ *
+ * It is safe to call this function from any thread: the actual redraw happens
+ * in the event loop of the window.
+ *
+ */
+void emojivur_gui_content_changed(void)
+{
+    if (emojivur_content_changed_event == (Uint32)-1)
+    {
+        return;
+    }
+
+    SDL_Event event = {0};
+    event.type = emojivur_content_changed_event;
+    SDL_PushEvent(&event);
+}
+
+/*!
+ * \brief Move or zoom the view according to a key pressed
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View to move or zoom
+ * \param emoji             Configuration for the Cairo surface to create and render
+ * \param key               Key pressed
+ *
+ * \return `true` if the view changed
+ *
+ */
+bool emojivur_gui_view_key(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, emoji_to_render_t emoji,
+                           const SDL_Keysym *key)
+{
+    int window_width;
+    int window_height;
+    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+
+    // Paging goes along the longest side of the emojis (i.e. horizontally for a single line)
+    double step = GUI_SCROLL_STEP_GLYPHS * emoji.glyph_size * view->zoom;
+    bool page_horizontally = view->content.width * window_height > view->content.height * window_width;
+    double page = page_horizontally ? window_width * 0.9 : window_height * 0.9;
+    double end = (view->content.width + view->content.height) * view->zoom;
+
+    // While the text is edited +, - and 0 are typed in it: zooming takes Ctrl (or Cmd) then
+    bool typing = shared_data->layout && !(key->mod & (KMOD_CTRL | KMOD_GUI));
+
+    switch (key->sym)
+    {
+    case SDLK_LEFT:
+        emojivur_gui_view_scroll(shared_data, view, -step, 0);
+        return true;
+    case SDLK_RIGHT:
+        emojivur_gui_view_scroll(shared_data, view, step, 0);
+        return true;
+    case SDLK_UP:
+        emojivur_gui_view_scroll(shared_data, view, 0, -step);
+        return true;
+    case SDLK_DOWN:
+        emojivur_gui_view_scroll(shared_data, view, 0, step);
+        return true;
+    case SDLK_PAGEUP:
+    case SDLK_PAGEDOWN:
+        page = key->sym == SDLK_PAGEUP ? -page : page;
+        emojivur_gui_view_scroll(shared_data, view, page_horizontally ? page : 0, page_horizontally ? 0 : page);
+        return true;
+    case SDLK_HOME:
+    case SDLK_END:
+        end = key->sym == SDLK_HOME ? -end : end;
+        emojivur_gui_view_scroll(shared_data, view, end, end);
+        return true;
+    case SDLK_PLUS:
+    case SDLK_EQUALS:
+    case SDLK_KP_PLUS:
+        if (typing)
+        {
+            return false;
+        }
+        emojivur_gui_view_zoom(shared_data, view, view->zoom * GUI_ZOOM_KEY_STEP, window_width / 2.0,
+                               window_height / 2.0);
+        return true;
+    case SDLK_MINUS:
+    case SDLK_KP_MINUS:
+        if (typing)
+        {
+            return false;
+        }
+        emojivur_gui_view_zoom(shared_data, view, view->zoom / GUI_ZOOM_KEY_STEP, window_width / 2.0,
+                               window_height / 2.0);
+        return true;
+    case SDLK_0:
+    case SDLK_KP_0:
+        if (typing)
+        {
+            return false;
+        }
+        emojivur_gui_view_zoom(shared_data, view, 1.0, window_width / 2.0, window_height / 2.0);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*!
+ * \brief Edit the laid out text or move its caret according to a key pressed
+ *
+ * Characters typed come as text input events instead: only the keys which do not type any are handled here.
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param view              View showing the text
+ * \param emoji             Configuration for the Cairo surface to create and render (updated)
+ * \param key               Key pressed
+ *
+ * \return `true` if the key was handled (and the caret has to be shown)
+ *
+ */
+bool emojivur_gui_edit_key(emojivur_shared_ptrs_t *shared_data, emojivur_gui_view_t *view, emoji_to_render_t *emoji,
+                           const SDL_Keysym *key)
+{
+    emojivur_layout_t *layout = shared_data->layout;
+
+    // Whole clusters are deleted and stepped over, so that no emoji sequence is ever split
+    switch (key->sym)
+    {
+    case SDLK_LEFT:
+        view->caret = emojivur_layout_cluster_before(layout, view->caret);
+        return true;
+    case SDLK_RIGHT:
+        view->caret = emojivur_layout_cluster_after(layout, view->caret);
+        return true;
+    case SDLK_BACKSPACE:
+    case SDLK_DELETE:
+    {
+        size_t start = key->sym == SDLK_BACKSPACE ? emojivur_layout_cluster_before(layout, view->caret) : view->caret;
+        size_t end = key->sym == SDLK_BACKSPACE ? view->caret : emojivur_layout_cluster_after(layout, view->caret);
+        if (end > start)
+        {
+            emojivur_gui_view_edit(shared_data, view, emoji, start, end - start, "");
+        }
+        return true;
+    }
+    case SDLK_RETURN:
+    case SDLK_KP_ENTER:
+        emojivur_gui_view_edit(shared_data, view, emoji, view->caret, 0, "\n");
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*!
+ * \brief Create a window based on SDL2 to display the emojis provided
+ *
+ * When the text comes with its layout (`shared_data->layout`) its lines are wrapped at the
+ * width of the window, again whenever the window is resized or zoomed, and the text can be edited:
+ * characters typed are inserted at the caret (moved with the left & right keys, Backspace & Delete
+ * deleting the cluster before or after it), only the clusters around each edit being shaped again.
+ * Zooming with the keys takes Ctrl (or Cmd) then. The window is redrawn
+ * only when needed (i.e. on expose, resize, scroll, zoom, edit or content change events) while waiting
+ * for events in between, so that no CPU time is used when nothing changes. Emojis which do not fit in the window
+ * can be scrolled (with the mouse wheel, by dragging them or with the arrow, page & home/end keys) and zoomed (holding Ctrl while using
+ * the mouse wheel or with the +, - & 0 keys).
+ *
+ * \param shared_data       Shared data like Cairo, HarfBuzz and SDL specifics
+ * \param emoji             Configuration for the Cairo surface to create and render
+ *
+ */
+void emojivur_gui(emojivur_shared_ptrs_t *shared_data, emoji_to_render_t emoji)
+{
+    // Draw text in SDL2 with Cairo
+    SDL_WindowFlags videoFlags = SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_RESIZABLE;
+
+    shared_data->window = SDL_CreateWindow(APP_NAME, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                           emoji.viewport.w, emoji.viewport.h, videoFlags);
+    if (unlikely(!shared_data->window))
+    {
+        char sdl_error_msg[128];
+
+        snprintf(sdl_error_msg, 127, "Window could not be created! SDL2: %s\n", SDL_GetError());
+        emojivur_exit(shared_data, sdl_error_msg, 1);
+    }
+
+    shared_data->renderer = SDL_CreateRenderer(shared_data->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (unlikely(!shared_data->renderer))
+    {
+        char sdl_error_msg[128];
+
+        snprintf(sdl_error_msg, 127, "SDL_CreateRenderer failed: %s\n", SDL_GetError());
+        emojivur_exit(shared_data, sdl_error_msg, 1);
+    }
+
+    emojivur_content_changed_event = SDL_RegisterEvents(1);
+
+    // Glyphs of a laid out text are edited in the vector allocated for them, growing it when needed
+    emojivur_gui_view_t view = {.zoom = 1.0, .glyphs_allocated = MAX(emoji.glyph_count, 1)};
+    if (shared_data->layout)
+    {
+        view.caret = emojivur_layout_text_length(shared_data->layout);
+        SDL_StartTextInput();
+    }
+    bool done = false;
+    bool caret_moved = false;
+    bool resize_needed = true;
+    bool render_needed = false;
+    bool view_changed = false;
+    bool present_needed = true;
+    bool dragging = false;
+    SDL_Rect drawn_area = {0, 0, 0, 0};
+    SDL_Event event;
+    do
+    {
+        if (resize_needed)
+        {
+            // Glyphs are measured with the context created together with the canvas
+            emojivur_gui_create_canvas(shared_data, emoji);
+            bool first_index = !view.glyph_index;
+            if (emojivur_gui_view_wrap(shared_data, &view, emoji) || first_index)
+            {
+                emojivur_gui_view_index(shared_data, &view, emoji);
+            }
+            if (first_index)
+            {
+                // Texts not fitting in the window are shown from their beginning
+                view.scroll_x = view.content.x;
+                view.scroll_y = view.content.y;
+            }
+            emojivur_gui_view_clamp(shared_data, &view);
+            resize_needed = false;
+            view_changed = true;
+        }
+
+        if (render_needed)
+        {
+            // Glyphs changed: index and measure them again, keeping the view where it is
+            emojivur_gui_view_index(shared_data, &view, emoji);
+            emojivur_gui_view_clamp(shared_data, &view);
+            if (!view_changed)
+            {
+                // Redraw only where the emojis were and where they are now
+                SDL_Rect glyphs_area = emojivur_gui_glyphs_area(&view);
+                SDL_Rect dirty_area;
+                SDL_UnionRect(&drawn_area, &glyphs_area, &dirty_area);
+                emojivur_gui_render(shared_data, &view, emoji, &dirty_area);
+                drawn_area = glyphs_area;
+                present_needed = true;
+            }
+            render_needed = false;
+        }
+
+        if (caret_moved)
+        {
+            emojivur_gui_view_reveal_caret(shared_data, &view, emoji);
+            caret_moved = false;
+            view_changed = true;
+        }
+
+        if (view_changed)
+        {
+            // Zooming changes how many glyphs fit in the width of the window
+            if (emojivur_gui_view_wrap(shared_data, &view, emoji))
+            {
+                emojivur_gui_view_index(shared_data, &view, emoji);
+                emojivur_gui_view_clamp(shared_data, &view);
+            }
+
+            // A new texture has undefined content and a moved view moves every glyph: draw it all
+            emojivur_gui_render(shared_data, &view, emoji, NULL);
+            drawn_area = emojivur_gui_glyphs_area(&view);
+            view_changed = false;
+            present_needed = true;
+        }
+
+        if (present_needed)
+        {
+            // Render the streaming texture onto SDL2 renderer
+            SDL_RenderCopy(shared_data->renderer, shared_data->sdl_texture, 0, 0);
+            SDL_RenderPresent(shared_data->renderer);
+            present_needed = false;
+        }
+
+        // Sleep until something happens, then handle all the pending events at once
+        if (unlikely(!SDL_WaitEvent(&event)))
+        {
+            break;
+        }
+        do
+        {
+            switch (event.type)
+            {
+            case SDL_QUIT:
+                done = true;
+                break;
+
+            case SDL_WINDOWEVENT:
+                if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                {
+                    resize_needed = true;
+                }
+                else if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+                {
+                    present_needed = true;
+                }
+                break;
+
+            // All textures are lost when the render device is reset
+            case SDL_RENDER_DEVICE_RESET:
+                resize_needed = true;
+                break;
+
+            case SDL_MOUSEWHEEL:
+            {
+                int wheel_x = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.x : event.wheel.x;
+                int wheel_y = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y;
+                if (SDL_GetModState() & (KMOD_CTRL | KMOD_GUI))
+                {
+                    int mouse_x;
+                    int mouse_y;
+                    SDL_GetMouseState(&mouse_x, &mouse_y);
+                    emojivur_gui_view_zoom(shared_data, &view, view.zoom * pow(GUI_ZOOM_WHEEL_STEP, wheel_y),
+                                           mouse_x, mouse_y);
+                }
+                else
+                {
+                    // A single line of emojis scrolls sideways with a plain mouse wheel too
+                    int window_width;
+                    int window_height;
+                    SDL_GetWindowSize(shared_data->window, &window_width, &window_height);
+                    bool fits_vertically = view.content.height * view.zoom <= window_height;
+                    if (fits_vertically || (SDL_GetModState() & KMOD_SHIFT))
+                    {
+                        wheel_x += wheel_y;
+                        wheel_y = 0;
+                    }
+                    double step = GUI_SCROLL_STEP_GLYPHS * emoji.glyph_size * view.zoom;
+                    emojivur_gui_view_scroll(shared_data, &view, -wheel_x * step, -wheel_y * step);
+                }
+                view_changed = true;
+                break;
+            }
+
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                if (event.button.button == SDL_BUTTON_LEFT)
+                {
+                    dragging = event.type == SDL_MOUSEBUTTONDOWN;
+                }
+                break;
+
+            case SDL_MOUSEMOTION:
+                if (dragging && (event.motion.xrel || event.motion.yrel))
+                {
+                    emojivur_gui_view_scroll(shared_data, &view, -event.motion.xrel, -event.motion.yrel);
+                    view_changed = true;
+                }
+                break;
+
+            case SDL_KEYDOWN:
+                if (shared_data->layout && emojivur_gui_edit_key(shared_data, &view, &emoji, &event.key.keysym))
+                {
+                    caret_moved = true;
+                }
+                else
+                {
+                    view_changed |= emojivur_gui_view_key(shared_data, &view, emoji, &event.key.keysym);
+                }
+                break;
+
+            case SDL_TEXTINPUT:
+                if (shared_data->layout)
+                {
+                    emojivur_gui_view_edit(shared_data, &view, &emoji, view.caret, 0, event.text.text);
+                    caret_moved = true;
+                }
+                break;
+
+            default:
+                if (event.type == emojivur_content_changed_event)
+                {
+                    render_needed = true;
+                }
+                break;
+            }
+        } while (SDL_PollEvent(&event));
+    } while (!done);
+
+    if (shared_data->layout)
+    {
+        SDL_StopTextInput();
+    }
+    emojivur_content_changed_event = (Uint32)-1;
+    emojivur_gui_view_free(&view);
+
+    // Clean up destroying Cairo & HarfBuzz resources
+    emojivur_cleanup(shared_data);
 }
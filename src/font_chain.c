@@ -0,0 +1,541 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       font_chain.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Ordered fonts falling back on each other, loaded only when needed
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cairo/cairo.h>
+#include <harfbuzz/hb.h>
+#ifdef HARFBUZZ_IS_OLD
+#include "harfbuzz_bkport.h"
+#endif
+
+#include "config.h"
+#include "emojivur.h"
+#include "font_chain.h"
+#include "line_break.h"
+
+// Codepoints are split in pages of 256 (0x110000 codepoints in Unicode)
+#define EMOJIVUR_COVERAGE_PAGES (0x110000 >> 8)
+
+// Pages all codepoints of which are missing or covered share the first two pages of bits
+#define EMOJIVUR_COVERAGE_EMPTY 0
+#define EMOJIVUR_COVERAGE_FULL 1
+
+/*!
+ * \brief Codepoints covered by a font as a two-level bitset
+ *
+ * Looking a codepoint up takes two reads whatever the font: one in the table of pages and one in the bits.
+ *
+ */
+typedef struct
+{
+    uint16_t pages[EMOJIVUR_COVERAGE_PAGES]; /**< Page of bits of each block of 256 codepoints */
+    uint64_t (*bits)[4];                     /**< Pages of 256 bits (empty and full ones first) */
+    unsigned int page_count;                 /**< Number of pages of bits */
+} emojivur_coverage_t;
+
+/*!
+ * \brief Font of a fallback chain
+ *
+ */
+typedef struct
+{
+    char *font_filename;          /**< File name of the font (NULL for the first font) */
+    unsigned int face_index;      /**< Index of the face in the font file */
+    emojivur_coverage_t coverage; /**< Codepoints covered by the font */
+    emojivur_shared_ptrs_t fonts; /**< HarfBuzz & Cairo fonts (loaded by the first run needing them) */
+} emojivur_font_chain_entry_t;
+
+/*!
+ * \brief Ordered fonts falling back on each other
+ *
+ */
+struct emojivur_font_chain
+{
+    hb_font_t *harfbuzz_font;               /**< HarfBuzz font of the first font (its scale applies to all fonts) */
+    emojivur_font_chain_entry_t *entries;   /**< Fonts in chain order */
+    cairo_font_face_t **cairo_font_faces;   /**< Cairo font faces in chain order (NULL until loaded) */
+    unsigned int font_count;                /**< Number of fonts */
+};
+
+/*!
+ * \brief Split a font given on the command line in file name and face index
+ *
+ * A font is given as `FILENAME` or as `FILENAME:N` to pick the face `N` of a collection (e.g. a `.ttc` file).
+ *
+ * \param font_spec         Font as given on the command line
+ * \param font_filename     Buffer to write the file name of the font to
+ * \param size              Size of the buffer
+ * \param face_index        Index of the face in the font file (output)
+ *
+ * \return `true` on success, `false` if the file name does not fit the buffer
+ *
+ */
+bool emojivur_font_spec(const char *font_spec, char *font_filename, size_t size, unsigned int *face_index)
+{
+    size_t length = strlen(font_spec);
+    *face_index = 0;
+
+    // Files whose name just looks like having a face index (and pipes) are taken as they are
+    const char *colon = strrchr(font_spec, ':');
+    if (colon && colon[1] && strspn(colon + 1, "0123456789") == strlen(colon + 1) && access(font_spec, F_OK) != 0)
+    {
+        *face_index = strtoul(colon + 1, NULL, 10);
+        length = colon - font_spec;
+    }
+
+    if (unlikely(length >= size))
+    {
+        return false;
+    }
+    memcpy(font_filename, font_spec, length);
+    font_filename[length] = '\0';
+
+    return true;
+}
+
+/*!
+ * \brief Read the codepoints covered by a font face
+ *
+ * \param coverage          Coverage to fill in
+ * \param harfbuzz_face     HarfBuzz face of the font
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_coverage_build(emojivur_coverage_t *coverage, hb_face_t *harfbuzz_face)
+{
+    hb_set_t *unicodes = hb_set_create();
+    if (unlikely(!hb_set_allocation_successful(unicodes)))
+    {
+        hb_set_destroy(unicodes);
+        return false;
+    }
+    hb_face_collect_unicodes(harfbuzz_face, unicodes);
+
+    unsigned int allocated = 16;
+    memset(coverage->pages, 0, sizeof(coverage->pages));
+    coverage->bits = (uint64_t(*)[4])calloc(allocated, sizeof(*coverage->bits));
+    if (unlikely(!coverage->bits))
+    {
+        hb_set_destroy(unicodes);
+        return false;
+    }
+    memset(coverage->bits[EMOJIVUR_COVERAGE_FULL], 0xFF, sizeof(*coverage->bits));
+    coverage->page_count = 2;
+
+    // Ranges come sorted and disjoint: a page is either covered whole by a range or filled in bit by bit
+    hb_codepoint_t first = HB_SET_VALUE_INVALID;
+    hb_codepoint_t last = HB_SET_VALUE_INVALID;
+    while (hb_set_next_range(unicodes, &first, &last) && first < 0x110000)
+    {
+        last = MIN(last, 0x10FFFF);
+        for (hb_codepoint_t codepoint = first; codepoint <= last;)
+        {
+            unsigned int page = codepoint >> 8;
+            hb_codepoint_t page_last = MIN(last, (page << 8) | 0xFF);
+            if ((codepoint & 0xFF) == 0 && (page_last & 0xFF) == 0xFF)
+            {
+                coverage->pages[page] = EMOJIVUR_COVERAGE_FULL;
+                codepoint = page_last + 1;
+                continue;
+            }
+
+            if (coverage->pages[page] == EMOJIVUR_COVERAGE_EMPTY)
+            {
+                if (coverage->page_count == allocated)
+                {
+                    uint64_t(*bits)[4] = (uint64_t(*)[4])realloc(coverage->bits, allocated * 2 * sizeof(*bits));
+                    if (unlikely(!bits))
+                    {
+                        hb_set_destroy(unicodes);
+                        return false;
+                    }
+                    coverage->bits = bits;
+                    allocated *= 2;
+                }
+                memset(coverage->bits[coverage->page_count], 0, sizeof(*coverage->bits));
+                coverage->pages[page] = coverage->page_count++;
+            }
+
+            uint64_t *bits = coverage->bits[coverage->pages[page]];
+            for (; codepoint <= page_last; ++codepoint)
+            {
+                bits[(codepoint >> 6) & 3] |= (uint64_t)1 << (codepoint & 63);
+            }
+        }
+
+        // The range may end at the last codepoint representable
+        if (last == 0x10FFFF)
+        {
+            break;
+        }
+    }
+    hb_set_destroy(unicodes);
+
+    return true;
+}
+
+/*!
+ * \brief Check whether a font covers a codepoint
+ *
+ * \param coverage          Codepoints covered by the font
+ * \param codepoint         Codepoint to look up
+ *
+ * \return `true` if the font maps the codepoint to a glyph
+ *
+ */
+static inline bool emojivur_coverage_has(const emojivur_coverage_t *coverage, uint32_t codepoint)
+{
+    if (unlikely(codepoint >= 0x110000))
+    {
+        return false;
+    }
+    const uint64_t *bits = coverage->bits[coverage->pages[codepoint >> 8]];
+
+    return (bits[(codepoint >> 6) & 3] >> (codepoint & 63)) & 1;
+}
+
+/*!
+ * \brief Create a fallback chain starting with a font already loaded
+ *
+ * \param harfbuzz_font     HarfBuzz font of the first font (not owned: its scale applies to all fonts)
+ * \param cairo_font_face   Cairo font face of the first font (not owned)
+ *
+ * \return The new chain, NULL on failure
+ *
+ */
+emojivur_font_chain_t *emojivur_font_chain_create(hb_font_t *harfbuzz_font, cairo_font_face_t *cairo_font_face)
+{
+    emojivur_font_chain_t *chain = (emojivur_font_chain_t *)calloc(1, sizeof(emojivur_font_chain_t));
+    if (unlikely(!chain))
+    {
+        return NULL;
+    }
+    chain->harfbuzz_font = harfbuzz_font;
+    chain->entries = (emojivur_font_chain_entry_t *)calloc(1, sizeof(emojivur_font_chain_entry_t));
+    chain->cairo_font_faces = (cairo_font_face_t **)calloc(1, sizeof(cairo_font_face_t *));
+    if (unlikely(!chain->entries || !chain->cairo_font_faces))
+    {
+        emojivur_font_chain_destroy(chain);
+        return NULL;
+    }
+
+    // The first font is loaded already and it is not owned by the chain (nor covered until a font backs it up)
+    chain->entries[0].fonts = emojivur_shared_ptrs_default;
+    chain->entries[0].fonts.harfbuzz_font = harfbuzz_font;
+    chain->entries[0].fonts.cairo_font_face = cairo_font_face;
+    chain->cairo_font_faces[0] = cairo_font_face;
+    chain->font_count = 1;
+
+    return chain;
+}
+
+/*!
+ * \brief Append a font to a fallback chain
+ *
+ * Only the codepoints the font covers are read now: the font is loaded by the first run of text needing it.
+ *
+ * \param chain             Chain to add the font to
+ * \param font_filename     File name of the font
+ * \param face_index        Index of the face in the font file
+ *
+ * \return `true` on success, `false` if the font cannot be read or the chain is full
+ *
+ */
+bool emojivur_font_chain_add(emojivur_font_chain_t *chain, const char *font_filename, unsigned int face_index)
+{
+    if (unlikely(chain->font_count == EMOJIVUR_FONT_CHAIN_MAX))
+    {
+        return false;
+    }
+    if (!chain->entries[0].coverage.bits &&
+        unlikely(!emojivur_coverage_build(&chain->entries[0].coverage, hb_font_get_face(chain->harfbuzz_font))))
+    {
+        return false;
+    }
+
+    emojivur_font_chain_entry_t *entries = (emojivur_font_chain_entry_t *)realloc(
+        chain->entries, (chain->font_count + 1) * sizeof(emojivur_font_chain_entry_t));
+    if (unlikely(!entries))
+    {
+        return false;
+    }
+    chain->entries = entries;
+    cairo_font_face_t **cairo_font_faces = (cairo_font_face_t **)realloc(
+        chain->cairo_font_faces, (chain->font_count + 1) * sizeof(cairo_font_face_t *));
+    if (unlikely(!cairo_font_faces))
+    {
+        return false;
+    }
+    chain->cairo_font_faces = cairo_font_faces;
+
+    // The font file is mapped just long enough to read its character map
+    hb_blob_t *harfbuzz_blob = hb_blob_create_from_file(font_filename);
+    hb_face_t *harfbuzz_face = hb_face_create(harfbuzz_blob, face_index);
+    emojivur_font_chain_entry_t *entry = &chain->entries[chain->font_count];
+    *entry = (emojivur_font_chain_entry_t){.face_index = face_index, .fonts = emojivur_shared_ptrs_default};
+    // Faces past the last one of the file come out empty
+    bool readable = hb_blob_get_length(harfbuzz_blob) > 0 && hb_face_get_glyph_count(harfbuzz_face) > 0;
+    bool added = readable && emojivur_coverage_build(&entry->coverage, harfbuzz_face) &&
+                 (entry->font_filename = strdup(font_filename)) != NULL;
+    hb_face_destroy(harfbuzz_face);
+    hb_blob_destroy(harfbuzz_blob);
+    if (unlikely(!added))
+    {
+        free(entry->coverage.bits);
+        return false;
+    }
+
+    chain->cairo_font_faces[chain->font_count++] = NULL;
+
+    return true;
+}
+
+/*!
+ * \brief Destroy a fallback chain releasing the fonts it loaded
+ *
+ * \param chain             Chain to destroy (can be NULL)
+ *
+ */
+void emojivur_font_chain_destroy(emojivur_font_chain_t *chain)
+{
+    if (!chain)
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; chain->entries && i < MAX(chain->font_count, 1); ++i)
+    {
+        // The first font belongs to the caller
+        if (i > 0)
+        {
+            emojivur_release(&chain->entries[i].fonts);
+        }
+        free(chain->entries[i].font_filename);
+        free(chain->entries[i].coverage.bits);
+    }
+    free(chain->entries);
+    free(chain->cairo_font_faces);
+    free(chain);
+}
+
+/*!
+ * \brief Get the number of fonts of a fallback chain
+ *
+ * \param chain             Chain
+ *
+ * \return Number of fonts
+ *
+ */
+unsigned int emojivur_font_chain_count(const emojivur_font_chain_t *chain)
+{
+    return chain->font_count;
+}
+
+/*!
+ * \brief Check whether a character attaches to the one before it (marks, selectors, modifiers & tags)
+ *
+ * \param codepoint         Codepoint of the character
+ *
+ * \return `true` if the character belongs with the one before it
+ *
+ */
+static inline bool emojivur_font_chain_attaches(uint32_t codepoint)
+{
+    return codepoint == 0x200D || (codepoint >= 0xFE00 && codepoint <= 0xFE0F) ||
+           (codepoint >= 0x0300 && codepoint <= 0x036F) || (codepoint >= 0x20D0 && codepoint <= 0x20FF) ||
+           (codepoint >= 0x1F3FB && codepoint <= 0x1F3FF) || (codepoint >= 0xE0020 && codepoint <= 0xE007F);
+}
+
+/*!
+ * \brief Check whether a character is a regional indicator (flags are pairs of them)
+ *
+ * \param codepoint         Codepoint of the character
+ *
+ * \return `true` if the character is a regional indicator
+ *
+ */
+static inline bool emojivur_font_chain_regional_indicator(uint32_t codepoint)
+{
+    return codepoint >= 0x1F1E6 && codepoint <= 0x1F1FF;
+}
+
+/*!
+ * \brief Find a cluster of characters and the first font of a fallback chain covering all of it
+ *
+ * A cluster is a character followed by the ones attached to it (and the ones joined to it by a ZWJ),
+ * so that emoji sequences are never split between fonts. Joiners and variation selectors, never drawn
+ * on their own, do not need to be covered.
+ *
+ * \param chain             Chain
+ * \param text              UTF-8 text
+ * \param start             Offset of the cluster
+ * \param end               Offset of the end of the text to itemize
+ * \param fallback          Font to use if no font covers even the first character of the cluster
+ * \param font              Position in the chain of the font of the cluster (output)
+ *
+ * \return Offset of the end of the cluster
+ *
+ */
+static size_t emojivur_font_chain_cluster(const emojivur_font_chain_t *chain, const char *text, size_t start,
+                                          size_t end, unsigned int fallback, unsigned int *font)
+{
+    size_t cluster_end = start;
+    uint32_t base = emojivur_utf8_next(text, end, &cluster_end);
+    bool regional_indicator = emojivur_font_chain_regional_indicator(base);
+    bool after_zwj = base == 0x200D;
+    while (cluster_end < end)
+    {
+        size_t next = cluster_end;
+        uint32_t codepoint = emojivur_utf8_next(text, end, &next);
+        if (!after_zwj && !emojivur_font_chain_attaches(codepoint) &&
+            !(regional_indicator && emojivur_font_chain_regional_indicator(codepoint)))
+        {
+            break;
+        }
+        regional_indicator = false;
+        after_zwj = codepoint == 0x200D;
+        cluster_end = next;
+    }
+
+    for (*font = 0; *font < chain->font_count; ++*font)
+    {
+        bool covered = true;
+        for (size_t offset = start; covered && offset < cluster_end;)
+        {
+            uint32_t codepoint = emojivur_utf8_next(text, cluster_end, &offset);
+            covered = codepoint == 0x200D || (codepoint >= 0xFE00 && codepoint <= 0xFE0F) ||
+                      emojivur_coverage_has(&chain->entries[*font].coverage, codepoint);
+        }
+        if (covered)
+        {
+            return cluster_end;
+        }
+    }
+
+    // Partially covered sequences get at least their first character drawn
+    for (*font = 0; *font < chain->font_count; ++*font)
+    {
+        if (emojivur_coverage_has(&chain->entries[*font].coverage, base))
+        {
+            return cluster_end;
+        }
+    }
+    *font = fallback;
+
+    return cluster_end;
+}
+
+/*!
+ * \brief Find the run of text to shape with one font of a fallback chain
+ *
+ * Each cluster (a character with the marks, variation selectors, emoji modifiers and tags attached
+ * to it, or characters joined by a ZWJ) goes to the first font covering all of it, or else to the
+ * first font covering its first character. Clusters no font covers stay in the current run.
+ *
+ * \param chain             Chain
+ * \param text              UTF-8 text
+ * \param start             Offset of the run
+ * \param end               Offset of the end of the text to itemize
+ * \param font              Position in the chain of the font of the run (output)
+ *
+ * \return Offset of the end of the run
+ *
+ */
+size_t emojivur_font_chain_run(const emojivur_font_chain_t *chain, const char *text, size_t start, size_t end,
+                               unsigned int *font)
+{
+    *font = 0;
+    if (chain->font_count == 1 || start >= end)
+    {
+        return end;
+    }
+
+    size_t offset = emojivur_font_chain_cluster(chain, text, start, end, 0, font);
+    while (offset < end)
+    {
+        unsigned int cluster_font;
+        size_t cluster_end = emojivur_font_chain_cluster(chain, text, offset, end, *font, &cluster_font);
+        if (cluster_font != *font)
+        {
+            return offset;
+        }
+        offset = cluster_end;
+    }
+
+    return end;
+}
+
+/*!
+ * \brief Get the HarfBuzz font of a font of a fallback chain, loading the font first if needed
+ *
+ * \param chain             Chain
+ * \param font              Position of the font in the chain
+ *
+ * \return HarfBuzz font scaled like the first font of the chain
+ *
+ */
+hb_font_t *emojivur_font_chain_harfbuzz_font(emojivur_font_chain_t *chain, unsigned int font)
+{
+    emojivur_font_chain_entry_t *entry = &chain->entries[font];
+    if (!entry->fonts.harfbuzz_font)
+    {
+        emojivur_load_font(&entry->fonts, entry->font_filename, entry->face_index);
+        chain->cairo_font_faces[font] = entry->fonts.cairo_font_face;
+
+        if (unlikely(emojivur_verbose))
+        {
+            printf("fallback font loaded=%s (face %u)\n", entry->font_filename, entry->face_index);
+        }
+    }
+
+    // Fonts of a chain are all used at the size of the first one
+    int x_scale;
+    int y_scale;
+    hb_font_get_scale(chain->harfbuzz_font, &x_scale, &y_scale);
+    hb_font_set_scale(entry->fonts.harfbuzz_font, x_scale, y_scale);
+
+    return entry->fonts.harfbuzz_font;
+}
+
+/*!
+ * \brief Get the Cairo font faces of the fonts of a fallback chain
+ *
+ * \param chain             Chain
+ *
+ * \return Vector of font faces in chain order (NULL for fonts not loaded yet)
+ *
+ */
+cairo_font_face_t *const *emojivur_font_chain_cairo_font_faces(const emojivur_font_chain_t *chain)
+{
+    return chain->cairo_font_faces;
+}
@@ -0,0 +1,692 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       glyph_cache.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      LRU cache of rasterized glyphs
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "glyph_cache.h"
+#include "glyph_file.h"
+
+// Number of hash buckets the cache starts with (always a power of 2)
+#define GLYPH_CACHE_MIN_BUCKETS 256
+
+/*!
+ * \brief A glyph rasterized at a given size
+ *
+ * Entries are chained in their hash bucket and in the LRU list at the same time.
+ *
+ */
+typedef struct emojivur_glyph_entry
+{
+    cairo_font_face_t *font_face;       /**< Font face the glyph belongs to (referenced) */
+    unsigned long index;                /**< Index of the glyph in the font */
+    int32_t size;                       /**< Size of the glyph in 1/64 of device pixel */
+    cairo_surface_t *bitmap;            /**< Premultiplied ARGB32 bitmap (NULL for blank glyphs) */
+    int x_bearing;                      /**< Device pixels from the glyph origin to the left edge of the bitmap */
+    int y_bearing;                      /**< Device pixels from the glyph origin to the top edge of the bitmap */
+    size_t bytes;                       /**< Memory accounted for the entry */
+    struct emojivur_glyph_entry *next_in_bucket;
+    struct emojivur_glyph_entry *newer; /**< Entry used right after this one */
+    struct emojivur_glyph_entry *older; /**< Entry used right before this one */
+} emojivur_glyph_entry_t;
+
+/*!
+ * \brief Glyph file persisting the glyphs of a given size
+ *
+ */
+typedef struct
+{
+    int32_t size;                       /**< Size of the glyphs in 1/64 of device pixel */
+    emojivur_glyph_file_t *file;        /**< Glyph file (NULL if it could not be opened) */
+} emojivur_glyph_cache_file_t;
+
+struct emojivur_glyph_cache
+{
+    pthread_mutex_t lock;               /**< Lock protecting the fields below */
+    int references;                     /**< Reference count */
+    emojivur_glyph_entry_t **buckets;   /**< Hash table of the entries */
+    size_t bucket_count;                /**< Number of hash buckets */
+    size_t entry_count;                 /**< Number of entries cached */
+    emojivur_glyph_entry_t *newest;     /**< Most recently used entry */
+    emojivur_glyph_entry_t *oldest;     /**< Least recently used entry (the first evicted) */
+    size_t bytes;                       /**< Memory used by the entries */
+    size_t max_bytes;                   /**< Memory the entries can use at most */
+
+    // Persistence across runs
+    char *directory;                    /**< Directory of the glyph files (NULL if not persisting) */
+    const cairo_font_face_t *persistent_font_face; /**< Font face whose glyphs are persisted */
+    emojivur_font_id_t font_id;         /**< Identity of the font of the persisted font face */
+    emojivur_glyph_cache_file_t *files; /**< Glyph files opened (one for each size) */
+    size_t file_count;                  /**< Number of glyph files opened */
+};
+
+/*!
+ * \brief Hash the key of an entry
+ *
+ * \param font_face         Font face the glyph belongs to
+ * \param index             Index of the glyph in the font
+ * \param size              Size of the glyph in 1/64 of device pixel
+ *
+ * \return Hash of the key
+ *
+ */
+static inline size_t emojivur_glyph_hash(const cairo_font_face_t *font_face, unsigned long index, int32_t size)
+{
+    uint64_t hash = (uintptr_t)font_face;
+    hash = (hash ^ index) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ (uint32_t)size) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 32);
+}
+
+/*!
+ * \brief Move an entry to the most recently used end of the LRU list
+ *
+ * \param cache             Cache the entry belongs to (locked)
+ * \param entry             Entry just used (or just created)
+ *
+ */
+static void emojivur_glyph_cache_touch(emojivur_glyph_cache_t *cache, emojivur_glyph_entry_t *entry)
+{
+    if (cache->newest == entry)
+    {
+        return;
+    }
+
+    // Unlink (if linked at all)
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    if (cache->oldest == entry)
+    {
+        cache->oldest = entry->newer;
+    }
+
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if (cache->newest)
+    {
+        cache->newest->newer = entry;
+    }
+    cache->newest = entry;
+    if (!cache->oldest)
+    {
+        cache->oldest = entry;
+    }
+}
+
+/*!
+ * \brief Release an entry and the resources it references
+ *
+ * \param entry             Entry already removed from the cache
+ *
+ */
+static void emojivur_glyph_entry_free(emojivur_glyph_entry_t *entry)
+{
+    if (entry->bitmap)
+    {
+        cairo_surface_destroy(entry->bitmap);
+    }
+    cairo_font_face_destroy(entry->font_face);
+    free(entry);
+}
+
+/*!
+ * \brief Evict the least recently used entries until the cache fits its memory cap
+ *
+ * \param cache             Cache to trim (locked)
+ *
+ */
+static void emojivur_glyph_cache_trim(emojivur_glyph_cache_t *cache)
+{
+    while (cache->bytes > cache->max_bytes && cache->oldest)
+    {
+        emojivur_glyph_entry_t *entry = cache->oldest;
+
+        cache->oldest = entry->newer;
+        if (cache->oldest)
+        {
+            cache->oldest->older = NULL;
+        }
+        else
+        {
+            cache->newest = NULL;
+        }
+
+        emojivur_glyph_entry_t **link = &cache->buckets[emojivur_glyph_hash(entry->font_face, entry->index,
+                                                                            entry->size) &
+                                                        (cache->bucket_count - 1)];
+        while (*link != entry)
+        {
+            link = &(*link)->next_in_bucket;
+        }
+        *link = entry->next_in_bucket;
+
+        cache->bytes -= entry->bytes;
+        --cache->entry_count;
+        emojivur_glyph_entry_free(entry);
+    }
+}
+
+/*!
+ * \brief Double the number of hash buckets moving the entries to the new ones
+ *
+ * \param cache             Cache to grow (locked)
+ *
+ */
+static void emojivur_glyph_cache_grow(emojivur_glyph_cache_t *cache)
+{
+    size_t bucket_count = cache->bucket_count * 2;
+    emojivur_glyph_entry_t **buckets = (emojivur_glyph_entry_t **)calloc(bucket_count,
+                                                                         sizeof(emojivur_glyph_entry_t *));
+    if (unlikely(!buckets))
+    {
+        // Longer chains are slower but still correct
+        return;
+    }
+
+    for (size_t i = 0; i < cache->bucket_count; ++i)
+    {
+        emojivur_glyph_entry_t *entry = cache->buckets[i];
+        while (entry)
+        {
+            emojivur_glyph_entry_t *next = entry->next_in_bucket;
+            size_t bucket = emojivur_glyph_hash(entry->font_face, entry->index, entry->size) & (bucket_count - 1);
+            entry->next_in_bucket = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = bucket_count;
+}
+
+/*!
+ * \brief Create an empty cache of rasterized glyphs
+ *
+ * The cache can be shared by many threads and it is reference counted.
+ *
+ * \param max_bytes         Memory the cached bitmaps can use at most
+ *
+ * \return The new cache (with a reference count of 1), NULL on failure
+ *
+ */
+emojivur_glyph_cache_t *emojivur_glyph_cache_create(size_t max_bytes)
+{
+    emojivur_glyph_cache_t *cache = (emojivur_glyph_cache_t *)calloc(1, sizeof(emojivur_glyph_cache_t));
+    if (unlikely(!cache))
+    {
+        return NULL;
+    }
+
+    cache->bucket_count = GLYPH_CACHE_MIN_BUCKETS;
+    cache->buckets = (emojivur_glyph_entry_t **)calloc(cache->bucket_count, sizeof(emojivur_glyph_entry_t *));
+    if (unlikely(!cache->buckets))
+    {
+        free(cache);
+        return NULL;
+    }
+
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->references = 1;
+    cache->max_bytes = max_bytes;
+
+    return cache;
+}
+
+/*!
+ * \brief Get a new reference to a cache
+ *
+ * \param cache             Cache to reference (can be NULL)
+ *
+ * \return `cache`
+ *
+ */
+emojivur_glyph_cache_t *emojivur_glyph_cache_reference(emojivur_glyph_cache_t *cache)
+{
+    if (cache)
+    {
+        __atomic_add_fetch(&cache->references, 1, __ATOMIC_RELAXED);
+    }
+
+    return cache;
+}
+
+/*!
+ * \brief Persist the glyphs of a font face in glyph files, shared by all the runs rendering the same font
+ *
+ * Glyphs are loaded from the glyph files on first use and the ones missing there are
+ * added to the files when the cache gets destroyed. Only one font face can be persisted
+ * (bitmaps loaded may point into the files, which stay open until the cache is destroyed).
+ *
+ * \param cache             Cache to persist the glyphs of
+ * \param font_face         Font face whose glyphs are persisted
+ * \param font_id           Identity of the font of `font_face`
+ * \param directory         Directory of the glyph files (created if missing)
+ *
+ * \return `false` on failure
+ *
+ */
+bool emojivur_glyph_cache_persist(emojivur_glyph_cache_t *cache, const cairo_font_face_t *font_face,
+                                  const emojivur_font_id_t *font_id, const char *directory)
+{
+    pthread_mutex_lock(&cache->lock);
+    bool persisting = false;
+    if (!cache->directory)
+    {
+        cache->directory = strdup(directory);
+        cache->persistent_font_face = font_face;
+        cache->font_id = *font_id;
+        persisting = cache->directory != NULL;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return persisting;
+}
+
+/*!
+ * \brief Release a reference to a cache, destroying it together with its bitmaps when it is the last one
+ *
+ * \param cache             Cache to release (can be NULL)
+ *
+ */
+void emojivur_glyph_cache_destroy(emojivur_glyph_cache_t *cache)
+{
+    if (!cache || __atomic_sub_fetch(&cache->references, 1, __ATOMIC_ACQ_REL) > 0)
+    {
+        return;
+    }
+
+    // Every entry accounts for some memory: no memory left means no entry left
+    cache->max_bytes = 0;
+    emojivur_glyph_cache_trim(cache);
+
+    // Bitmaps of the entries may point into the glyph files: close them last
+    for (size_t i = 0; i < cache->file_count; ++i)
+    {
+        emojivur_glyph_file_close(cache->files[i].file);
+    }
+    free(cache->files);
+    free(cache->directory);
+
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    free(cache);
+}
+
+/*!
+ * \brief Rasterize a glyph in black on its own bitmap
+ *
+ * \param cairo_context     Cairo context providing the font face & options
+ * \param index             Index of the glyph in the font
+ * \param size              Size of the glyph in device pixels
+ * \param entry             Entry to store the bitmap and its bearings into (output)
+ *
+ * \return `false` if the bitmap could not be created
+ *
+ */
+static bool emojivur_glyph_rasterize(cairo_t *cairo_context, unsigned long index, double size,
+                                     emojivur_glyph_entry_t *entry)
+{
+    cairo_glyph_t glyph = {index, 0, 0};
+
+    cairo_matrix_t font_matrix;
+    cairo_matrix_t identity;
+    cairo_matrix_init_scale(&font_matrix, size, size);
+    cairo_matrix_init_identity(&identity);
+    cairo_font_options_t *font_options = cairo_font_options_create();
+    cairo_get_font_options(cairo_context, font_options);
+    cairo_scaled_font_t *scaled_font = cairo_scaled_font_create(cairo_get_font_face(cairo_context),
+                                                                &font_matrix, &identity, font_options);
+    cairo_font_options_destroy(font_options);
+
+    cairo_text_extents_t extents;
+    cairo_scaled_font_glyph_extents(scaled_font, &glyph, 1, &extents);
+
+    // Round outwards to whole pixels so that antialiased edges are included
+    int x0 = floor(extents.x_bearing) - 1;
+    int y0 = floor(extents.y_bearing) - 1;
+    int x1 = ceil(extents.x_bearing + extents.width) + 1;
+    int y1 = ceil(extents.y_bearing + extents.height) + 1;
+
+    entry->x_bearing = x0;
+    entry->y_bearing = y0;
+    entry->bitmap = NULL;
+    entry->bytes = sizeof(emojivur_glyph_entry_t);
+
+    bool rasterized = true;
+    if (extents.width > 0 && extents.height > 0)
+    {
+        cairo_surface_t *bitmap = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, x1 - x0, y1 - y0);
+        cairo_t *bitmap_context = cairo_create(bitmap);
+        cairo_set_source_rgba(bitmap_context, 0, 0, 0, 1.0);
+        cairo_set_scaled_font(bitmap_context, scaled_font);
+        glyph.x = -x0;
+        glyph.y = -y0;
+        cairo_show_glyphs(bitmap_context, &glyph, 1);
+        cairo_destroy(bitmap_context);
+        cairo_surface_flush(bitmap);
+
+        if (likely(cairo_surface_status(bitmap) == CAIRO_STATUS_SUCCESS))
+        {
+            entry->bitmap = bitmap;
+            entry->bytes += cairo_image_surface_get_stride(bitmap) * cairo_image_surface_get_height(bitmap);
+        }
+        else
+        {
+            cairo_surface_destroy(bitmap);
+            rasterized = false;
+        }
+    }
+
+    cairo_scaled_font_destroy(scaled_font);
+
+    return rasterized;
+}
+
+/*!
+ * \brief Find the cached entry of a glyph
+ *
+ * \param cache             Cache to search (locked)
+ * \param font_face         Font face the glyph belongs to
+ * \param index             Index of the glyph in the font
+ * \param size              Size of the glyph in 1/64 of device pixel
+ * \param hash              Hash of the key
+ *
+ * \return Entry of the glyph, NULL if missing
+ *
+ */
+static emojivur_glyph_entry_t *emojivur_glyph_cache_find(emojivur_glyph_cache_t *cache,
+                                                         const cairo_font_face_t *font_face,
+                                                         unsigned long index, int32_t size, size_t hash)
+{
+    emojivur_glyph_entry_t *entry = cache->buckets[hash & (cache->bucket_count - 1)];
+    while (entry && (entry->font_face != font_face || entry->index != index || entry->size != size))
+    {
+        entry = entry->next_in_bucket;
+    }
+
+    return entry;
+}
+
+/*!
+ * \brief Add a new entry to the cache (unless an entry for the same glyph got there first)
+ *
+ * \param cache             Cache to add the entry to (locked)
+ * \param entry             Entry to add (owned by the cache from now on)
+ * \param hash              Hash of the key of the entry
+ *
+ */
+static void emojivur_glyph_cache_insert(emojivur_glyph_cache_t *cache, emojivur_glyph_entry_t *entry, size_t hash)
+{
+    if (emojivur_glyph_cache_find(cache, entry->font_face, entry->index, entry->size, hash) ||
+        entry->bytes > cache->max_bytes)
+    {
+        emojivur_glyph_entry_free(entry);
+        return;
+    }
+
+    if (cache->entry_count >= cache->bucket_count)
+    {
+        emojivur_glyph_cache_grow(cache);
+    }
+    size_t bucket = hash & (cache->bucket_count - 1);
+    entry->next_in_bucket = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    ++cache->entry_count;
+    cache->bytes += entry->bytes;
+    emojivur_glyph_cache_touch(cache, entry);
+    emojivur_glyph_cache_trim(cache);
+}
+
+/*!
+ * \brief Get the glyph file persisting the glyphs of a font face at a given size, opening it if needed
+ *
+ * \param cache             Cache the glyph file belongs to (locked)
+ * \param font_face         Font face the glyphs belong to
+ * \param size              Size of the glyphs in 1/64 of device pixel
+ *
+ * \return Glyph file, NULL if glyphs of the font face are not persisted
+ *
+ */
+static emojivur_glyph_file_t *emojivur_glyph_cache_file(emojivur_glyph_cache_t *cache,
+                                                        const cairo_font_face_t *font_face, int32_t size)
+{
+    if (!cache->directory || font_face != cache->persistent_font_face)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < cache->file_count; ++i)
+    {
+        if (cache->files[i].size == size)
+        {
+            return cache->files[i].file;
+        }
+    }
+
+    emojivur_glyph_cache_file_t *files = (emojivur_glyph_cache_file_t *)realloc(
+        cache->files, (cache->file_count + 1) * sizeof(emojivur_glyph_cache_file_t));
+    if (unlikely(!files))
+    {
+        return NULL;
+    }
+    cache->files = files;
+
+    // Files failing to open are remembered as well, not to try again on every glyph
+    cache->files[cache->file_count].size = size;
+    cache->files[cache->file_count].file = emojivur_glyph_file_open(cache->directory, &cache->font_id, size);
+
+    return cache->files[cache->file_count++].file;
+}
+
+/*!
+ * \brief Find the entry of a glyph, loading it from its glyph file or rasterizing it if missing
+ *
+ * \param cache             Cache to look the glyph up in
+ * \param cairo_context     Cairo context providing the font face & options
+ * \param index             Index of the glyph in the font
+ * \param size              Size of the glyph in device pixels
+ * \param bitmap            Bitmap of the glyph (output, to be released with `cairo_surface_destroy()`)
+ * \param x_bearing         Device pixels from the glyph origin to the left edge of the bitmap (output)
+ * \param y_bearing         Device pixels from the glyph origin to the top edge of the bitmap (output)
+ *
+ * \return `false` if the glyph could not be rasterized
+ *
+ */
+static bool emojivur_glyph_cache_lookup(emojivur_glyph_cache_t *cache, cairo_t *cairo_context,
+                                        unsigned long index, double size,
+                                        cairo_surface_t **bitmap, int *x_bearing, int *y_bearing)
+{
+    cairo_font_face_t *font_face = cairo_get_font_face(cairo_context);
+    int32_t size_key = lround(size * 64);
+    size_t hash = emojivur_glyph_hash(font_face, index, size_key);
+
+    pthread_mutex_lock(&cache->lock);
+    emojivur_glyph_entry_t *entry = emojivur_glyph_cache_find(cache, font_face, index, size_key, hash);
+    if (entry)
+    {
+        emojivur_glyph_cache_touch(cache, entry);
+        *bitmap = entry->bitmap ? cairo_surface_reference(entry->bitmap) : NULL;
+        *x_bearing = entry->x_bearing;
+        *y_bearing = entry->y_bearing;
+        pthread_mutex_unlock(&cache->lock);
+        return true;
+    }
+
+    emojivur_glyph_file_t *file = emojivur_glyph_cache_file(cache, font_face, size_key);
+    if (file && emojivur_glyph_file_lookup(file, index, bitmap, x_bearing, y_bearing))
+    {
+        entry = (emojivur_glyph_entry_t *)calloc(1, sizeof(emojivur_glyph_entry_t));
+        if (likely(entry))
+        {
+            entry->font_face = cairo_font_face_reference(font_face);
+            entry->index = index;
+            entry->size = size_key;
+            entry->bitmap = *bitmap ? cairo_surface_reference(*bitmap) : NULL;
+            entry->x_bearing = *x_bearing;
+            entry->y_bearing = *y_bearing;
+
+            // Pixels stay in the mapped file (the page cache): only the entry itself uses memory
+            entry->bytes = sizeof(emojivur_glyph_entry_t);
+            emojivur_glyph_cache_insert(cache, entry, hash);
+        }
+        pthread_mutex_unlock(&cache->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    // Rasterize without holding the lock (another thread may be doing the same, the first one wins)
+    entry = (emojivur_glyph_entry_t *)calloc(1, sizeof(emojivur_glyph_entry_t));
+    if (unlikely(!entry || !emojivur_glyph_rasterize(cairo_context, index, size, entry)))
+    {
+        free(entry);
+        return false;
+    }
+    entry->font_face = cairo_font_face_reference(font_face);
+    entry->index = index;
+    entry->size = size_key;
+
+    *bitmap = entry->bitmap ? cairo_surface_reference(entry->bitmap) : NULL;
+    *x_bearing = entry->x_bearing;
+    *y_bearing = entry->y_bearing;
+
+    pthread_mutex_lock(&cache->lock);
+    if (file)
+    {
+        emojivur_glyph_file_add(file, index, entry->bitmap, entry->x_bearing, entry->y_bearing);
+    }
+    emojivur_glyph_cache_insert(cache, entry, hash);
+    pthread_mutex_unlock(&cache->lock);
+
+    return true;
+}
+
+/*!
+ * \brief Draw glyphs like `cairo_show_glyphs()` compositing their cached bitmaps
+ *
+ * Bitmaps are keyed by font face, glyph index and size in device pixels: missing ones
+ * get rasterized (or loaded from their glyph file) and cached on first use. Glyph origins
+ * are snapped to whole device pixels, like Cairo does for bitmap glyphs, so that
+ * bitmaps are composited without any resampling. Whenever the context cannot be
+ * served from the cache (e.g. a rotated or scaled transformation, a non-image target,
+ * a source other than opaque black or no cache at all) `cairo_show_glyphs()` is used instead.
+ *
+ * \param cache             Cache to use (can be NULL)
+ * \param cairo_context     Cairo context to draw onto (with font face & size already set)
+ * \param glyphs            Vector of Cairo glyphs to draw
+ * \param glyph_count       Number of Cairo glyphs to draw
+ *
+ */
+void emojivur_glyph_cache_show_glyphs(emojivur_glyph_cache_t *cache, cairo_t *cairo_context,
+                                      const cairo_glyph_t *glyphs, int glyph_count)
+{
+    cairo_surface_t *target = cairo_get_target(cairo_context);
+
+    cairo_matrix_t ctm;
+    cairo_get_matrix(cairo_context, &ctm);
+
+    cairo_matrix_t font_matrix;
+    cairo_get_font_matrix(cairo_context, &font_matrix);
+
+    double x_scale = 1.0;
+    double y_scale = 1.0;
+    cairo_surface_get_device_scale(target, &x_scale, &y_scale);
+
+    // Glyphs are cached as rendered in opaque black (the color used by all outputs)
+    double red = 1.0;
+    double green = 1.0;
+    double blue = 1.0;
+    double alpha = 0.0;
+    cairo_pattern_get_rgba(cairo_get_source(cairo_context), &red, &green, &blue, &alpha);
+
+    if (!cache || cairo_surface_get_type(target) != CAIRO_SURFACE_TYPE_IMAGE ||
+        red != 0.0 || green != 0.0 || blue != 0.0 || alpha != 1.0 ||
+        ctm.xx != 1.0 || ctm.yy != 1.0 || ctm.xy != 0.0 || ctm.yx != 0.0 ||
+        font_matrix.xy != 0.0 || font_matrix.yx != 0.0 || font_matrix.xx != font_matrix.yy ||
+        x_scale != y_scale)
+    {
+        cairo_show_glyphs(cairo_context, glyphs, glyph_count);
+        return;
+    }
+
+    double x_offset = 0.0;
+    double y_offset = 0.0;
+    cairo_surface_get_device_offset(target, &x_offset, &y_offset);
+
+    cairo_save(cairo_context);
+    cairo_identity_matrix(cairo_context);
+    for (int i = 0; i < glyph_count; ++i)
+    {
+        cairo_surface_t *bitmap = NULL;
+        int x_bearing;
+        int y_bearing;
+        if (unlikely(!emojivur_glyph_cache_lookup(cache, cairo_context, glyphs[i].index,
+                                                  font_matrix.xx * x_scale, &bitmap, &x_bearing, &y_bearing)))
+        {
+            cairo_translate(cairo_context, ctm.x0, ctm.y0);
+            cairo_show_glyphs(cairo_context, &glyphs[i], 1);
+            cairo_identity_matrix(cairo_context);
+            continue;
+        }
+        if (!bitmap)
+        {
+            continue;
+        }
+
+        // Snap the glyph origin to the device pixel grid
+        double x = (lround((glyphs[i].x + ctm.x0) * x_scale + x_offset) + x_bearing - x_offset) / x_scale;
+        double y = (lround((glyphs[i].y + ctm.y0) * y_scale + y_offset) + y_bearing - y_offset) / y_scale;
+
+        // Bitmaps are in device pixels: scaling them like the target paints them 1:1
+        cairo_pattern_t *pattern = cairo_pattern_create_for_surface(bitmap);
+        cairo_matrix_t pattern_matrix;
+        cairo_matrix_init_scale(&pattern_matrix, x_scale, y_scale);
+        cairo_matrix_translate(&pattern_matrix, -x, -y);
+        cairo_pattern_set_matrix(pattern, &pattern_matrix);
+        cairo_set_source(cairo_context, pattern);
+        cairo_pattern_destroy(pattern);
+        cairo_rectangle(cairo_context, x, y,
+                        cairo_image_surface_get_width(bitmap) / x_scale,
+                        cairo_image_surface_get_height(bitmap) / y_scale);
+        cairo_fill(cairo_context);
+        cairo_surface_destroy(bitmap);
+    }
+    cairo_restore(cairo_context);
+}
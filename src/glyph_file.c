@@ -0,0 +1,614 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       glyph_file.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Glyph bitmaps persisted in memory mapped files across runs
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <harfbuzz/hb.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "glyph_file.h"
+#include "stream.h"
+
+#define GLYPH_FILE_MAGIC "EMJVGLYF"
+#define GLYPH_FILE_VERSION 1
+#define GLYPH_FILE_BYTE_ORDER 0x01020304
+#define GLYPH_RECORD_MAGIC 0x46594C47
+#define GLYPH_RECORD_ALIGNMENT 16
+#define GLYPH_FILE_MIN_SLOTS 64
+
+/*!
+ * \brief Header at the beginning of a glyph file
+ *
+ * Files are meant to be read on the machine writing them: numbers are stored in native byte order.
+ *
+ */
+typedef struct
+{
+    char magic[8];                /**< `GLYPH_FILE_MAGIC` */
+    uint32_t version;             /**< `GLYPH_FILE_VERSION` */
+    uint32_t byte_order;          /**< `GLYPH_FILE_BYTE_ORDER` as written by the machine creating the file */
+    emojivur_font_id_t font_id;   /**< Font the glyphs belong to */
+    int32_t size;                 /**< Size of the glyphs in 1/64 of device pixel */
+    uint32_t reserved[5];
+} emojivur_glyph_file_header_t;
+
+/*!
+ * \brief Header of every glyph record, followed by the premultiplied ARGB32 pixels of the bitmap
+ *
+ * Records follow each other after the file header and they are aligned to `GLYPH_RECORD_ALIGNMENT`.
+ *
+ */
+typedef struct
+{
+    uint32_t magic;               /**< `GLYPH_RECORD_MAGIC` */
+    uint32_t index;               /**< Index of the glyph in the font */
+    uint32_t width;               /**< Width of the bitmap in pixels (0 for blank glyphs) */
+    uint32_t height;              /**< Height of the bitmap in pixels */
+    uint32_t stride;              /**< Number of bytes between the beginning of two consecutive rows */
+    int32_t x_bearing;            /**< Device pixels from the glyph origin to the left edge of the bitmap */
+    int32_t y_bearing;            /**< Device pixels from the glyph origin to the top edge of the bitmap */
+    uint32_t length;              /**< Length of the whole record in bytes */
+} emojivur_glyph_record_t;
+
+/*!
+ * \brief Glyph known by a glyph file, either already stored in the file or waiting to be written
+ *
+ */
+typedef struct
+{
+    bool used;                              /**< Whether the slot holds a glyph */
+    uint32_t index;                         /**< Index of the glyph in the font */
+    const emojivur_glyph_record_t *record;  /**< Record in the mapped file (NULL if not written yet) */
+    cairo_surface_t *bitmap;                /**< Bitmap waiting to be written (NULL for blank glyphs) */
+    int x_bearing;                          /**< Bearings of the bitmap waiting to be written */
+    int y_bearing;
+} emojivur_glyph_slot_t;
+
+struct emojivur_glyph_file
+{
+    char *filename;                         /**< Path of the glyph file */
+    emojivur_glyph_file_header_t header;    /**< Header the file must have */
+    unsigned char *mapping;                 /**< Contents of the file mapped in memory (NULL if none) */
+    size_t mapping_length;                  /**< Length of the mapping */
+    size_t valid_length;                    /**< Length of the file up to the end of the last valid record */
+    emojivur_glyph_slot_t *slots;           /**< Hash table of the glyphs known */
+    size_t slot_count;                      /**< Number of slots (always a power of 2) */
+    size_t used_count;                      /**< Number of slots used */
+    size_t pending_count;                   /**< Number of glyphs waiting to be written */
+};
+
+/*!
+ * \brief Identify the contents of a font file
+ *
+ * \param font_filename     File name of the font
+ * \param harfbuzz_face     HarfBuzz face loaded from the font file
+ * \param face              Index of the face in the font file
+ * \param font_id           Identity of the font (output)
+ *
+ * \return `false` if the font file cannot be identified
+ *
+ */
+bool emojivur_font_id(const char *font_filename, hb_face_t *harfbuzz_face, unsigned int face,
+                      emojivur_font_id_t *font_id)
+{
+    struct stat st;
+    if (unlikely(stat(font_filename, &st) != 0 || !S_ISREG(st.st_mode)))
+    {
+        return false;
+    }
+
+    memset(font_id, 0, sizeof(emojivur_font_id_t));
+    font_id->size = st.st_size;
+#ifdef __APPLE__
+    font_id->mtime_ns = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    font_id->mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    font_id->face = face;
+
+    // The font carries a checksum of its whole contents: there is no need to read it all
+    hb_blob_t *head = hb_face_reference_table(harfbuzz_face, HB_TAG('h', 'e', 'a', 'd'));
+    unsigned int head_length = 0;
+    const unsigned char *head_data = (const unsigned char *)hb_blob_get_data(head, &head_length);
+    if (head_data && head_length >= 12)
+    {
+        font_id->checksum = ((uint32_t)head_data[8] << 24) | ((uint32_t)head_data[9] << 16) |
+                            ((uint32_t)head_data[10] << 8) | (uint32_t)head_data[11];
+    }
+    hb_blob_destroy(head);
+
+    return true;
+}
+
+/*!
+ * \brief Find the slot of a glyph (or the free slot where it would go)
+ *
+ * \param file              Glyph file to search
+ * \param index             Index of the glyph in the font
+ *
+ * \return Slot of the glyph
+ *
+ */
+static emojivur_glyph_slot_t *emojivur_glyph_file_slot(emojivur_glyph_file_t *file, uint32_t index)
+{
+    size_t mask = file->slot_count - 1;
+    size_t slot = (index * 0x9E3779B1u) & mask;
+    while (file->slots[slot].used && file->slots[slot].index != index)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return &file->slots[slot];
+}
+
+/*!
+ * \brief Make room for one more glyph in the hash table, keeping it at most half full
+ *
+ * \param file              Glyph file to grow the hash table of
+ *
+ * \return `false` if out of memory
+ *
+ */
+static bool emojivur_glyph_file_reserve(emojivur_glyph_file_t *file)
+{
+    if ((file->used_count + 1) * 2 <= file->slot_count)
+    {
+        return true;
+    }
+
+    emojivur_glyph_slot_t *old_slots = file->slots;
+    size_t old_count = file->slot_count;
+    size_t slot_count = old_count ? old_count * 2 : GLYPH_FILE_MIN_SLOTS;
+    emojivur_glyph_slot_t *slots = (emojivur_glyph_slot_t *)calloc(slot_count, sizeof(emojivur_glyph_slot_t));
+    if (unlikely(!slots))
+    {
+        return false;
+    }
+
+    file->slots = slots;
+    file->slot_count = slot_count;
+    for (size_t i = 0; i < old_count; ++i)
+    {
+        if (old_slots[i].used)
+        {
+            *emojivur_glyph_file_slot(file, old_slots[i].index) = old_slots[i];
+        }
+    }
+    free(old_slots);
+
+    return true;
+}
+
+/*!
+ * \brief Check whether a record is complete and consistent
+ *
+ * \param record            Record to check
+ * \param available         Number of bytes available from the beginning of the record
+ *
+ * \return `true` if the record is valid
+ *
+ */
+static bool emojivur_glyph_record_valid(const emojivur_glyph_record_t *record, size_t available)
+{
+    return available >= sizeof(emojivur_glyph_record_t) &&
+           record->magic == GLYPH_RECORD_MAGIC &&
+           record->length % GLYPH_RECORD_ALIGNMENT == 0 &&
+           record->length <= available &&
+           record->stride % 4 == 0 &&
+           (uint64_t)record->width * 4 <= record->stride &&
+           sizeof(emojivur_glyph_record_t) + (uint64_t)record->stride * record->height <= record->length;
+}
+
+/*!
+ * \brief Map a glyph file in memory and index the records it holds
+ *
+ * \param file              Glyph file to load
+ *
+ */
+static void emojivur_glyph_file_load(emojivur_glyph_file_t *file)
+{
+    int fd = open(file->filename, O_RDONLY);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    // Writers only ever append whole records or replace the file: a shared lock is enough
+    flock(fd, LOCK_SH);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(emojivur_glyph_file_header_t))
+    {
+        file->mapping = (unsigned char *)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (file->mapping == MAP_FAILED)
+        {
+            file->mapping = NULL;
+        }
+        else
+        {
+            file->mapping_length = st.st_size;
+        }
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+
+    if (!file->mapping || memcmp(file->mapping, &file->header, sizeof(emojivur_glyph_file_header_t)) != 0)
+    {
+        // A different font (or format) left the file: it is replaced on close
+        return;
+    }
+
+    size_t offset = sizeof(emojivur_glyph_file_header_t);
+    while (offset < file->mapping_length)
+    {
+        const emojivur_glyph_record_t *record = (const emojivur_glyph_record_t *)(file->mapping + offset);
+        if (!emojivur_glyph_record_valid(record, file->mapping_length - offset) ||
+            !emojivur_glyph_file_reserve(file))
+        {
+            break;
+        }
+
+        emojivur_glyph_slot_t *slot = emojivur_glyph_file_slot(file, record->index);
+        if (!slot->used)
+        {
+            slot->used = true;
+            slot->index = record->index;
+            slot->record = record;
+            ++file->used_count;
+        }
+        offset += record->length;
+    }
+    file->valid_length = offset;
+}
+
+/*!
+ * \brief Create a directory and its missing parents
+ *
+ * \param directory         Path of the directory
+ *
+ * \return `true` if the directory exists at the end
+ *
+ */
+static bool emojivur_make_directory(const char *directory)
+{
+    char path[FILENAME_MAX];
+    if (unlikely(snprintf(path, sizeof(path), "%s", directory) >= (int)sizeof(path)))
+    {
+        return false;
+    }
+
+    for (char *separator = strchr(path + 1, '/'); separator; separator = strchr(separator + 1, '/'))
+    {
+        *separator = '\0';
+        mkdir(path, 0755);
+        *separator = '/';
+    }
+
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+/*!
+ * \brief Open (creating it if needed) the file of the bitmaps of a font at a given size
+ *
+ * The file is named after the font identity and the size and it is mapped in memory:
+ * bitmaps already stored are served straight from the mapping. Files left by a different
+ * version of the font are replaced.
+ *
+ * \param directory         Directory of the glyph files (created if missing)
+ * \param font_id           Identity of the font
+ * \param size              Size of the glyphs in 1/64 of device pixel
+ *
+ * \return The glyph file, NULL if it cannot be used
+ *
+ */
+emojivur_glyph_file_t *emojivur_glyph_file_open(const char *directory, const emojivur_font_id_t *font_id,
+                                                int32_t size)
+{
+    if (unlikely(!emojivur_make_directory(directory)))
+    {
+        return NULL;
+    }
+
+    emojivur_glyph_file_t *file = (emojivur_glyph_file_t *)calloc(1, sizeof(emojivur_glyph_file_t));
+    if (unlikely(!file))
+    {
+        return NULL;
+    }
+
+    size_t filename_length = strlen(directory) + 64;
+    file->filename = (char *)malloc(filename_length);
+    if (unlikely(!file->filename || !emojivur_glyph_file_reserve(file)))
+    {
+        emojivur_glyph_file_close(file);
+        return NULL;
+    }
+    snprintf(file->filename, filename_length, "%s/%08x-%llx-%u-%d.glyphs", directory,
+             font_id->checksum, (unsigned long long)font_id->size, font_id->face, size);
+
+    memcpy(file->header.magic, GLYPH_FILE_MAGIC, sizeof(file->header.magic));
+    file->header.version = GLYPH_FILE_VERSION;
+    file->header.byte_order = GLYPH_FILE_BYTE_ORDER;
+    file->header.font_id = *font_id;
+    file->header.size = size;
+
+    emojivur_glyph_file_load(file);
+
+    return file;
+}
+
+/*!
+ * \brief Find the bitmap of a glyph in a glyph file
+ *
+ * \param file              Glyph file to search
+ * \param index             Index of the glyph in the font
+ * \param bitmap            Bitmap of the glyph (output, NULL for blank glyphs, to be released
+ *                          with `cairo_surface_destroy()` before closing the file)
+ * \param x_bearing         Device pixels from the glyph origin to the left edge of the bitmap (output)
+ * \param y_bearing         Device pixels from the glyph origin to the top edge of the bitmap (output)
+ *
+ * \return `true` if the glyph is in the file
+ *
+ */
+bool emojivur_glyph_file_lookup(emojivur_glyph_file_t *file, unsigned long index,
+                                cairo_surface_t **bitmap, int *x_bearing, int *y_bearing)
+{
+    emojivur_glyph_slot_t *slot = emojivur_glyph_file_slot(file, index);
+    if (!slot->used)
+    {
+        return false;
+    }
+
+    if (!slot->record)
+    {
+        *bitmap = slot->bitmap ? cairo_surface_reference(slot->bitmap) : NULL;
+        *x_bearing = slot->x_bearing;
+        *y_bearing = slot->y_bearing;
+        return true;
+    }
+
+    const emojivur_glyph_record_t *record = slot->record;
+    *bitmap = NULL;
+    *x_bearing = record->x_bearing;
+    *y_bearing = record->y_bearing;
+    if (record->width > 0 && record->height > 0)
+    {
+        // Pixels are used in place: Cairo only reads from surfaces used as source
+        *bitmap = cairo_image_surface_create_for_data((unsigned char *)(record + 1), CAIRO_FORMAT_ARGB32,
+                                                      record->width, record->height, record->stride);
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Add the bitmap of a glyph to a glyph file (it is written when the file gets closed)
+ *
+ * \param file              Glyph file to add the glyph to
+ * \param index             Index of the glyph in the font
+ * \param bitmap            ARGB32 bitmap of the glyph (NULL for blank glyphs)
+ * \param x_bearing         Device pixels from the glyph origin to the left edge of the bitmap
+ * \param y_bearing         Device pixels from the glyph origin to the top edge of the bitmap
+ *
+ */
+void emojivur_glyph_file_add(emojivur_glyph_file_t *file, unsigned long index,
+                             cairo_surface_t *bitmap, int x_bearing, int y_bearing)
+{
+    if (!emojivur_glyph_file_reserve(file))
+    {
+        return;
+    }
+
+    emojivur_glyph_slot_t *slot = emojivur_glyph_file_slot(file, index);
+    if (slot->used)
+    {
+        return;
+    }
+
+    slot->used = true;
+    slot->index = index;
+    slot->bitmap = bitmap ? cairo_surface_reference(bitmap) : NULL;
+    slot->x_bearing = x_bearing;
+    slot->y_bearing = y_bearing;
+    ++file->used_count;
+    ++file->pending_count;
+}
+
+/*!
+ * \brief Write the records of the glyphs waiting to be written
+ *
+ * \param file              Glyph file the glyphs belong to
+ * \param fd                File descriptor to write the records to
+ *
+ * \return `false` on failure
+ *
+ */
+static bool emojivur_glyph_file_write_pending(emojivur_glyph_file_t *file, int fd)
+{
+    static const unsigned char padding[GLYPH_RECORD_ALIGNMENT] = {0};
+
+    for (size_t i = 0; i < file->slot_count; ++i)
+    {
+        emojivur_glyph_slot_t *slot = &file->slots[i];
+        if (!slot->used || slot->record)
+        {
+            continue;
+        }
+
+        emojivur_glyph_record_t record = {
+            .magic = GLYPH_RECORD_MAGIC,
+            .index = slot->index,
+            .x_bearing = slot->x_bearing,
+            .y_bearing = slot->y_bearing,
+        };
+        const unsigned char *pixels = NULL;
+        if (slot->bitmap)
+        {
+            cairo_surface_flush(slot->bitmap);
+            pixels = cairo_image_surface_get_data(slot->bitmap);
+            record.width = cairo_image_surface_get_width(slot->bitmap);
+            record.height = cairo_image_surface_get_height(slot->bitmap);
+            record.stride = cairo_image_surface_get_stride(slot->bitmap);
+        }
+        size_t pixels_length = (size_t)record.stride * record.height;
+        size_t length = sizeof(emojivur_glyph_record_t) + pixels_length;
+        size_t padding_length = (GLYPH_RECORD_ALIGNMENT - length % GLYPH_RECORD_ALIGNMENT) % GLYPH_RECORD_ALIGNMENT;
+        record.length = length + padding_length;
+
+        if (!emojivur_write_all(fd, &record, sizeof(record)) ||
+            (pixels && !emojivur_write_all(fd, pixels, pixels_length)) ||
+            !emojivur_write_all(fd, padding, padding_length))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Check whether the glyph file on disk can be extended by appending records
+ *
+ * It can when it still has the expected header and ends with a whole record
+ * (other processes may have appended their own records meanwhile).
+ *
+ * \param file              Glyph file opened
+ * \param fd                File descriptor of the glyph file on disk (locked)
+ *
+ * \return `true` if records can be appended
+ *
+ */
+static bool emojivur_glyph_file_appendable(emojivur_glyph_file_t *file, int fd)
+{
+    struct stat st;
+    emojivur_glyph_file_header_t header;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < file->valid_length ||
+        pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(&header, &file->header, sizeof(header)) != 0)
+    {
+        return false;
+    }
+
+    size_t offset = MAX(file->valid_length, sizeof(header));
+    while (offset < (size_t)st.st_size)
+    {
+        emojivur_glyph_record_t record;
+        if (pread(fd, &record, sizeof(record), offset) != sizeof(record) ||
+            !emojivur_glyph_record_valid(&record, st.st_size - offset))
+        {
+            return false;
+        }
+        offset += record.length;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Write the glyphs added to a glyph file and close it
+ *
+ * New glyphs are appended to the file when it is still valid, otherwise the file is
+ * replaced atomically (mappings held by other processes keep the previous file).
+ * Failing to write the file is not an error: the glyphs are just rasterized again next time.
+ *
+ * \param file              Glyph file to close (can be NULL)
+ *
+ */
+void emojivur_glyph_file_close(emojivur_glyph_file_t *file)
+{
+    if (!file)
+    {
+        return;
+    }
+
+    if (file->pending_count > 0)
+    {
+        int fd = open(file->filename, O_RDWR | O_CREAT, 0644);
+        if (fd != -1 && flock(fd, LOCK_EX) == 0 && emojivur_glyph_file_appendable(file, fd))
+        {
+            lseek(fd, 0, SEEK_END);
+            emojivur_glyph_file_write_pending(file, fd);
+        }
+        else if (fd != -1)
+        {
+            // Replace the file keeping the valid records already there
+            size_t temporary_length = strlen(file->filename) + 8;
+            char *temporary_filename = (char *)malloc(temporary_length);
+            int temporary_fd = -1;
+            if (temporary_filename)
+            {
+                snprintf(temporary_filename, temporary_length, "%s.XXXXXX", file->filename);
+                temporary_fd = mkstemp(temporary_filename);
+            }
+            if (temporary_fd != -1)
+            {
+                bool valid_mapping = file->valid_length > 0;
+                bool written = emojivur_write_all(temporary_fd, &file->header, sizeof(file->header)) &&
+                               (!valid_mapping ||
+                                emojivur_write_all(temporary_fd, file->mapping + sizeof(file->header),
+                                                   file->valid_length - sizeof(file->header))) &&
+                               emojivur_glyph_file_write_pending(file, temporary_fd);
+                fchmod(temporary_fd, 0644);
+                close(temporary_fd);
+                if (!written || rename(temporary_filename, file->filename) != 0)
+                {
+                    unlink(temporary_filename);
+                }
+            }
+            free(temporary_filename);
+        }
+
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+
+    for (size_t i = 0; i < file->slot_count; ++i)
+    {
+        if (file->slots[i].bitmap)
+        {
+            cairo_surface_destroy(file->slots[i].bitmap);
+        }
+    }
+    if (file->mapping)
+    {
+        munmap(file->mapping, file->mapping_length);
+    }
+    free(file->slots);
+    free(file->filename);
+    free(file);
+}
@@ -0,0 +1,364 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       glyph_index.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Spatial index of laid out glyphs
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "glyph_index.h"
+
+/*!
+ * \brief Glyph falling in a cell of the grid
+ *
+ */
+typedef struct
+{
+    uint64_t cell;         /**< Cell of the grid (row in the high bits, column in the low ones) */
+    unsigned int glyph_id; /**< Position of the glyph in the layout */
+} emojivur_glyph_index_entry_t;
+
+/*!
+ * \brief Glyphs of a layout sorted by the cell of the grid their origin falls in
+ *
+ */
+struct emojivur_glyph_index
+{
+    double cell_size;                       /**< Size of the cells of the grid */
+    double reach;                           /**< How far the ink of a glyph can get from its origin */
+    int32_t min_row;                        /**< First row of the grid with any glyph */
+    int32_t max_row;                        /**< Last row of the grid with any glyph */
+    unsigned int entry_count;               /**< Number of glyphs indexed */
+    emojivur_glyph_index_entry_t entries[]; /**< Glyphs sorted by cell, then by position in the layout */
+};
+
+/*!
+ * \brief Get the key of a cell of the grid, sorting cells by row and then by column
+ *
+ * \param row               Row of the cell
+ * \param column            Column of the cell
+ *
+ * \return Key of the cell
+ *
+ */
+static inline uint64_t emojivur_glyph_index_cell(int32_t row, int32_t column)
+{
+    return ((uint64_t)((uint32_t)row ^ 0x80000000u) << 32) | ((uint32_t)column ^ 0x80000000u);
+}
+
+/*!
+ * \brief Get the row or column of the grid a coordinate falls in (clamped to what the keys can hold)
+ *
+ * \param coordinate        Coordinate
+ * \param cell_size         Size of the cells of the grid
+ *
+ * \return Row or column of the grid
+ *
+ */
+static inline int32_t emojivur_glyph_index_line(double coordinate, double cell_size)
+{
+    double line = floor(coordinate / cell_size);
+    return line < INT32_MIN ? INT32_MIN : line > INT32_MAX ? INT32_MAX : (int32_t)line;
+}
+
+/*!
+ * \brief Get the key of the cell of the grid the origin of a glyph falls in
+ *
+ * \param glyph             Cairo glyph
+ * \param cell_size         Size of the cells of the grid
+ *
+ * \return Key of the cell
+ *
+ */
+static inline uint64_t emojivur_glyph_index_glyph_cell(const cairo_glyph_t *glyph, double cell_size)
+{
+    return emojivur_glyph_index_cell(emojivur_glyph_index_line(glyph->y, cell_size),
+                                     emojivur_glyph_index_line(glyph->x, cell_size));
+}
+
+/*!
+ * \brief Compare two entries by cell, then by position in the layout (for `qsort()`)
+ *
+ * \param a                 First entry
+ * \param b                 Second entry
+ *
+ * \return Negative, zero or positive like `strcmp()`
+ *
+ */
+static int emojivur_glyph_index_entry_compare(const void *a, const void *b)
+{
+    const emojivur_glyph_index_entry_t *entry_a = (const emojivur_glyph_index_entry_t *)a;
+    const emojivur_glyph_index_entry_t *entry_b = (const emojivur_glyph_index_entry_t *)b;
+    if (entry_a->cell != entry_b->cell)
+    {
+        return entry_a->cell < entry_b->cell ? -1 : 1;
+    }
+    return entry_a->glyph_id < entry_b->glyph_id ? -1 : entry_a->glyph_id > entry_b->glyph_id;
+}
+
+/*!
+ * \brief Compare two glyph positions (for `qsort()`)
+ *
+ * \param a                 First position
+ * \param b                 Second position
+ *
+ * \return Negative, zero or positive like `strcmp()`
+ *
+ */
+static int emojivur_glyph_id_compare(const void *a, const void *b)
+{
+    unsigned int id_a = *(const unsigned int *)a;
+    unsigned int id_b = *(const unsigned int *)b;
+    return id_a < id_b ? -1 : id_a > id_b;
+}
+
+/*!
+ * \brief Index the glyphs of a layout on a uniform grid, so that the ones falling in any area are found quickly
+ *
+ * \param glyphs            Vector of Cairo glyphs to index (the index keeps no reference to it)
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param cell_size         Size of the cells of the grid (in the same unit as the glyph positions)
+ * \param reach             How far the ink of a glyph can get from its origin
+ *
+ * \return The new index, NULL on failure
+ *
+ */
+emojivur_glyph_index_t *emojivur_glyph_index_create(const cairo_glyph_t *glyphs, unsigned int glyph_count,
+                                                    double cell_size, double reach)
+{
+    emojivur_glyph_index_t *index = (emojivur_glyph_index_t *)malloc(
+        sizeof(emojivur_glyph_index_t) + glyph_count * sizeof(emojivur_glyph_index_entry_t));
+    if (unlikely(!index))
+    {
+        return NULL;
+    }
+
+    index->cell_size = MAX(cell_size, 1.0);
+    index->reach = reach;
+    index->min_row = INT32_MAX;
+    index->max_row = INT32_MIN;
+    index->entry_count = glyph_count;
+    for (unsigned int i = 0; i < glyph_count; ++i)
+    {
+        int32_t row = emojivur_glyph_index_line(glyphs[i].y, index->cell_size);
+        int32_t column = emojivur_glyph_index_line(glyphs[i].x, index->cell_size);
+        index->entries[i].cell = emojivur_glyph_index_cell(row, column);
+        index->entries[i].glyph_id = i;
+        index->min_row = MIN(index->min_row, row);
+        index->max_row = MAX(index->max_row, row);
+    }
+    qsort(index->entries, glyph_count, sizeof(emojivur_glyph_index_entry_t), emojivur_glyph_index_entry_compare);
+
+    return index;
+}
+
+/*!
+ * \brief Index again the glyphs of a layout after an edit, sorting only the entries of the glyphs which changed
+ *
+ * Entries of the glyphs before the edit are kept as they are. Those of the glyphs after it are renumbered,
+ * and put in the cells they moved to: they stay sorted unless they moved across the rows of the grid
+ * unevenly. Entries of the glyphs edited are sorted on their own, then the three runs are merged.
+ *
+ * \param index             Index of the glyphs before the edit (destroyed on success)
+ * \param glyphs            Vector of Cairo glyphs edited (the index keeps no reference to it)
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param first_glyph       First glyph edited (the ones before it stay where they were)
+ * \param end_glyph         Glyph after the last one edited (the ones from it on are the ones indexed from
+ *                          `end_glyph - glyph_delta` on, wherever they moved)
+ * \param glyph_delta       Change in the number of glyphs
+ *
+ * \return The updated index, NULL on failure (the index passed is left untouched)
+ *
+ */
+emojivur_glyph_index_t *emojivur_glyph_index_update(emojivur_glyph_index_t *index, const cairo_glyph_t *glyphs,
+                                                    unsigned int glyph_count, unsigned int first_glyph,
+                                                    unsigned int end_glyph, int glyph_delta)
+{
+    emojivur_glyph_index_t *updated = (emojivur_glyph_index_t *)malloc(
+        sizeof(emojivur_glyph_index_t) + glyph_count * sizeof(emojivur_glyph_index_entry_t));
+    emojivur_glyph_index_entry_t *runs = (emojivur_glyph_index_entry_t *)malloc(
+        MAX(glyph_count, 1) * sizeof(emojivur_glyph_index_entry_t));
+    if (unlikely(!updated || !runs))
+    {
+        free(updated);
+        free(runs);
+        return NULL;
+    }
+
+    // Glyphs kept, edited and moved, each run sorted on its own
+    emojivur_glyph_index_entry_t *kept = runs;
+    emojivur_glyph_index_entry_t *edited = runs + first_glyph;
+    emojivur_glyph_index_entry_t *moved = runs + end_glyph;
+    unsigned int counts[3] = {0, end_glyph - first_glyph, 0};
+    bool moved_sorted = true;
+    for (unsigned int i = 0; i < index->entry_count; ++i)
+    {
+        emojivur_glyph_index_entry_t entry = index->entries[i];
+        if (entry.glyph_id < first_glyph)
+        {
+            kept[counts[0]++] = entry;
+        }
+        else if ((int)entry.glyph_id >= (int)end_glyph - glyph_delta)
+        {
+            entry.glyph_id += glyph_delta;
+            entry.cell = emojivur_glyph_index_glyph_cell(&glyphs[entry.glyph_id], index->cell_size);
+            moved_sorted = moved_sorted && (counts[2] == 0 ||
+                                            emojivur_glyph_index_entry_compare(&moved[counts[2] - 1], &entry) < 0);
+            moved[counts[2]++] = entry;
+        }
+    }
+    for (unsigned int i = first_glyph; i < end_glyph; ++i)
+    {
+        edited[i - first_glyph] = (emojivur_glyph_index_entry_t){
+            emojivur_glyph_index_glyph_cell(&glyphs[i], index->cell_size), i};
+    }
+    qsort(edited, counts[1], sizeof(emojivur_glyph_index_entry_t), emojivur_glyph_index_entry_compare);
+    if (!moved_sorted)
+    {
+        qsort(moved, counts[2], sizeof(emojivur_glyph_index_entry_t), emojivur_glyph_index_entry_compare);
+    }
+
+    updated->cell_size = index->cell_size;
+    updated->reach = index->reach;
+    updated->min_row = INT32_MAX;
+    updated->max_row = INT32_MIN;
+    updated->entry_count = glyph_count;
+    const emojivur_glyph_index_entry_t *sources[3] = {kept, edited, moved};
+    unsigned int positions[3] = {0, 0, 0};
+    for (unsigned int i = 0; i < glyph_count; ++i)
+    {
+        unsigned int source = 3;
+        for (unsigned int s = 0; s < 3; ++s)
+        {
+            if (positions[s] < counts[s] &&
+                (source == 3 || emojivur_glyph_index_entry_compare(&sources[s][positions[s]],
+                                                                    &sources[source][positions[source]]) < 0))
+            {
+                source = s;
+            }
+        }
+        updated->entries[i] = sources[source][positions[source]++];
+        int32_t row = (int32_t)((uint32_t)(updated->entries[i].cell >> 32) ^ 0x80000000u);
+        updated->min_row = MIN(updated->min_row, row);
+        updated->max_row = MAX(updated->max_row, row);
+    }
+    free(runs);
+    free(index);
+
+    return updated;
+}
+
+/*!
+ * \brief Destroy an index
+ *
+ * \param index             Index to destroy (can be NULL)
+ *
+ */
+void emojivur_glyph_index_destroy(emojivur_glyph_index_t *index)
+{
+    free(index);
+}
+
+/*!
+ * \brief Find the glyphs which can be visible in an area
+ *
+ * Glyphs are found in the order they are laid out, so that overlapping glyphs are drawn as usual.
+ * The cost depends on the size of the area and on the glyphs found, not on the glyphs indexed.
+ *
+ * \param index             Index to search
+ * \param x0                Left edge of the area
+ * \param y0                Top edge of the area
+ * \param x1                Right edge of the area
+ * \param y1                Bottom edge of the area
+ * \param glyph_ids         Vector of the positions of the glyphs found (grown with `realloc()` as needed)
+ * \param glyph_ids_allocated Number of positions that fit in `*glyph_ids` (updated when grown)
+ * \param glyph_id_count    Number of glyphs found (output)
+ *
+ * \return `false` if out of memory
+ *
+ */
+bool emojivur_glyph_index_query(const emojivur_glyph_index_t *index, double x0, double y0, double x1, double y1,
+                                unsigned int **glyph_ids, unsigned int *glyph_ids_allocated,
+                                unsigned int *glyph_id_count)
+{
+    *glyph_id_count = 0;
+    if (index->entry_count == 0)
+    {
+        return true;
+    }
+
+    // Glyphs whose origin is outside of the area can still draw inside of it
+    int32_t first_row = MAX(emojivur_glyph_index_line(y0 - index->reach, index->cell_size), index->min_row);
+    int32_t last_row = MIN(emojivur_glyph_index_line(y1 + index->reach, index->cell_size), index->max_row);
+    int32_t first_column = emojivur_glyph_index_line(x0 - index->reach, index->cell_size);
+    int32_t last_column = emojivur_glyph_index_line(x1 + index->reach, index->cell_size);
+
+    for (int64_t row = first_row; row <= last_row; ++row)
+    {
+        uint64_t first_cell = emojivur_glyph_index_cell(row, first_column);
+        uint64_t last_cell = emojivur_glyph_index_cell(row, last_column);
+
+        // Binary search of the first glyph in the row at or after the first column
+        unsigned int low = 0;
+        unsigned int high = index->entry_count;
+        while (low < high)
+        {
+            unsigned int middle = low + (high - low) / 2;
+            if (index->entries[middle].cell < first_cell)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        for (unsigned int i = low; i < index->entry_count && index->entries[i].cell <= last_cell; ++i)
+        {
+            if (*glyph_id_count == *glyph_ids_allocated)
+            {
+                unsigned int allocated = MAX(*glyph_ids_allocated * 2, 256);
+                unsigned int *ids = (unsigned int *)realloc(*glyph_ids, allocated * sizeof(unsigned int));
+                if (unlikely(!ids))
+                {
+                    return false;
+                }
+                *glyph_ids = ids;
+                *glyph_ids_allocated = allocated;
+            }
+            (*glyph_ids)[(*glyph_id_count)++] = index->entries[i].glyph_id;
+        }
+    }
+
+    // Cells are visited row by row: restore the layout order
+    qsort(*glyph_ids, *glyph_id_count, sizeof(unsigned int), emojivur_glyph_id_compare);
+
+    return true;
+}
@@ -1,10 +1,83 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+
+#include <unistd.h>
+#ifdef _POSIX_MAPPED_FILES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include <harfbuzz/hb.h>
 
 #include "config.h"
 
+#ifdef _POSIX_MAPPED_FILES
+typedef struct
+{
+    char *contents;
+    unsigned long length;
+} hb_mapped_file_t;
+
+static void
+_hb_mapped_file_destroy(void *file_)
+{
+    hb_mapped_file_t *file = (hb_mapped_file_t *)file_;
+    munmap(file->contents, file->length);
+    free(file);
+}
+
+/* Map a regular file read-only in memory: pages are loaded lazily by the OS
+   and the blob unmaps them once destroyed. Returns NULL (setting errno) when
+   the file cannot be mapped, e.g. because it is a pipe, to let the caller
+   fall back to reading it. */
+static hb_blob_t *
+_hb_blob_create_from_mapped_file(const char *file_name)
+{
+    hb_mapped_file_t *file = (hb_mapped_file_t *)calloc(1, sizeof(hb_mapped_file_t));
+    if (unlikely(!file))
+        return NULL;
+
+    int fd = open(file_name, O_RDONLY);
+    if (unlikely(fd == -1))
+        goto mmap_fail_without_close;
+
+    struct stat st;
+    if (unlikely(fstat(fd, &st) == -1))
+        goto mmap_fail;
+
+    /* Neither pipes nor empty files can be mapped */
+    if (!S_ISREG(st.st_mode) || st.st_size <= 0)
+    {
+        errno = ENODEV;
+        goto mmap_fail;
+    }
+
+    file->length = (unsigned long)st.st_size;
+
+    int mmap_flags = MAP_PRIVATE;
+#ifdef MAP_NORESERVE
+    mmap_flags |= MAP_NORESERVE;
+#endif
+    file->contents = (char *)mmap(NULL, file->length, PROT_READ, mmap_flags, fd, 0);
+    if (unlikely(file->contents == MAP_FAILED))
+        goto mmap_fail;
+
+    close(fd);
+
+    return hb_blob_create(file->contents, file->length,
+                          HB_MEMORY_MODE_READONLY_MAY_MAKE_WRITABLE, (void *)file,
+                          (hb_destroy_func_t)_hb_mapped_file_destroy);
+
+mmap_fail:
+    close(fd);
+mmap_fail_without_close:
+    free(file);
+    return NULL;
+}
+#endif
+
 /**
  * hb_blob_create_from_file:
  *
@@ -20,6 +93,15 @@
 hb_blob_t *
 hb_blob_create_from_file(const char *file_name)
 {
+#ifdef _POSIX_MAPPED_FILES
+    hb_blob_t *mapped_blob = _hb_blob_create_from_mapped_file(file_name);
+    if (likely(mapped_blob))
+        return mapped_blob;
+    /* Missing files won't get any better by reading them */
+    if (errno == ENOENT || errno == EACCES)
+        return hb_blob_get_empty();
+#endif
+
     /* The following tries to read a file without knowing its size beforehand
      It's used as a fallback for systems without mmap or to read from pipes */
     unsigned long len = 0;
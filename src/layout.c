@@ -0,0 +1,1341 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       layout.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Text laid out on many lines, wrapped again without shaping it again
+//
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <cairo/cairo.h>
+#include <harfbuzz/hb.h>
+
+#include "config.h"
+#include "font_chain.h"
+#include "layout.h"
+#include "line_break.h"
+#include "stats.h"
+
+// The line can be broken before the glyph
+#define EMOJIVUR_LAYOUT_BREAK_BEFORE 0x1
+
+// The glyph is a space, hanging past the end of the line if it gets there
+#define EMOJIVUR_LAYOUT_SPACE 0x2
+
+// Shaping cannot start at the glyph without changing the glyphs around it
+#define EMOJIVUR_LAYOUT_UNSAFE_TO_BREAK 0x4
+
+/*!
+ * \brief Glyph shaped as part of its paragraph
+ *
+ */
+typedef struct
+{
+    double pen_x;        /**< Advances of the glyphs before it in the paragraph */
+    double x_advance;    /**< Horizontal advance */
+    double x_offset;     /**< Horizontal offset from the pen position */
+    double y_offset;     /**< Vertical offset from the baseline (upwards) */
+    size_t cluster;      /**< Offset in the text of the cluster the glyph belongs to */
+    unsigned int index;  /**< Glyph index in the font */
+    unsigned int flags;  /**< `EMOJIVUR_LAYOUT_*` flags */
+} emojivur_layout_glyph_t;
+
+/*!
+ * \brief Text between hard line breaks, shaped on its own
+ *
+ */
+typedef struct
+{
+    unsigned int first_glyph; /**< Position of the first glyph */
+    unsigned int glyph_count; /**< Number of glyphs */
+    unsigned int first_line;  /**< First line the paragraph is broken in */
+    size_t text_start;        /**< Offset of the paragraph in the text */
+    size_t text_end;          /**< Offset of the end of its content (i.e. of the hard line break closing it) */
+} emojivur_layout_paragraph_t;
+
+/*!
+ * \brief Glyphs of a paragraph shown on the same line
+ *
+ */
+typedef struct
+{
+    unsigned int first_glyph; /**< Position of the first glyph */
+    unsigned int glyph_count; /**< Number of glyphs */
+    double width;             /**< Width of the glyphs (hanging spaces excluded) */
+} emojivur_layout_line_t;
+
+/*!
+ * \brief Shaped paragraphs and the lines they are currently broken in
+ *
+ */
+struct emojivur_layout
+{
+    double line_height;                      /**< Distance between the baselines of two lines */
+    double width;                            /**< Width of the widest line */
+    double wrap_width;                       /**< Width the lines are broken at */
+    emojivur_font_chain_t *font_chain;       /**< Fonts the glyphs come from */
+    char *text;                              /**< Text laid out (not NUL terminated) */
+    uint8_t *breaks;                         /**< Line break opportunity before each byte of the text */
+    size_t text_length;                      /**< Length of the text in bytes */
+    size_t text_allocated;                   /**< Number of bytes that fit in `text` and in `breaks` */
+    emojivur_layout_glyph_t *glyphs;         /**< Glyphs of all paragraphs */
+    uint8_t *glyph_fonts;                    /**< Position in the font chain of the font of each glyph (NULL for one font) */
+    unsigned int glyph_count;                /**< Number of glyphs */
+    unsigned int glyphs_allocated;           /**< Number of glyphs that fit in `glyphs` */
+    emojivur_layout_paragraph_t *paragraphs; /**< Paragraphs (text between hard line breaks) */
+    unsigned int paragraph_count;            /**< Number of paragraphs */
+    unsigned int paragraphs_allocated;       /**< Number of paragraphs that fit in `paragraphs` */
+    emojivur_layout_line_t *lines;           /**< Lines the paragraphs are broken in */
+    unsigned int line_count;                 /**< Number of lines */
+    unsigned int lines_allocated;            /**< Number of lines that fit in `lines` */
+    void *scratch;                           /**< Room for the items moved by `emojivur_layout_splice()` */
+    size_t scratch_size;                     /**< Size of `scratch` in bytes */
+};
+
+/*!
+ * \brief Make room in a vector growing it geometrically
+ *
+ * \param vector            Vector to grow (moved if needed)
+ * \param allocated         Number of items that fit in the vector (updated)
+ * \param needed            Number of items the vector has to hold
+ * \param item_size         Size of an item
+ *
+ * \return `true` on success, `false` if out of memory (the vector is left untouched)
+ *
+ */
+static bool emojivur_layout_reserve(void **vector, unsigned int *allocated, unsigned int needed, size_t item_size)
+{
+    if (needed <= *allocated)
+    {
+        return true;
+    }
+
+    unsigned int grown = MAX(needed, MAX(16, *allocated * 2));
+    void *moved = realloc(*vector, grown * item_size);
+    if (unlikely(!moved))
+    {
+        return false;
+    }
+    *vector = moved;
+    *allocated = grown;
+
+    return true;
+}
+
+/*!
+ * \brief Make room for glyphs in a layout (and for their fonts, when the chain has many)
+ *
+ * \param layout            Layout to grow
+ * \param needed            Number of glyphs the layout has to hold
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_reserve_glyphs(emojivur_layout_t *layout, unsigned int needed)
+{
+    unsigned int glyphs_allocated = layout->glyphs_allocated;
+    if (unlikely(!emojivur_layout_reserve((void **)&layout->glyphs, &layout->glyphs_allocated, needed,
+                                          sizeof(emojivur_layout_glyph_t))))
+    {
+        return false;
+    }
+
+    if (emojivur_font_chain_count(layout->font_chain) > 1 &&
+        (layout->glyphs_allocated != glyphs_allocated || !layout->glyph_fonts))
+    {
+        uint8_t *glyph_fonts = (uint8_t *)realloc(layout->glyph_fonts, layout->glyphs_allocated);
+        if (unlikely(!glyph_fonts))
+        {
+            return false;
+        }
+        layout->glyph_fonts = glyph_fonts;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Move the items appended to a vector in place of some of the items before them
+ *
+ * \param layout            Layout owning the vector (and the scratch room the appended items are moved through)
+ * \param vector            Vector of `count` items followed by the `appended` ones
+ * \param item_size         Size of an item
+ * \param count             Number of items before the appended ones
+ * \param first             Position of the first item to replace
+ * \param removed           Number of items to replace
+ * \param appended          Number of items appended
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_splice(emojivur_layout_t *layout, void *vector, size_t item_size, unsigned int count,
+                                   unsigned int first, unsigned int removed, unsigned int appended)
+{
+    char *items = (char *)vector;
+    size_t appended_size = appended * item_size;
+    if (appended_size > layout->scratch_size)
+    {
+        void *scratch = realloc(layout->scratch, MAX(appended_size, layout->scratch_size * 2));
+        if (unlikely(!scratch))
+        {
+            return false;
+        }
+        layout->scratch = scratch;
+        layout->scratch_size = MAX(appended_size, layout->scratch_size * 2);
+    }
+
+    if (appended_size > 0)
+    {
+        memcpy(layout->scratch, items + count * item_size, appended_size);
+    }
+    if (count > first + removed && appended != removed)
+    {
+        memmove(items + (first + appended) * item_size, items + (first + removed) * item_size,
+                (count - first - removed) * item_size);
+    }
+    if (appended_size > 0)
+    {
+        memcpy(items + first * item_size, layout->scratch, appended_size);
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Find where the content of a paragraph ends, before the hard line break closing it
+ *
+ * \param text              UTF-8 text
+ * \param start             Offset of the paragraph
+ * \param end               Offset of the next paragraph (or end of the text)
+ *
+ * \return Offset of the end of the content
+ *
+ */
+static size_t emojivur_layout_content_end(const char *text, size_t start, size_t end)
+{
+    // At most CR LF: any other hard line break starts a paragraph on its own
+    for (unsigned int i = 0; i < 2 && end > start; ++i)
+    {
+        const unsigned char *last = (const unsigned char *)text + end;
+        if (last[-1] == '\n' || last[-1] == '\r' || last[-1] == '\v' || last[-1] == '\f')
+        {
+            end -= 1;
+        }
+        else if (end - start >= 2 && last[-2] == 0xC2 && last[-1] == 0x85)
+        {
+            end -= 2;
+        }
+        else if (end - start >= 3 && last[-3] == 0xE2 && last[-2] == 0x80 && (last[-1] == 0xA8 || last[-1] == 0xA9))
+        {
+            end -= 3;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return end;
+}
+
+/*!
+ * \brief Shape a range of text appending its glyphs to the layout
+ *
+ * The range is split in runs of characters covered by the same font of the chain, each shaped on its own.
+ * The rest of the text is handed over to the shaper as context.
+ *
+ * \param layout            Layout to add the glyphs to
+ * \param buffer            HarfBuzz buffer to shape the text with
+ * \param start             Offset of the range
+ * \param end               Offset of the end of the range
+ * \param pen_x             Pen position of the first glyph (updated past the last one)
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_shape(emojivur_layout_t *layout, hb_buffer_t *buffer, size_t start, size_t end,
+                                  double *pen_x)
+{
+    for (size_t run_start = start; run_start < end;)
+    {
+        unsigned int font = 0;
+        size_t run_end = emojivur_font_chain_run(layout->font_chain, layout->text, run_start, end, &font);
+
+        // Text is shaped LTR using the common script and the default language, as in `emojivur_shape_text()`
+        hb_buffer_clear_contents(buffer);
+        hb_buffer_set_direction(buffer, HB_DIRECTION_LTR);
+        hb_buffer_set_script(buffer, HB_SCRIPT_COMMON);
+        hb_buffer_set_language(buffer, hb_language_get_default());
+        hb_buffer_add_utf8(buffer, layout->text, layout->text_length, run_start, run_end - run_start);
+        hb_shape(emojivur_font_chain_harfbuzz_font(layout->font_chain, font), buffer, NULL, 0);
+        if (unlikely(!hb_buffer_allocation_successful(buffer)))
+        {
+            return false;
+        }
+
+        unsigned int glyph_count = hb_buffer_get_length(buffer);
+        hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(buffer, NULL);
+        hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(buffer, NULL);
+        if (unlikely(!emojivur_layout_reserve_glyphs(layout, layout->glyph_count + glyph_count)))
+        {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < glyph_count; ++i)
+        {
+            uint32_t cluster = glyph_info[i].cluster;
+            const char *character = layout->text + cluster;
+            bool space = character[0] == ' ' ||
+                         (cluster + 3 <= layout->text_length && memcmp(character, "\xE3\x80\x80", 3) == 0);
+            // Runs start at safe points: the first glyph of a run is as safe as where the run starts
+            bool unsafe = i > 0 && (hb_glyph_info_get_glyph_flags(&glyph_info[i]) & HB_GLYPH_FLAG_UNSAFE_TO_BREAK);
+
+            if (layout->glyph_fonts)
+            {
+                layout->glyph_fonts[layout->glyph_count] = font;
+            }
+            layout->glyphs[layout->glyph_count++] = (emojivur_layout_glyph_t){
+                .pen_x = *pen_x,
+                .x_advance = glyph_pos[i].x_advance / (64.0),
+                .x_offset = glyph_pos[i].x_offset / (64.0),
+                .y_offset = glyph_pos[i].y_offset / (64.0),
+                .cluster = cluster,
+                .index = glyph_info[i].codepoint,
+                .flags = (space ? EMOJIVUR_LAYOUT_SPACE : 0) | (unsafe ? EMOJIVUR_LAYOUT_UNSAFE_TO_BREAK : 0),
+            };
+            *pen_x += glyph_pos[i].x_advance / (64.0);
+        }
+        run_start = run_end;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Flag the glyphs of a paragraph the line can be broken before
+ *
+ * Lines can be broken between clusters only, so that no glyph is ever split from its cluster.
+ *
+ * \param layout            Layout
+ * \param paragraph         Paragraph whose glyphs are flagged
+ * \param first             First glyph to flag
+ * \param end               Glyph after the last one to flag
+ *
+ */
+static void emojivur_layout_flag_breaks(emojivur_layout_t *layout, const emojivur_layout_paragraph_t *paragraph,
+                                        unsigned int first, unsigned int end)
+{
+    for (unsigned int i = first; i < end; ++i)
+    {
+        emojivur_layout_glyph_t *glyph = &layout->glyphs[i];
+        bool cluster_start = i == paragraph->first_glyph || glyph->cluster != glyph[-1].cluster;
+        if (cluster_start && glyph->cluster > paragraph->text_start &&
+            layout->breaks[glyph->cluster] == EMOJIVUR_BREAK_ALLOWED)
+        {
+            glyph->flags |= EMOJIVUR_LAYOUT_BREAK_BEFORE;
+        }
+        else
+        {
+            glyph->flags &= ~EMOJIVUR_LAYOUT_BREAK_BEFORE;
+        }
+    }
+}
+
+/*!
+ * \brief Shape a paragraph appending it (and its glyphs) to the layout
+ *
+ * \param layout            Layout to add the paragraph to
+ * \param buffer            HarfBuzz buffer to shape the paragraph with
+ * \param start             Offset of the paragraph
+ * \param end               Offset of the end of its content
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_shape_paragraph(emojivur_layout_t *layout, hb_buffer_t *buffer, size_t start,
+                                            size_t end)
+{
+    if (unlikely(!emojivur_layout_reserve((void **)&layout->paragraphs, &layout->paragraphs_allocated,
+                                          layout->paragraph_count + 1, sizeof(emojivur_layout_paragraph_t))))
+    {
+        return false;
+    }
+    unsigned int first_glyph = layout->glyph_count;
+    double pen_x = 0;
+    if (unlikely(!emojivur_layout_shape(layout, buffer, start, end, &pen_x)))
+    {
+        return false;
+    }
+
+    emojivur_layout_paragraph_t *paragraph = &layout->paragraphs[layout->paragraph_count++];
+    *paragraph = (emojivur_layout_paragraph_t){first_glyph, layout->glyph_count - first_glyph, 0, start, end};
+    emojivur_layout_flag_breaks(layout, paragraph, first_glyph, layout->glyph_count);
+
+    return true;
+}
+
+/*!
+ * \brief Shape the paragraphs of a range of text appending them (and their glyphs) to the layout
+ *
+ * Paragraphs are shaped on their own: nothing gets shaped across a hard line break.
+ *
+ * \param layout            Layout to add the paragraphs to
+ * \param buffer            HarfBuzz buffer to shape the paragraphs with
+ * \param start             Offset of the range (the start of a paragraph)
+ * \param end               Offset of the end of the range (the start of a paragraph or the end of the text)
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_shape_paragraphs(emojivur_layout_t *layout, hb_buffer_t *buffer, size_t start,
+                                             size_t end)
+{
+    size_t paragraph_start = start;
+    bool hard_break = false;
+    for (size_t offset = start + 1; offset <= end; ++offset)
+    {
+        if (offset == layout->text_length || layout->breaks[offset] == EMOJIVUR_BREAK_MANDATORY)
+        {
+            size_t content_end = emojivur_layout_content_end(layout->text, paragraph_start, offset);
+            if (unlikely(!emojivur_layout_shape_paragraph(layout, buffer, paragraph_start, content_end)))
+            {
+                return false;
+            }
+            paragraph_start = offset;
+            hard_break = content_end < offset;
+        }
+    }
+
+    // The last line is empty when the text is, or when it ends with a hard line break
+    if (end == layout->text_length && (start == end || hard_break))
+    {
+        return emojivur_layout_shape_paragraph(layout, buffer, end, end);
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Shape a text once, one paragraph (i.e. text between hard line breaks) at a time
+ *
+ * Advances, clusters and line break opportunities of the glyphs are kept, so that
+ * `emojivur_layout_wrap()` can break the paragraphs in lines of any width afterwards, and
+ * `emojivur_layout_edit()` can shape again only the clusters an edit changes. A hard line break
+ * closing the text starts an empty last line.
+ *
+ * \param font_chain        Fonts to shape the text with (scaled to the size of the glyphs)
+ * \param buffer            HarfBuzz buffer to shape the paragraphs with
+ * \param text              UTF-8 text to lay out (copied)
+ * \param text_length       Length of the text in bytes (-1 if the text is NUL terminated)
+ * \param line_height       Distance between the baselines of two lines
+ *
+ * \return The new layout (wrapped on no width limit), NULL on failure
+ *
+ */
+emojivur_layout_t *emojivur_layout_create(emojivur_font_chain_t *font_chain, hb_buffer_t *buffer, const char *text,
+                                          int text_length, double line_height)
+{
+    size_t length = text_length < 0 ? strlen(text) : (size_t)text_length;
+    emojivur_layout_t *layout = (emojivur_layout_t *)calloc(1, sizeof(emojivur_layout_t));
+    if (unlikely(!layout))
+    {
+        return NULL;
+    }
+    layout->line_height = line_height;
+    layout->font_chain = font_chain;
+    layout->text_allocated = MAX(length, 16);
+    layout->text = (char *)malloc(layout->text_allocated);
+    layout->breaks = (uint8_t *)malloc(layout->text_allocated);
+    if (unlikely(!layout->text || !layout->breaks))
+    {
+        emojivur_layout_destroy(layout);
+        return NULL;
+    }
+    memcpy(layout->text, text, length);
+    layout->text_length = length;
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_SHAPE);
+    emojivur_line_breaks(layout->text, length, layout->breaks);
+    bool shaped = emojivur_layout_shape_paragraphs(layout, buffer, 0, length);
+    emojivur_stats_stop(&timer);
+
+    if (unlikely(!shaped || !emojivur_layout_wrap(layout, INFINITY)))
+    {
+        emojivur_layout_destroy(layout);
+        return NULL;
+    }
+
+    return layout;
+}
+
+/*!
+ * \brief Destroy a layout
+ *
+ * \param layout            Layout to destroy (can be NULL)
+ *
+ */
+void emojivur_layout_destroy(emojivur_layout_t *layout)
+{
+    if (!layout)
+    {
+        return;
+    }
+
+    free(layout->text);
+    free(layout->breaks);
+    free(layout->glyphs);
+    free(layout->glyph_fonts);
+    free(layout->paragraphs);
+    free(layout->lines);
+    free(layout->scratch);
+    free(layout);
+}
+
+/*!
+ * \brief Get the number of glyphs of a layout (the same whatever the width it is wrapped at)
+ *
+ * \param layout            Layout
+ *
+ * \return Number of glyphs
+ *
+ */
+unsigned int emojivur_layout_glyph_count(const emojivur_layout_t *layout)
+{
+    return layout->glyph_count;
+}
+
+/*!
+ * \brief Get the fonts the glyphs of a layout come from
+ *
+ * \param layout            Layout
+ *
+ * \return Position in the font chain of the font of each glyph (NULL if the chain has one font only)
+ *
+ */
+const uint8_t *emojivur_layout_glyph_fonts(const emojivur_layout_t *layout)
+{
+    return layout->glyph_fonts;
+}
+
+/*!
+ * \brief Append a line to a layout
+ *
+ * \param layout            Layout to add the line to
+ * \param first_glyph       Position of the first glyph of the line
+ * \param glyph_count       Number of glyphs of the line
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_add_line(emojivur_layout_t *layout, unsigned int first_glyph, unsigned int glyph_count)
+{
+    if (unlikely(!emojivur_layout_reserve((void **)&layout->lines, &layout->lines_allocated,
+                                          layout->line_count + 1, sizeof(emojivur_layout_line_t))))
+    {
+        return false;
+    }
+
+    // Spaces at the end of a line hang past it
+    unsigned int visible_count = glyph_count;
+    while (visible_count > 0 && (layout->glyphs[first_glyph + visible_count - 1].flags & EMOJIVUR_LAYOUT_SPACE))
+    {
+        --visible_count;
+    }
+    double width = 0;
+    if (visible_count > 0)
+    {
+        const emojivur_layout_glyph_t *last = &layout->glyphs[first_glyph + visible_count - 1];
+        width = last->pen_x + last->x_advance - layout->glyphs[first_glyph].pen_x;
+    }
+
+    layout->lines[layout->line_count++] = (emojivur_layout_line_t){first_glyph, glyph_count, width};
+    layout->width = MAX(layout->width, width);
+
+    return true;
+}
+
+/*!
+ * \brief Break a paragraph of a layout in lines no wider than the width it is wrapped at, appending them
+ *
+ * \param layout            Layout
+ * \param paragraph         Paragraph to break
+ * \param line_start        First glyph of the first line to append (the first glyph of the paragraph at most)
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_wrap_paragraph(emojivur_layout_t *layout, unsigned int paragraph, unsigned int line_start)
+{
+    unsigned int paragraph_end = layout->paragraphs[paragraph].first_glyph + layout->paragraphs[paragraph].glyph_count;
+    unsigned int last_break = line_start;
+
+    for (unsigned int i = line_start; i < paragraph_end; ++i)
+    {
+        const emojivur_layout_glyph_t *glyph = &layout->glyphs[i];
+        if (i > line_start && (glyph->flags & EMOJIVUR_LAYOUT_BREAK_BEFORE))
+        {
+            last_break = i;
+        }
+
+        // Words wider than a whole line overflow it, as they cannot be broken
+        double line_width = glyph->pen_x + glyph->x_advance - layout->glyphs[line_start].pen_x;
+        if (!(glyph->flags & EMOJIVUR_LAYOUT_SPACE) && line_width > layout->wrap_width && last_break > line_start)
+        {
+            if (unlikely(!emojivur_layout_add_line(layout, line_start, last_break - line_start)))
+            {
+                return false;
+            }
+
+            // The glyphs past the break start the next line: measure them again
+            line_start = last_break;
+            i = line_start;
+        }
+    }
+
+    return emojivur_layout_add_line(layout, line_start, paragraph_end - line_start);
+}
+
+/*!
+ * \brief Break the paragraphs of a layout in lines no wider than a width
+ *
+ * Lines are filled greedily and broken at the last opportunity fitting the width, spaces
+ * at the end of a line hanging past it. Only the advances kept are added up: no text is shaped.
+ *
+ * \param layout            Layout to wrap
+ * \param width             Width of the lines (INFINITY to break lines at hard line breaks only)
+ *
+ * \return Number of lines, 0 on failure
+ *
+ */
+unsigned int emojivur_layout_wrap(emojivur_layout_t *layout, double width)
+{
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_GLYPHS);
+    layout->line_count = 0;
+    layout->width = 0;
+    layout->wrap_width = width;
+
+    for (unsigned int p = 0; p < layout->paragraph_count; ++p)
+    {
+        layout->paragraphs[p].first_line = layout->line_count;
+        if (unlikely(!emojivur_layout_wrap_paragraph(layout, p, layout->paragraphs[p].first_glyph)))
+        {
+            emojivur_stats_stop(&timer);
+            return 0;
+        }
+    }
+    emojivur_stats_stop(&timer);
+
+    return layout->line_count;
+}
+
+/*!
+ * \brief Break again the lines of the paragraphs of a layout an edit changed
+ *
+ * The lines before the first one broken again are kept, and so are the lines of the paragraphs after
+ * the ones edited, just moved by the change in the number of glyphs. The lines broken again are
+ * appended, then moved in place of the old ones.
+ *
+ * \param layout            Layout (edited, still holding the lines it was broken in before the edit)
+ * \param first_paragraph   First paragraph edited
+ * \param end_paragraph     Paragraph after the last one edited
+ * \param first_line        First line to break again (one of the first paragraph edited)
+ * \param line_start        First glyph of that line
+ * \param glyph_delta       Change in the number of glyphs
+ *
+ * \return Number of lines, 0 on failure
+ *
+ */
+static unsigned int emojivur_layout_rewrap(emojivur_layout_t *layout, unsigned int first_paragraph,
+                                           unsigned int end_paragraph, unsigned int first_line,
+                                           unsigned int line_start, int glyph_delta)
+{
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_GLYPHS);
+    unsigned int line_count = layout->line_count;
+    unsigned int end_line = end_paragraph < layout->paragraph_count ? layout->paragraphs[end_paragraph].first_line
+                                                                    : line_count;
+    for (unsigned int p = first_paragraph; p < end_paragraph; ++p)
+    {
+        unsigned int paragraph_start = p == first_paragraph ? line_start : layout->paragraphs[p].first_glyph;
+        if (paragraph_start == layout->paragraphs[p].first_glyph)
+        {
+            layout->paragraphs[p].first_line = first_line + layout->line_count - line_count;
+        }
+        if (unlikely(!emojivur_layout_wrap_paragraph(layout, p, paragraph_start)))
+        {
+            emojivur_stats_stop(&timer);
+            return 0;
+        }
+    }
+
+    unsigned int lines_added = layout->line_count - line_count;
+    if (unlikely(!emojivur_layout_splice(layout, layout->lines, sizeof(emojivur_layout_line_t), line_count,
+                                         first_line, end_line - first_line, lines_added)))
+    {
+        emojivur_stats_stop(&timer);
+        return 0;
+    }
+    int line_delta = (int)lines_added - (int)(end_line - first_line);
+    layout->line_count = line_count + line_delta;
+    for (unsigned int l = first_line + lines_added; l < layout->line_count; ++l)
+    {
+        layout->lines[l].first_glyph += glyph_delta;
+    }
+    for (unsigned int p = end_paragraph; p < layout->paragraph_count; ++p)
+    {
+        layout->paragraphs[p].first_line += line_delta;
+    }
+
+    // The widest line may be one of those broken again
+    layout->width = 0;
+    for (unsigned int l = 0; l < layout->line_count; ++l)
+    {
+        layout->width = MAX(layout->width, layout->lines[l].width);
+    }
+    emojivur_stats_stop(&timer);
+
+    return layout->line_count;
+}
+
+/*!
+ * \brief Find the paragraph an offset of the text belongs to
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ *
+ * \return Last paragraph starting at or before the offset
+ *
+ */
+static unsigned int emojivur_layout_paragraph_at(const emojivur_layout_t *layout, size_t offset)
+{
+    unsigned int low = 0;
+    unsigned int high = layout->paragraph_count;
+    while (high - low > 1)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (layout->paragraphs[middle].text_start <= offset)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*!
+ * \brief Find the first glyph of a paragraph whose cluster starts at or after an offset of the text
+ *
+ * \param layout            Layout
+ * \param paragraph         Paragraph (whose clusters grow from glyph to glyph, as it is shaped LTR)
+ * \param offset            Offset in the text
+ *
+ * \return Position of the glyph (the one past the paragraph if none)
+ *
+ */
+static unsigned int emojivur_layout_glyph_at(const emojivur_layout_t *layout,
+                                             const emojivur_layout_paragraph_t *paragraph, size_t offset)
+{
+    unsigned int low = paragraph->first_glyph;
+    unsigned int high = paragraph->first_glyph + paragraph->glyph_count;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (layout->glyphs[middle].cluster < offset)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*!
+ * \brief Get the pen position past the last glyph of a paragraph
+ *
+ * \param layout            Layout
+ * \param paragraph         Paragraph
+ *
+ * \return Sum of the advances of the glyphs of the paragraph
+ *
+ */
+static double emojivur_layout_paragraph_width(const emojivur_layout_t *layout,
+                                              const emojivur_layout_paragraph_t *paragraph)
+{
+    if (paragraph->glyph_count == 0)
+    {
+        return 0;
+    }
+    const emojivur_layout_glyph_t *last = &layout->glyphs[paragraph->first_glyph + paragraph->glyph_count - 1];
+
+    return last->pen_x + last->x_advance;
+}
+
+/*!
+ * \brief Check whether a text holds a hard line break
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ *
+ * \return `true` if a character of the text breaks lines
+ *
+ */
+static bool emojivur_layout_has_hard_break(const char *text, size_t text_length)
+{
+    for (size_t offset = 0; offset < text_length;)
+    {
+        uint32_t codepoint = emojivur_utf8_next(text, text_length, &offset);
+        if ((codepoint >= 0x0A && codepoint <= 0x0D) || codepoint == 0x85 || codepoint == 0x2028 ||
+            codepoint == 0x2029)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Move the first glyph of a range of glyphs of a paragraph back to the previous cluster safe to break at
+ *
+ * \param layout            Layout
+ * \param paragraph         Paragraph of the glyphs
+ * \param glyph             First glyph of the range
+ *
+ * \return First glyph of the cluster (the first glyph of the paragraph at most)
+ *
+ */
+static unsigned int emojivur_layout_safe_before(const emojivur_layout_t *layout,
+                                                const emojivur_layout_paragraph_t *paragraph, unsigned int glyph)
+{
+    do
+    {
+        glyph -= glyph > paragraph->first_glyph ? 1 : 0;
+        while (glyph > paragraph->first_glyph && layout->glyphs[glyph - 1].cluster == layout->glyphs[glyph].cluster)
+        {
+            --glyph;
+        }
+    } while (glyph > paragraph->first_glyph && (layout->glyphs[glyph].flags & EMOJIVUR_LAYOUT_UNSAFE_TO_BREAK));
+
+    return glyph;
+}
+
+/*!
+ * \brief Move the end of a range of glyphs of a paragraph on past the next cluster, to a glyph safe to break at
+ *
+ * \param layout            Layout
+ * \param paragraph         Paragraph of the glyphs
+ * \param glyph             Glyph after the last one of the range
+ *
+ * \return First glyph of the cluster the range now ends before (the one past the paragraph at most)
+ *
+ */
+static unsigned int emojivur_layout_safe_after(const emojivur_layout_t *layout,
+                                               const emojivur_layout_paragraph_t *paragraph, unsigned int glyph)
+{
+    unsigned int paragraph_end = paragraph->first_glyph + paragraph->glyph_count;
+    do
+    {
+        size_t cluster = glyph < paragraph_end ? layout->glyphs[glyph].cluster : 0;
+        while (glyph < paragraph_end && layout->glyphs[glyph].cluster == cluster)
+        {
+            ++glyph;
+        }
+    } while (glyph < paragraph_end && (layout->glyphs[glyph].flags & EMOJIVUR_LAYOUT_UNSAFE_TO_BREAK));
+
+    return glyph;
+}
+
+/*!
+ * \brief Shape again a range of glyphs of an edited paragraph, appending the new glyphs to the layout
+ *
+ * One more cluster is shaped on each side of the range: the glyphs around it are kept only if the new
+ * glyphs bordering them are still safe to break at, otherwise the range grows and is shaped again.
+ *
+ * \param layout            Layout (whose text is edited already)
+ * \param buffer            HarfBuzz buffer to shape the text with
+ * \param paragraph         Paragraph edited (as it was before the edit)
+ * \param delta             Change in the length of the text
+ * \param start_glyph       First glyph to replace (moved back if needed)
+ * \param end_glyph         Glyph after the last one to replace (moved on if needed)
+ * \param pen_shift         Change in the pen position of the glyphs after the ones replaced (output)
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_layout_reshape(emojivur_layout_t *layout, hb_buffer_t *buffer,
+                                    const emojivur_layout_paragraph_t *paragraph, ptrdiff_t delta,
+                                    unsigned int *start_glyph, unsigned int *end_glyph, double *pen_shift)
+{
+    unsigned int glyph_count = layout->glyph_count;
+    unsigned int paragraph_end = paragraph->first_glyph + paragraph->glyph_count;
+    double paragraph_width = emojivur_layout_paragraph_width(layout, paragraph);
+
+    for (;;)
+    {
+        // Text to replace, and text shaped with the cluster before and the one after it
+        unsigned int before = emojivur_layout_safe_before(layout, paragraph, *start_glyph);
+        unsigned int after = emojivur_layout_safe_after(layout, paragraph, *end_glyph);
+        size_t start = *start_glyph < paragraph_end ? layout->glyphs[*start_glyph].cluster : paragraph->text_end;
+        size_t end = (*end_glyph < paragraph_end ? layout->glyphs[*end_glyph].cluster : paragraph->text_end) + delta;
+        size_t shape_start = before < *start_glyph ? layout->glyphs[before].cluster : start;
+        size_t shape_end = (after < paragraph_end ? layout->glyphs[after].cluster : paragraph->text_end) + delta;
+        start = *start_glyph > paragraph->first_glyph ? start : paragraph->text_start;
+        shape_start = MIN(shape_start, start);
+
+        double pen_x = before < paragraph_end ? layout->glyphs[before].pen_x : paragraph_width;
+        double end_pen_x = *end_glyph < paragraph_end ? layout->glyphs[*end_glyph].pen_x : paragraph_width;
+        layout->glyph_count = glyph_count;
+        if (unlikely(!emojivur_layout_shape(layout, buffer, shape_start, shape_end, &pen_x)))
+        {
+            return false;
+        }
+
+        // New glyphs of the text to replace, bordered by glyphs which have to be safe to break at
+        unsigned int first = glyph_count;
+        while (first < layout->glyph_count && layout->glyphs[first].cluster < start)
+        {
+            ++first;
+        }
+        unsigned int last = first;
+        while (last < layout->glyph_count && layout->glyphs[last].cluster < end)
+        {
+            ++last;
+        }
+        bool start_safe = before == *start_glyph ||
+                          (first < layout->glyph_count ? layout->glyphs[first].cluster == start &&
+                                                             !(layout->glyphs[first].flags &
+                                                               EMOJIVUR_LAYOUT_UNSAFE_TO_BREAK)
+                                                       : start == shape_end);
+        bool end_safe = after == *end_glyph ||
+                        (last < layout->glyph_count && layout->glyphs[last].cluster == end &&
+                         !(layout->glyphs[last].flags & EMOJIVUR_LAYOUT_UNSAFE_TO_BREAK));
+        if (start_safe && end_safe)
+        {
+            *pen_shift = (last < layout->glyph_count ? layout->glyphs[last].pen_x : pen_x) - end_pen_x;
+            memmove(&layout->glyphs[glyph_count], &layout->glyphs[first], (last - first) * sizeof(layout->glyphs[0]));
+            if (layout->glyph_fonts)
+            {
+                memmove(&layout->glyph_fonts[glyph_count], &layout->glyph_fonts[first], last - first);
+            }
+            layout->glyph_count = glyph_count + last - first;
+            return true;
+        }
+
+        *start_glyph = start_safe ? *start_glyph : before;
+        *end_glyph = end_safe ? *end_glyph : after;
+    }
+}
+
+/*!
+ * \brief Replace part of the text of a layout, shaping again only the clusters the edit changes
+ *
+ * Within a paragraph, shaping starts at the cluster before the edit and ends at the cluster after it,
+ * both widened to the nearest glyphs HarfBuzz marks safe to break at: the glyphs outside of them
+ * are kept as they are, just moved by the change in the advances. Edits bringing or taking away
+ * hard line breaks shape again the paragraphs they touch (and the one before them) only.
+ * Line break opportunities are found again only around the edit (see `emojivur_line_breaks_update()`),
+ * and lines are broken again at the same width as before only from the line before the one of the
+ * first glyph changed to the end of the paragraphs edited.
+ *
+ * \param layout            Layout to edit
+ * \param buffer            HarfBuzz buffer to shape the text with
+ * \param offset            Offset of the text to replace (clamped to the length of the text)
+ * \param removed           Length in bytes of the text to replace
+ * \param inserted          UTF-8 text to insert in its place
+ * \param inserted_length   Length of the text to insert in bytes
+ * \param first_line        First line broken again (output): the lines and glyphs before it are left untouched
+ * \param end_line          Line after the last one broken again (output): the lines from it on hold the same
+ *                          glyphs as before, moved by the change in the number of glyphs and of lines
+ *
+ * \return `true` on success, `false` if out of memory (the layout has to be destroyed)
+ *
+ */
+bool emojivur_layout_edit(emojivur_layout_t *layout, hb_buffer_t *buffer, size_t offset, size_t removed,
+                          const char *inserted, size_t inserted_length, unsigned int *first_line,
+                          unsigned int *end_line)
+{
+    offset = MIN(offset, layout->text_length);
+    removed = MIN(removed, layout->text_length - offset);
+    ptrdiff_t delta = (ptrdiff_t)inserted_length - (ptrdiff_t)removed;
+
+    // Edits within the content of a paragraph, leaving something of it and bringing no hard line break,
+    // leave the other paragraphs alone
+    unsigned int first = emojivur_layout_paragraph_at(layout, offset);
+    unsigned int last = emojivur_layout_paragraph_at(layout, offset + removed);
+    emojivur_layout_paragraph_t paragraph = layout->paragraphs[first];
+    bool incremental = first == last && offset + removed <= paragraph.text_end &&
+                       (ptrdiff_t)(paragraph.text_end - paragraph.text_start) + delta > 0 &&
+                       !emojivur_layout_has_hard_break(inserted, inserted_length);
+
+    // Glyphs to shape again (the cluster before the edit may join the text inserted, the one after it the text
+    // left) and text of the paragraphs shaped again
+    unsigned int start_glyph;
+    unsigned int end_glyph;
+    size_t start;
+    size_t end = first + 1 < layout->paragraph_count ? layout->paragraphs[first + 1].text_start : layout->text_length;
+    if (incremental)
+    {
+        start_glyph = emojivur_layout_safe_before(layout, &paragraph, emojivur_layout_glyph_at(layout, &paragraph,
+                                                                                               offset));
+        end_glyph = emojivur_layout_safe_after(layout, &paragraph, emojivur_layout_glyph_at(layout, &paragraph,
+                                                                                             offset + removed));
+        start = paragraph.text_start;
+        *first_line = paragraph.first_line;
+    }
+    else
+    {
+        // A hard line break inserted right after a CR joins the one closing the paragraph before,
+        // and the empty paragraph after a hard line break closing the text is shaped again with it
+        first -= first > 0 ? 1 : 0;
+        if (last + 1 < layout->paragraph_count && layout->paragraphs[last + 1].text_start == layout->text_length)
+        {
+            ++last;
+        }
+        start = layout->paragraphs[first].text_start;
+        start_glyph = layout->paragraphs[first].first_glyph;
+        end = last + 1 < layout->paragraph_count ? layout->paragraphs[last + 1].text_start : layout->text_length;
+        end_glyph = last + 1 < layout->paragraph_count ? layout->paragraphs[last + 1].first_glyph : layout->glyph_count;
+        *first_line = layout->paragraphs[first].first_line;
+    }
+
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_SHAPE);
+
+    // Replace the text, then find the line break opportunities around the edit again
+    size_t text_length = layout->text_length + delta;
+    if (text_length > layout->text_allocated)
+    {
+        size_t allocated = MAX(text_length, layout->text_allocated * 2);
+        char *text = (char *)realloc(layout->text, allocated);
+        layout->text = text ? text : layout->text;
+        uint8_t *breaks = (uint8_t *)realloc(layout->breaks, allocated);
+        layout->breaks = breaks ? breaks : layout->breaks;
+        if (unlikely(!text || !breaks))
+        {
+            emojivur_stats_stop(&timer);
+            return false;
+        }
+        layout->text_allocated = allocated;
+    }
+    memmove(layout->text + offset + inserted_length, layout->text + offset + removed,
+            layout->text_length - offset - removed);
+    memmove(layout->breaks + offset + inserted_length, layout->breaks + offset + removed,
+            layout->text_length - offset - removed);
+    memcpy(layout->text + offset, inserted, inserted_length);
+    layout->text_length = text_length;
+
+    size_t breaks_start = offset;
+    size_t breaks_end = offset + inserted_length;
+    emojivur_line_breaks_update(layout->text, text_length, layout->breaks, &breaks_start, &breaks_end);
+
+    // New glyphs (and paragraphs) are appended, then moved in place of the old ones
+    unsigned int glyph_count = layout->glyph_count;
+    unsigned int paragraph_count = layout->paragraph_count;
+    double pen_shift = 0;
+    bool shaped = incremental ? emojivur_layout_reshape(layout, buffer, &paragraph, delta, &start_glyph, &end_glyph,
+                                                        &pen_shift)
+                              : emojivur_layout_shape_paragraphs(layout, buffer, start, end + delta);
+    unsigned int glyphs_added = layout->glyph_count - glyph_count;
+    unsigned int paragraphs_added = layout->paragraph_count - paragraph_count;
+    for (unsigned int p = paragraph_count; p < layout->paragraph_count; ++p)
+    {
+        layout->paragraphs[p].first_glyph += start_glyph - glyph_count;
+    }
+    shaped = shaped &&
+             emojivur_layout_splice(layout, layout->glyphs, sizeof(emojivur_layout_glyph_t), glyph_count,
+                                    start_glyph, end_glyph - start_glyph, glyphs_added) &&
+             (!layout->glyph_fonts || emojivur_layout_splice(layout, layout->glyph_fonts, sizeof(uint8_t),
+                                                             glyph_count, start_glyph, end_glyph - start_glyph,
+                                                             glyphs_added)) &&
+             (incremental || emojivur_layout_splice(layout, layout->paragraphs, sizeof(emojivur_layout_paragraph_t),
+                                                    paragraph_count, first, last + 1 - first, paragraphs_added));
+    if (unlikely(!shaped))
+    {
+        emojivur_stats_stop(&timer);
+        return false;
+    }
+    int glyph_delta = (int)glyphs_added - (int)(end_glyph - start_glyph);
+    layout->glyph_count = glyph_count + glyph_delta;
+    layout->paragraph_count = incremental ? paragraph_count : paragraph_count - (last + 1 - first) + paragraphs_added;
+
+    // Glyphs and paragraphs after the edit keep their shape, moved by the change in the text
+    for (unsigned int i = start_glyph + glyphs_added; i < layout->glyph_count; ++i)
+    {
+        layout->glyphs[i].cluster += delta;
+    }
+    for (unsigned int p = first + (incremental ? 1 : paragraphs_added); p < layout->paragraph_count; ++p)
+    {
+        layout->paragraphs[p].first_glyph += glyph_delta;
+        layout->paragraphs[p].text_start += delta;
+        layout->paragraphs[p].text_end += delta;
+    }
+    unsigned int line_start = start_glyph;
+    if (incremental)
+    {
+        // The rest of the paragraph edited moves by the change in the advances too
+        emojivur_layout_paragraph_t *edited = &layout->paragraphs[first];
+        edited->glyph_count += glyph_delta;
+        edited->text_end += delta;
+        for (unsigned int i = start_glyph + glyphs_added; i < edited->first_glyph + edited->glyph_count; ++i)
+        {
+            layout->glyphs[i].pen_x += pen_shift;
+        }
+
+        // Glyphs shaped again, and those whose line break opportunity may have changed, are flagged again
+        unsigned int flag_start = MIN(start_glyph, emojivur_layout_glyph_at(layout, edited, breaks_start));
+        unsigned int flag_end = MAX(start_glyph + glyphs_added, emojivur_layout_glyph_at(layout, edited, breaks_end));
+        emojivur_layout_flag_breaks(layout, edited, flag_start, flag_end);
+
+        // A line is broken looking at its glyphs up to the first one overflowing it, which the next line holds:
+        // the lines before the one preceding the line of the glyph before the first one changed stay the same
+        line_start = edited->first_glyph;
+        if (flag_start > edited->first_glyph)
+        {
+            unsigned int line = emojivur_layout_glyph_line(layout, flag_start - 1);
+            *first_line = line > *first_line ? line - 1 : *first_line;
+            line_start = layout->lines[*first_line].first_glyph;
+        }
+    }
+    emojivur_stats_stop(&timer);
+
+    unsigned int end_paragraph = first + (incremental ? 1 : paragraphs_added);
+    if (unlikely(!emojivur_layout_rewrap(layout, first, end_paragraph, *first_line, line_start, glyph_delta)))
+    {
+        return false;
+    }
+    *end_line = end_paragraph < layout->paragraph_count ? layout->paragraphs[end_paragraph].first_line
+                                                        : layout->line_count;
+
+    return true;
+}
+
+/*!
+ * \brief Get the length of the text of a layout
+ *
+ * \param layout            Layout
+ *
+ * \return Length of the text in bytes
+ *
+ */
+size_t emojivur_layout_text_length(const emojivur_layout_t *layout)
+{
+    return layout->text_length;
+}
+
+/*!
+ * \brief Find where the cluster after an offset of the text of a layout starts
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ *
+ * \return Offset of the next cluster (or of the next paragraph, or the end of the text)
+ *
+ */
+size_t emojivur_layout_cluster_after(const emojivur_layout_t *layout, size_t offset)
+{
+    unsigned int p = emojivur_layout_paragraph_at(layout, offset);
+    const emojivur_layout_paragraph_t *paragraph = &layout->paragraphs[p];
+    if (offset < paragraph->text_end)
+    {
+        unsigned int glyph = emojivur_layout_glyph_at(layout, paragraph, offset + 1);
+        return glyph < paragraph->first_glyph + paragraph->glyph_count ? layout->glyphs[glyph].cluster
+                                                                       : paragraph->text_end;
+    }
+
+    return p + 1 < layout->paragraph_count ? layout->paragraphs[p + 1].text_start : layout->text_length;
+}
+
+/*!
+ * \brief Find where the cluster before an offset of the text of a layout starts
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ *
+ * \return Offset of the previous cluster (or of the end of the previous paragraph, or 0)
+ *
+ */
+size_t emojivur_layout_cluster_before(const emojivur_layout_t *layout, size_t offset)
+{
+    unsigned int p = emojivur_layout_paragraph_at(layout, offset);
+    const emojivur_layout_paragraph_t *paragraph = &layout->paragraphs[p];
+    if (offset > paragraph->text_end)
+    {
+        return paragraph->text_end;
+    }
+    if (offset > paragraph->text_start)
+    {
+        unsigned int glyph = emojivur_layout_glyph_at(layout, paragraph, offset);
+        return glyph > paragraph->first_glyph ? layout->glyphs[glyph - 1].cluster : paragraph->text_start;
+    }
+
+    return p > 0 ? layout->paragraphs[p - 1].text_end : 0;
+}
+
+/*!
+ * \brief Get the width of the widest line of a layout (hanging spaces excluded)
+ *
+ * \param layout            Layout
+ *
+ * \return Width of the widest line
+ *
+ */
+double emojivur_layout_width(const emojivur_layout_t *layout)
+{
+    return layout->width;
+}
+
+/*!
+ * \brief Get the number of lines of a layout
+ *
+ * \param layout            Layout
+ *
+ * \return Number of lines
+ *
+ */
+unsigned int emojivur_layout_line_count(const emojivur_layout_t *layout)
+{
+    return layout->line_count;
+}
+
+/*!
+ * \brief Get the first glyph of a line
+ *
+ * \param layout            Layout
+ * \param line              Line (clamped to the last one)
+ *
+ * \return Position of the glyph (the one of the next line for empty lines)
+ *
+ */
+unsigned int emojivur_layout_line_glyph(const emojivur_layout_t *layout, unsigned int line)
+{
+    return layout->lines[MIN(line, layout->line_count - 1)].first_glyph;
+}
+
+/*!
+ * \brief Get the line a glyph lies on
+ *
+ * \param layout            Layout
+ * \param glyph             Position of the glyph
+ *
+ * \return Line of the glyph
+ *
+ */
+unsigned int emojivur_layout_glyph_line(const emojivur_layout_t *layout, unsigned int glyph)
+{
+    // Last line starting at or before the glyph (empty lines come before the one sharing their first glyph)
+    unsigned int low = 0;
+    unsigned int high = layout->line_count;
+    while (high - low > 1)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (layout->lines[middle].first_glyph <= glyph)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*!
+ * \brief Get where a caret before an offset of the text of a layout is shown
+ *
+ * \param layout            Layout
+ * \param offset            Offset in the text
+ * \param first_baseline    Vertical position of the baseline of the first line
+ * \param x                 Horizontal position of the caret (output)
+ * \param baseline          Vertical position of the baseline of the line of the caret (output)
+ *
+ */
+void emojivur_layout_caret(const emojivur_layout_t *layout, size_t offset, double first_baseline, double *x,
+                           double *baseline)
+{
+    const emojivur_layout_paragraph_t *paragraph = &layout->paragraphs[emojivur_layout_paragraph_at(layout, offset)];
+    unsigned int paragraph_end = paragraph->first_glyph + paragraph->glyph_count;
+    unsigned int glyph = emojivur_layout_glyph_at(layout, paragraph, MIN(offset, paragraph->text_end));
+
+    // Before the glyph of the cluster at the offset, or past the last glyph of the paragraph
+    unsigned int line = paragraph->first_line;
+    double pen_x = 0;
+    if (glyph < paragraph_end)
+    {
+        line = emojivur_layout_glyph_line(layout, glyph);
+        pen_x = layout->glyphs[glyph].pen_x;
+    }
+    else if (paragraph->glyph_count > 0)
+    {
+        line = emojivur_layout_glyph_line(layout, paragraph_end - 1);
+        pen_x = emojivur_layout_paragraph_width(layout, paragraph);
+    }
+
+    const emojivur_layout_line_t *range = &layout->lines[line];
+    *x = pen_x - (range->glyph_count ? layout->glyphs[range->first_glyph].pen_x : 0);
+    *baseline = first_baseline + line * layout->line_height;
+}
+
+/*!
+ * \brief Position the glyphs of a layout line after line
+ *
+ * Glyphs are laid out just like a text shaped on one line from the origin, each line below the one before.
+ * Only the glyphs from a line on are positioned, so that those of the lines before an edit are left alone.
+ *
+ * \param layout            Layout
+ * \param first_line        First line whose glyphs are positioned
+ * \param first_baseline    Vertical position of the baseline of the first line of the layout
+ * \param glyphs            Vector of `emojivur_layout_glyph_count()` Cairo glyphs (output)
+ *
+ */
+void emojivur_layout_glyphs(const emojivur_layout_t *layout, unsigned int first_line, double first_baseline,
+                            cairo_glyph_t *glyphs)
+{
+    emojivur_stats_timer_t timer = emojivur_stats_start(EMOJIVUR_STAGE_GLYPHS);
+    for (unsigned int line = first_line; line < layout->line_count; ++line)
+    {
+        const emojivur_layout_line_t *range = &layout->lines[line];
+        double baseline = first_baseline + line * layout->line_height;
+        double line_start = range->glyph_count ? layout->glyphs[range->first_glyph].pen_x : 0;
+
+        for (unsigned int i = range->first_glyph; i < range->first_glyph + range->glyph_count; ++i)
+        {
+            const emojivur_layout_glyph_t *glyph = &layout->glyphs[i];
+            glyphs[i].index = glyph->index;
+            glyphs[i].x = glyph->pen_x - line_start + glyph->x_offset;
+            glyphs[i].y = baseline - glyph->y_offset;
+        }
+    }
+    emojivur_stats_stop(&timer);
+}
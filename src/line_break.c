@@ -0,0 +1,439 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       line_break.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Line break opportunities of a text (after Unicode UAX #14)
+//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "line_break.h"
+
+/*!
+ * \brief Line breaking classes of UAX #14 (the ones told apart)
+ *
+ */
+typedef enum
+{
+    LB_AL,  /**< Alphabetic (and everything else) */
+    LB_BK,  /**< Mandatory break */
+    LB_CR,  /**< Carriage return */
+    LB_LF,  /**< Line feed */
+    LB_NL,  /**< Next line */
+    LB_SP,  /**< Space */
+    LB_ZW,  /**< Zero width space */
+    LB_ZWJ, /**< Zero width joiner */
+    LB_CM,  /**< Combining mark (variation selectors, keycaps & tags included) */
+    LB_WJ,  /**< Word joiner */
+    LB_GL,  /**< Non-breaking glue */
+    LB_OP,  /**< Opening punctuation */
+    LB_CL,  /**< Closing punctuation */
+    LB_EX,  /**< Exclamation & interrogation (and infix/symbol separators acting alike) */
+    LB_HY,  /**< Hyphen */
+    LB_BA,  /**< Break after */
+    LB_NU,  /**< Numeric */
+    LB_ID,  /**< Ideographic (emojis included) */
+    LB_EM,  /**< Emoji modifier */
+    LB_RI,  /**< Regional indicator */
+} emojivur_lb_class_t;
+
+/*!
+ * \brief Decode the next character of a UTF-8 text
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param offset            Offset of the character (moved past it)
+ *
+ * \return Codepoint of the character (U+FFFD for malformed sequences, skipping one byte)
+ *
+ */
+uint32_t emojivur_utf8_next(const char *text, size_t text_length, size_t *offset)
+{
+    const unsigned char *bytes = (const unsigned char *)text + *offset;
+    size_t available = text_length - *offset;
+    unsigned int length = bytes[0] < 0x80 ? 1 : bytes[0] < 0xC2 ? 0 : bytes[0] < 0xE0 ? 2 : bytes[0] < 0xF0 ? 3
+                                                                 : bytes[0] < 0xF5 ? 4 : 0;
+    if (length == 0 || length > available)
+    {
+        *offset += 1;
+        return 0xFFFD;
+    }
+
+    uint32_t codepoint = length == 1 ? bytes[0] : bytes[0] & (0x7F >> length);
+    for (unsigned int i = 1; i < length; ++i)
+    {
+        if ((bytes[i] & 0xC0) != 0x80)
+        {
+            *offset += 1;
+            return 0xFFFD;
+        }
+        codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+    }
+    *offset += length;
+
+    return codepoint;
+}
+
+/*!
+ * \brief Get the line breaking class of a character
+ *
+ * \param codepoint         Codepoint of the character
+ *
+ * \return Line breaking class
+ *
+ */
+static emojivur_lb_class_t emojivur_lb_class(uint32_t codepoint)
+{
+    switch (codepoint)
+    {
+    case 0x0A:
+        return LB_LF;
+    case 0x0D:
+        return LB_CR;
+    case 0x0B:
+    case 0x0C:
+    case 0x2028:
+    case 0x2029:
+        return LB_BK;
+    case 0x85:
+        return LB_NL;
+    case 0x20:
+        return LB_SP;
+    case 0x200B:
+        return LB_ZW;
+    case 0x200D:
+        return LB_ZWJ;
+    case 0x2060:
+    case 0xFEFF:
+        return LB_WJ;
+    case 0xA0:
+    case 0x034F:
+    case 0x2007:
+    case 0x2011:
+    case 0x202F:
+        return LB_GL;
+    case '(':
+    case '[':
+    case '{':
+    case 0x00A1:
+    case 0x00BF:
+        return LB_OP;
+    case ')':
+    case ']':
+    case '}':
+        return LB_CL;
+    case '!':
+    case '?':
+    case ',':
+    case '.':
+    case ':':
+    case ';':
+    case '/':
+        return LB_EX;
+    case '-':
+        return LB_HY;
+    case 0x09:
+    case 0x2010:
+    case 0x2012:
+    case 0x2013:
+    case 0x3000:
+        return LB_BA;
+    default:
+        break;
+    }
+
+    if (codepoint >= '0' && codepoint <= '9')
+    {
+        return LB_NU;
+    }
+    if (codepoint < 0x20 || (codepoint >= 0x7F && codepoint < 0xA0) || codepoint == 0x200C ||
+        (codepoint >= 0x0300 && codepoint <= 0x036F) || (codepoint >= 0x1AB0 && codepoint <= 0x1AFF) ||
+        (codepoint >= 0x1DC0 && codepoint <= 0x1DFF) || (codepoint >= 0x20D0 && codepoint <= 0x20FF) ||
+        (codepoint >= 0xFE00 && codepoint <= 0xFE0F) || (codepoint >= 0xFE20 && codepoint <= 0xFE2F) ||
+        (codepoint >= 0xE0020 && codepoint <= 0xE007F) || (codepoint >= 0xE0100 && codepoint <= 0xE01EF))
+    {
+        return LB_CM;
+    }
+    if (codepoint >= 0x1F3FB && codepoint <= 0x1F3FF)
+    {
+        return LB_EM;
+    }
+    if (codepoint >= 0x1F1E6 && codepoint <= 0x1F1FF)
+    {
+        return LB_RI;
+    }
+
+    // Pictographs & dingbats (emojis) and CJK ideographs & syllables break on both sides
+    if ((codepoint >= 0x231A && codepoint <= 0x231B) || (codepoint >= 0x23E9 && codepoint <= 0x23FA) ||
+        (codepoint >= 0x2600 && codepoint <= 0x27BF) || (codepoint >= 0x2B00 && codepoint <= 0x2BFF) ||
+        (codepoint >= 0x2E80 && codepoint <= 0x2FFF) || (codepoint >= 0x3040 && codepoint <= 0x9FFF) ||
+        (codepoint >= 0xAC00 && codepoint <= 0xD7A3) || (codepoint >= 0xF900 && codepoint <= 0xFAFF) ||
+        (codepoint >= 0x1F000 && codepoint <= 0x1FAFF) || (codepoint >= 0x20000 && codepoint <= 0x3FFFD))
+    {
+        return LB_ID;
+    }
+
+    return LB_AL;
+}
+
+/*!
+ * \brief State of the line breaking algorithm between two characters
+ *
+ */
+typedef struct
+{
+    emojivur_lb_class_t before;        /**< Class of the last character not absorbed by LB9 */
+    emojivur_lb_class_t before_spaces; /**< Class of the last character before a run of spaces */
+    emojivur_lb_class_t last_raw;      /**< Class of the very last character */
+    unsigned int regional_indicators;  /**< Regional indicators in a row (flags are pairs of them) */
+} emojivur_lb_state_t;
+
+/*!
+ * \brief Check whether the state after a character depends on nothing but its class
+ *
+ * Spaces, combining marks, joiners and regional indicators carry over what comes before them:
+ * every other character leaves the state just as it would be at the start of a line.
+ *
+ * \param lb_class          Line breaking class of the character
+ *
+ * \return `true` if the line break opportunities after the character depend on nothing before it
+ *
+ */
+static inline bool emojivur_lb_settles(emojivur_lb_class_t lb_class)
+{
+    return lb_class != LB_SP && lb_class != LB_CM && lb_class != LB_ZWJ && lb_class != LB_RI;
+}
+
+/*!
+ * \brief Find the line break opportunity before the next character of a UTF-8 text
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param offset            Offset of the character (moved past it)
+ * \param breaks            Vector of `text_length` opportunities, one before each byte (output)
+ * \param state             State of the algorithm before the character (updated past it)
+ *
+ * \return Line breaking class of the character
+ *
+ */
+static emojivur_lb_class_t emojivur_line_break_next(const char *text, size_t text_length, size_t *offset,
+                                                    uint8_t *breaks, emojivur_lb_state_t *state)
+{
+    size_t start = *offset;
+    emojivur_lb_class_t raw = emojivur_lb_class(emojivur_utf8_next(text, text_length, offset));
+    emojivur_lb_class_t current = raw;
+    emojivur_lb_class_t before = state->before;
+    emojivur_lb_class_t before_spaces = state->before_spaces;
+    for (size_t i = start + 1; i < *offset; ++i)
+    {
+        breaks[i] = EMOJIVUR_BREAK_NONE;
+    }
+
+    emojivur_break_t opportunity = EMOJIVUR_BREAK_ALLOWED;
+    bool absorbed = false;
+    if (start == 0)
+    {
+        // LB2: never break at the start of text
+        opportunity = EMOJIVUR_BREAK_NONE;
+        if (current == LB_CM || current == LB_ZWJ)
+        {
+            current = LB_AL;
+        }
+    }
+    else if (before == LB_BK || before == LB_LF || before == LB_NL || (before == LB_CR && current != LB_LF))
+    {
+        // LB4 & LB5: always break after hard line breaks
+        opportunity = EMOJIVUR_BREAK_MANDATORY;
+        if (current == LB_CM || current == LB_ZWJ)
+        {
+            current = LB_AL;
+        }
+    }
+    else if (current == LB_BK || current == LB_CR || current == LB_LF || current == LB_NL ||
+             current == LB_SP || current == LB_ZW)
+    {
+        // LB6 & LB7: never break before hard line breaks, spaces or zero width spaces
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (before == LB_ZW || (before == LB_SP && before_spaces == LB_ZW))
+    {
+        // LB8: break after zero width spaces (spaces in between included)
+        opportunity = EMOJIVUR_BREAK_ALLOWED;
+        if (current == LB_CM || current == LB_ZWJ)
+        {
+            current = LB_AL;
+        }
+    }
+    else if (state->last_raw == LB_ZWJ)
+    {
+        // LB8a: never break after a zero width joiner (emoji ZWJ sequences)
+        opportunity = EMOJIVUR_BREAK_NONE;
+        absorbed = current == LB_CM || current == LB_ZWJ;
+    }
+    else if (current == LB_CM || current == LB_ZWJ)
+    {
+        // LB9 & LB10: combining marks take the class of their base (alphabetic when there is none)
+        opportunity = before == LB_SP ? EMOJIVUR_BREAK_ALLOWED : EMOJIVUR_BREAK_NONE;
+        absorbed = before != LB_SP;
+        current = absorbed ? current : LB_AL;
+    }
+    else if (current == LB_WJ || before == LB_WJ || before == LB_GL)
+    {
+        // LB11 & LB12: never break around word joiners or after glue
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (current == LB_GL && before != LB_SP && before != LB_BA && before != LB_HY)
+    {
+        // LB12a: never break before glue (unless after spaces & hyphens)
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (current == LB_CL || current == LB_EX)
+    {
+        // LB13: never break before closing punctuation & separators
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (before == LB_OP || (before == LB_SP && before_spaces == LB_OP))
+    {
+        // LB14: never break after opening punctuation (spaces in between included)
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (before == LB_SP)
+    {
+        // LB18: break after spaces
+        opportunity = EMOJIVUR_BREAK_ALLOWED;
+    }
+    else if (current == LB_BA || current == LB_HY)
+    {
+        // LB21: never break before hyphens
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if ((before == LB_AL || before == LB_NU) && (current == LB_AL || current == LB_NU || current == LB_OP))
+    {
+        // LB23, LB28 & LB30: never break inside words & numbers
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (before == LB_CL && (current == LB_AL || current == LB_NU))
+    {
+        // LB30: never break between closing punctuation and a following word
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if (before == LB_RI && current == LB_RI && state->regional_indicators % 2 == 1)
+    {
+        // LB30a: never break inside a flag (a pair of regional indicators)
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+    else if ((before == LB_ID || before == LB_EM) && current == LB_EM)
+    {
+        // LB30b: never break before emoji modifiers
+        opportunity = EMOJIVUR_BREAK_NONE;
+    }
+
+    // LB31: break everywhere else
+    breaks[start] = opportunity;
+
+    state->last_raw = current;
+    if (!absorbed)
+    {
+        state->regional_indicators = current == LB_RI ? state->regional_indicators + 1 : 0;
+        if (current != LB_SP)
+        {
+            state->before_spaces = current;
+        }
+        state->before = current;
+    }
+
+    return raw;
+}
+
+/*!
+ * \brief Find the line break opportunities of a UTF-8 text
+ *
+ * Follows the rules of UAX #14 (Unicode Line Breaking Algorithm) relevant to texts made
+ * of emojis, words and punctuation: characters are sorted into line breaking classes by
+ * a compact table of ranges rather than by the full Unicode Character Database.
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param breaks            Vector of `text_length` opportunities, one before each byte (output: bytes
+ *                          continuing a character get `EMOJIVUR_BREAK_NONE`)
+ *
+ */
+void emojivur_line_breaks(const char *text, size_t text_length, uint8_t *breaks)
+{
+    emojivur_lb_state_t state = {LB_BK, LB_BK, LB_BK, 0};
+    for (size_t offset = 0; offset < text_length;)
+    {
+        emojivur_line_break_next(text, text_length, &offset, breaks, &state);
+    }
+}
+
+/*!
+ * \brief Find again the line break opportunities of a UTF-8 text around a range of it which changed
+ *
+ * The opportunities elsewhere have to be the ones of the text before the change (moved with the text
+ * after the range). The algorithm starts again after the last character before the range leaving no
+ * state behind (see `emojivur_lb_settles()`), and stops after the first one past the range doing so:
+ * from there on the opportunities are the same as before.
+ *
+ * \param text              UTF-8 text
+ * \param text_length       Length of the text in bytes
+ * \param breaks            Vector of `text_length` opportunities, one before each byte (updated)
+ * \param start             Offset of the range (output: offset of the first opportunity found again)
+ * \param end               Offset of the end of the range (output: offset past the last opportunity found again)
+ *
+ */
+void emojivur_line_breaks_update(const char *text, size_t text_length, uint8_t *breaks, size_t *start, size_t *end)
+{
+    // Characters start at bytes not continuing a sequence, malformed ones included
+    emojivur_lb_state_t state = {LB_BK, LB_BK, LB_BK, 0};
+    size_t offset = 0;
+    for (size_t character = MIN(*start, text_length); character > 0; --character)
+    {
+        if (((unsigned char)text[character - 1] & 0xC0) == 0x80)
+        {
+            continue;
+        }
+        size_t next = character - 1;
+        emojivur_lb_class_t settled = emojivur_lb_class(emojivur_utf8_next(text, text_length, &next));
+        if (next <= *start && emojivur_lb_settles(settled))
+        {
+            state = (emojivur_lb_state_t){settled, settled, settled, 0};
+            offset = next;
+            break;
+        }
+    }
+
+    *start = offset;
+    while (offset < text_length)
+    {
+        size_t character = offset;
+        if (emojivur_lb_settles(emojivur_line_break_next(text, text_length, &offset, breaks, &state)) &&
+            character >= *end)
+        {
+            break;
+        }
+    }
+    *end = offset;
+}
@@ -0,0 +1,432 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       main.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Command line entry point of emojivur
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <math.h>
+
+#include <SDL2/SDL.h>
+
+#include <harfbuzz/hb.h>
+
+#include "config.h"
+#include "cli_options.h"
+#include "emojivur.h"
+#include "atlas.h"
+#include "batch.h"
+#include "chunked.h"
+#include "conformance.h"
+#include "server.h"
+#include "stats.h"
+
+/*!
+ * \brief Get the directory where rasterized glyphs are kept across runs by default
+ *
+ * \param buffer            Buffer to write the path of the directory to
+ * \param size              Size of the buffer
+ *
+ * \return `buffer`, NULL if no suitable directory is known
+ *
+ */
+char *emojivur_default_cache_directory(char *buffer, size_t size)
+{
+    const char *cache_home = getenv("XDG_CACHE_HOME");
+    if (cache_home && cache_home[0] == '/')
+    {
+        snprintf(buffer, size, "%s/%s", cache_home, APP_NAME);
+        return buffer;
+    }
+
+    const char *home = getenv("HOME");
+    if (home && home[0] == '/')
+    {
+        snprintf(buffer, size, "%s/.cache/%s", home, APP_NAME);
+        return buffer;
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief Choose the format of the file to export the result to
+ *
+ * \param cli_args_info     Command line options
+ *
+ * \return Format requested, otherwise the one matching the output file name extension (PDF by default)
+ *
+ */
+enum enum_format emojivur_output_format(struct gengetopt_args_info *cli_args_info)
+{
+    if (cli_args_info->format_given)
+    {
+        return cli_args_info->format_arg;
+    }
+
+    const char *extension = cli_args_info->output_arg ? strrchr(cli_args_info->output_arg, '.') : NULL;
+    if (extension && strcasecmp(extension, ".png") == 0)
+    {
+        return format_arg_png;
+    }
+
+    return format_arg_pdf;
+}
+
+//    __  __    _    ___ _   _
+//   |  \/  |  / \  |_ _| \ | |
+//   | |\/| | / _ \  | ||  \| |
+//   | |  | |/ ___ \ | || |\  |
+//   |_|  |_/_/   \_\___|_| \_|
+//
+//   #pragma MAIN
+
+int main(int argc, char *argv[])
+{
+    struct gengetopt_args_info cli_args_info;
+    if (unlikely(cmdline_parser(argc, argv, &cli_args_info) != 0))
+    {
+        return 1;
+    }
+
+    emojivur_verbose = cli_args_info.verbose_flag;
+    if (cli_args_info.stats_given)
+    {
+        emojivur_stats_report_at_exit(cli_args_info.stats_arg);
+    }
+
+    // Every size requested gets its own PDF page (or PNG image)
+    unsigned int pxsize_count = MAX(cli_args_info.pxsize_given, 1);
+    for (unsigned int i = 0; i < pxsize_count; ++i)
+    {
+        if (unlikely(cli_args_info.pxsize_arg[i] <= 0))
+        {
+            emojivur_exit(NULL, "Sizes in pixels must be greater than 0!", 1);
+        }
+    }
+    unsigned int pxsize = cli_args_info.pxsize_arg[0];
+
+    if (unlikely(cli_args_info.subset_flag &&
+                 (!cli_args_info.output_given || emojivur_output_format(&cli_args_info) != format_arg_pdf ||
+                  cli_args_info.serve_given || cli_args_info.connect_given || cli_args_info.atlas_given ||
+                  cli_args_info.conformance_given)))
+    {
+        emojivur_exit(NULL, "Fonts can only be subset exporting texts to a PDF document!", 1);
+    }
+    // Pages are held back until the document is complete: neither memory nor latency would stay bounded
+    if (unlikely(cli_args_info.subset_flag &&
+                 (cli_args_info.text_file_given || emojivur_output_fd(cli_args_info.output_arg) >= 0)))
+    {
+        emojivur_exit(NULL, "Fonts cannot be subset rendering a text file or streaming the PDF document!", 1);
+    }
+
+    if (cli_args_info.serve_given)
+    {
+        if (unlikely(!cli_args_info.font_given))
+        {
+            emojivur_exit(NULL, "At least one font is required to serve requests!", 1);
+        }
+        emojivur_server(cli_args_info.serve_arg, cli_args_info.font_arg, cli_args_info.font_given,
+                        (size_t)MAX(cli_args_info.glyph_cache_arg, 0) << 20,
+                        (size_t)MAX(cli_args_info.shape_cache_arg, 0) << 20);
+        return 0;
+    }
+
+    if (cli_args_info.connect_given)
+    {
+        if (unlikely(!cli_args_info.text_given))
+        {
+            emojivur_exit(NULL, "A text is required to send a request to the server!", 1);
+        }
+        emojivur_client_output(cli_args_info.connect_arg, emojivur_output_format(&cli_args_info),
+                               cli_args_info.font_id_arg, pxsize, cli_args_info.text_arg,
+                               cli_args_info.output_arg);
+        return 0;
+    }
+
+    if (unlikely(!cli_args_info.font_given ||
+                 (!cli_args_info.text_given && !cli_args_info.text_file_given && !cli_args_info.batch_given &&
+                  !cli_args_info.atlas_given && !cli_args_info.conformance_given)))
+    {
+        emojivur_exit(NULL, "A font and either a text, a text file, a batch file, an atlas index or an emoji test file "
+                            "are required!", 1);
+    }
+    if (unlikely(cli_args_info.atlas_given && pxsize_count > 1))
+    {
+        emojivur_exit(NULL, "An atlas can be rendered at one size only!", 1);
+    }
+    if (unlikely(cli_args_info.text_file_given && pxsize_count > 1))
+    {
+        emojivur_exit(NULL, "A text file can be rendered at one size only!", 1);
+    }
+    if (unlikely(cli_args_info.font_given > 1 && (!cli_args_info.text_given || pxsize_count > 1)))
+    {
+        emojivur_exit(NULL, "Fallback fonts can be used to render a single text at one size only!", 1);
+    }
+    if (unlikely(cli_args_info.width_given && (!cli_args_info.text_given || pxsize_count > 1)))
+    {
+        emojivur_exit(NULL, "Only a single text rendered at one size can be wrapped!", 1);
+    }
+    if (unlikely(cli_args_info.width_given && cli_args_info.width_arg <= 0))
+    {
+        emojivur_exit(NULL, "The width of the lines must be greater than 0!", 1);
+    }
+
+    int output_fd = cli_args_info.output_given ? emojivur_output_fd(cli_args_info.output_arg) : -1;
+    if (unlikely(output_fd == STDOUT_FILENO && emojivur_verbose))
+    {
+        emojivur_exit(NULL, "Details about the glyphs cannot be printed while writing to the standard output!", 1);
+    }
+    if (unlikely(output_fd >= 0 && (cli_args_info.batch_given || pxsize_count > 1) &&
+                 emojivur_output_format(&cli_args_info) == format_arg_png))
+    {
+        emojivur_exit(NULL, "Many PNG images can only be written to files!", 1);
+    }
+
+    // All pointers used are stored in this struct so that freeing them
+    // at any point is trivial and code remains DRYer
+    emojivur_shared_ptrs_t pshared = emojivur_shared_ptrs_default;
+
+    char font_filename[FILENAME_MAX];
+    unsigned int face_index;
+    if (unlikely(!emojivur_font_spec(cli_args_info.font_arg[0], font_filename, sizeof(font_filename), &face_index)))
+    {
+        emojivur_exit(NULL, "The file name of a font is too long!", 1);
+    }
+    emojivur_load_font(&pshared, font_filename, face_index);
+    hb_font_set_scale(pshared.harfbuzz_font, pxsize * 64, pxsize * 64);
+
+    if (cli_args_info.conformance_given)
+    {
+        unsigned long failures = emojivur_conformance_check(&pshared, cli_args_info.conformance_arg,
+                                                            cli_args_info.jobs_arg, stdout);
+        emojivur_cleanup(&pshared);
+
+        // Nothing gets rendered: the exit status tells whether the font passed the check
+        return failures ? 2 : 0;
+    }
+
+    if (cli_args_info.glyph_cache_arg > 0)
+    {
+        pshared.glyph_cache = emojivur_glyph_cache_create((size_t)cli_args_info.glyph_cache_arg << 20);
+        emojivur_ptr_valid_or_exit(&pshared, pshared.glyph_cache,
+                                   "An error occured during the glyph cache creation!", 1);
+
+        // Persisting glyphs is just an optimization: rendering goes on without it anyway
+        char cache_directory[FILENAME_MAX];
+        const char *glyph_cache_dir = cli_args_info.glyph_cache_dir_arg;
+        if (cli_args_info.glyph_cache_dir_given && !glyph_cache_dir)
+        {
+            glyph_cache_dir = emojivur_default_cache_directory(cache_directory, sizeof(cache_directory));
+        }
+        emojivur_font_id_t font_id;
+        if (glyph_cache_dir && emojivur_font_id(font_filename, pshared.harfbuzz_face, face_index, &font_id))
+        {
+            emojivur_glyph_cache_persist(pshared.glyph_cache, pshared.cairo_font_face, &font_id, glyph_cache_dir);
+        }
+    }
+
+    if (cli_args_info.shape_cache_arg > 0)
+    {
+        pshared.shape_cache = emojivur_shape_cache_create((size_t)cli_args_info.shape_cache_arg << 20);
+        emojivur_ptr_valid_or_exit(&pshared, pshared.shape_cache,
+                                   "An error occured during the shape cache creation!", 1);
+    }
+
+    // Create  HarfBuzz buffer
+    pshared.tmp_buffer = hb_buffer_create();
+    emojivur_ptr_valid_or_exit(&pshared, pshared.tmp_buffer,
+                               "An error occured during the HarfBuzz work Buffer creation!", 1);
+
+    if (cli_args_info.subset_flag)
+    {
+        // Pages are held back until the PDF document is complete and all the glyphs it shows are known
+        pshared.pdf_subset = emojivur_pdf_subset_create();
+        emojivur_ptr_valid_or_exit(&pshared, pshared.pdf_subset,
+                                   "Fonts cannot be subset (HarfBuzz was built without hb-subset)!", 1);
+    }
+
+    if (cli_args_info.atlas_given)
+    {
+        emojivur_atlas_output(&pshared, pxsize, emojivur_output_format(&cli_args_info), cli_args_info.jobs_arg,
+                              cli_args_info.output_arg, cli_args_info.atlas_arg);
+
+        // Just like batch mode: a PDF document (or PNG atlas) and no UI
+        return 0;
+    }
+
+    if (cli_args_info.text_file_given)
+    {
+        emojivur_chunked_output(&pshared, cli_args_info.text_file_arg, pxsize, emojivur_output_format(&cli_args_info),
+                                cli_args_info.output_arg);
+
+        // Pages are emitted as the text is read and no UI is provided
+        return 0;
+    }
+
+    if (cli_args_info.batch_given)
+    {
+        emojivur_batch_output(&pshared, cli_args_info.batch_arg, cli_args_info.pxsize_arg, pxsize_count,
+                              emojivur_output_format(&cli_args_info), cli_args_info.jobs_arg,
+                              cli_args_info.output_arg);
+
+        // Batch mode generates just a PDF document (or PNG images) and provides no UI
+        return 0;
+    }
+
+    if (cli_args_info.output_given && pxsize_count > 1)
+    {
+        emojivur_sizes_output(&pshared, cli_args_info.text_arg, cli_args_info.pxsize_arg, pxsize_count,
+                              emojivur_output_format(&cli_args_info), cli_args_info.output_arg);
+
+        // One PDF document (or one PNG image for each size) and no UI
+        return 0;
+    }
+
+    emoji_viewport_t text_size;
+    unsigned int glyph_count;
+    if (!cli_args_info.output_given || cli_args_info.width_given || cli_args_info.font_given > 1 ||
+        strpbrk(cli_args_info.text_arg, "\n\r\v\f"))
+    {
+        // Fonts after the first one back it up for the characters it does not cover (loaded only if needed)
+        pshared.font_chain = emojivur_font_chain_create(pshared.harfbuzz_font, pshared.cairo_font_face);
+        emojivur_ptr_valid_or_exit(&pshared, pshared.font_chain, "An error occured creating the chain of fonts!", 1);
+        for (unsigned int i = 1; i < cli_args_info.font_given; ++i)
+        {
+            if (unlikely(!emojivur_font_spec(cli_args_info.font_arg[i], font_filename, sizeof(font_filename),
+                                             &face_index) ||
+                         !emojivur_font_chain_add(pshared.font_chain, font_filename, face_index)))
+            {
+                emojivur_exit(&pshared, "A fallback font cannot be read (or too many fonts were given)!", 1);
+            }
+        }
+
+        // Texts on many lines are shaped once and broken in lines again whenever their width changes
+        pshared.layout = emojivur_layout_create(pshared.font_chain, pshared.tmp_buffer, cli_args_info.text_arg,
+                                                -1, pxsize);
+        emojivur_ptr_valid_or_exit(&pshared, pshared.layout, "An error occured during the layout of the text!", 1);
+        if (cli_args_info.width_given && unlikely(!emojivur_layout_wrap(pshared.layout, cli_args_info.width_arg)))
+        {
+            emojivur_exit(&pshared, "An error occured breaking the text in lines!", 1);
+        }
+
+        glyph_count = emojivur_layout_glyph_count(pshared.layout);
+        if (unlikely(!emojivur_glyphs_reserve(&pshared.cairo_glyphs, &pshared.cairo_glyphs_allocated, glyph_count)))
+        {
+            emojivur_exit(&pshared, "An error occured allocating the laid out glyphs!", 1);
+        }
+        // Lines are stacked above the last one, as `emojivur_page_layout()` expects of a text shaped on one line
+        double first_baseline = (1.0 - emojivur_layout_line_count(pshared.layout)) * pxsize;
+        emojivur_layout_glyphs(pshared.layout, 0, first_baseline, pshared.cairo_glyphs);
+        text_size.w = ceil(emojivur_layout_width(pshared.layout));
+        text_size.h = emojivur_layout_line_count(pshared.layout) * pxsize;
+
+        if (unlikely(emojivur_verbose))
+        {
+            printf("glyph count=%d\n", glyph_count);
+            printf("line count=%d\n", emojivur_layout_line_count(pshared.layout));
+            printf("text width=%d pixels\n", text_size.w);
+            printf("text height=%d pixels\n", text_size.h);
+        }
+    }
+    else
+    {
+        glyph_count = emojivur_shape_text(&pshared, cli_args_info.text_arg, -1, pxsize, &text_size);
+    }
+
+    emoji_to_render_t text_to_render =
+        {
+            .font_face = pshared.cairo_font_face,
+            .glyphs = pshared.cairo_glyphs,
+            .glyph_count = glyph_count,
+            .glyph_size = pxsize,
+        };
+    if (pshared.layout)
+    {
+        text_to_render.font_faces = emojivur_font_chain_cairo_font_faces(pshared.font_chain);
+        text_to_render.glyph_fonts = emojivur_layout_glyph_fonts(pshared.layout);
+    }
+
+    if (cli_args_info.output_given)
+    {
+        text_to_render.viewport = emojivur_page_layout(pshared.cairo_glyphs, glyph_count, text_size, pxsize);
+        if (emojivur_output_format(&cli_args_info) == format_arg_png)
+        {
+            emojivur_png_output(&pshared, text_to_render, cli_args_info.output_arg);
+        }
+        else
+        {
+            emojivur_pdf_output(&pshared, text_to_render, cli_args_info.output_arg);
+        }
+
+        // When generating a PDF or a PNG no UI is going to be provided
+        // therefore nothing beyond this point should be executed!
+        return 0;
+    }
+
+    // Initializing SDL2 makes sense only if not saving output to a file
+    if (unlikely(SDL_Init(SDL_INIT_VIDEO) != 0))
+    {
+        char sdl_error_msg[128];
+
+        snprintf(sdl_error_msg, 127, "SDL_Init failed: %s\n", SDL_GetError());
+        emojivur_exit(&pshared, sdl_error_msg, 1);
+    }
+
+    // Get info about the screen size
+    // TODO: What if there are more screens? Here checking only screen 0
+    SDL_DisplayMode dm;
+    if (unlikely(SDL_GetDesktopDisplayMode(0, &dm) != 0))
+    {
+        char sdl_error_msg[128];
+
+        snprintf(sdl_error_msg, 127, "SDL_GetDesktopDisplayMode failed: %s\n", SDL_GetError());
+        emojivur_exit(&pshared, sdl_error_msg, 1);
+    }
+
+    // Decide what the viewport size is going to be like
+    int margin_x = pxsize;
+    int margin_y = pxsize;
+    int max_width = MIN(text_size.w + margin_x, dm.w);
+    int width = MAX(MIN_WINDOW_WIDTH, max_width);
+    int max_height = MIN(text_size.h + margin_y, dm.h);
+    int height = MAX(MIN_WINDOW_HEIGHT, max_height);
+
+    // Move glyph to be at the center of the viewport
+    for (int i = 0; i < glyph_count; ++i)
+    {
+        pshared.cairo_glyphs[i].x += (width / 2) - (text_size.w / 2);
+        pshared.cairo_glyphs[i].y += (height / 2) + (margin_y / 2);
+    }
+
+    text_to_render.viewport = (emoji_viewport_t){width, height};
+
+    emojivur_gui(&pshared, text_to_render);
+
+    return 0;
+}
@@ -0,0 +1,388 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       pdf_subset.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Fonts of a PDF document cut down to the glyphs its pages show
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cairo/cairo.h>
+#include <cairo/cairo-ft.h>
+#include <harfbuzz/hb.h>
+#ifdef HAVE_HB_SUBSET
+#include <harfbuzz/hb-subset.h>
+#endif
+
+#include "config.h"
+#include "emojivur.h"
+#include "font_chain.h"
+#include "pdf_subset.h"
+
+#ifdef HAVE_HB_SUBSET
+// Tables only needed to shape text: pages show glyphs already shaped (and they would pull in more glyphs)
+static const hb_tag_t emojivur_pdf_subset_dropped_tables[] = {
+    HB_TAG('G', 'S', 'U', 'B'), HB_TAG('G', 'P', 'O', 'S'), HB_TAG('G', 'D', 'E', 'F'),
+    HB_TAG('k', 'e', 'r', 'n'), HB_TAG('m', 'o', 'r', 'x'), HB_TAG('k', 'e', 'r', 'x'),
+};
+#endif
+
+/*!
+ * \brief Page held back, its glyphs being stored by the document
+ *
+ */
+typedef struct
+{
+    unsigned int width;       /**< Width of the page */
+    unsigned int height;      /**< Height of the page */
+    unsigned int glyph_size;  /**< Size in pixels for the glyphs to render */
+    uint8_t font;             /**< Font the page starts with */
+    size_t first_glyph;       /**< Position of the first glyph of the page in the glyphs of the document */
+    unsigned int glyph_count; /**< Number of glyphs of the page */
+} emojivur_pdf_subset_entry_t;
+
+/*!
+ * \brief PDF document whose pages are held back until its fonts are subset
+ *
+ */
+struct emojivur_pdf_subset
+{
+    emojivur_pdf_subset_entry_t *pages;                       /**< Pages in document order */
+    unsigned int page_count;                                  /**< Number of pages */
+    unsigned int pages_allocated;                             /**< Number of pages that fit in `pages` */
+    cairo_glyph_t *glyphs;                                    /**< Glyphs of all pages */
+    uint8_t *glyph_fonts;                                     /**< Font of each glyph */
+    size_t glyph_count;                                       /**< Number of glyphs of all pages */
+    size_t glyphs_allocated;                                  /**< Number of glyphs that fit in the vectors */
+    cairo_font_face_t *font_faces[EMOJIVUR_FONT_CHAIN_MAX];   /**< Font faces shown by the pages (referenced) */
+    hb_set_t *font_glyphs[EMOJIVUR_FONT_CHAIN_MAX];           /**< Glyphs shown with each font */
+    cairo_font_face_t *subset_faces[EMOJIVUR_FONT_CHAIN_MAX]; /**< Subset of each font (NULL until built) */
+    unsigned int font_count;                                  /**< Number of fonts */
+};
+
+/*!
+ * \brief Create an empty PDF document waiting for pages
+ *
+ * \return The new document, NULL on failure (or if HarfBuzz was built without its subsetter)
+ *
+ */
+emojivur_pdf_subset_t *emojivur_pdf_subset_create(void)
+{
+#ifdef HAVE_HB_SUBSET
+    return calloc(1, sizeof(emojivur_pdf_subset_t));
+#else
+    return NULL;
+#endif
+}
+
+/*!
+ * \brief Find the position of a font face among the ones of the document, adding it if new
+ *
+ * \param subset            Document
+ * \param font_face         Font face
+ *
+ * \return Position of the font face, -1 if out of memory or if the document has too many fonts
+ *
+ */
+static int emojivur_pdf_subset_font(emojivur_pdf_subset_t *subset, cairo_font_face_t *font_face)
+{
+    for (unsigned int font = 0; font < subset->font_count; ++font)
+    {
+        if (subset->font_faces[font] == font_face)
+        {
+            return font;
+        }
+    }
+
+    if (unlikely(subset->font_count == EMOJIVUR_FONT_CHAIN_MAX))
+    {
+        return -1;
+    }
+    hb_set_t *glyphs = hb_set_create();
+    if (unlikely(!hb_set_allocation_successful(glyphs)))
+    {
+        hb_set_destroy(glyphs);
+        return -1;
+    }
+    subset->font_faces[subset->font_count] = cairo_font_face_reference(font_face);
+    subset->font_glyphs[subset->font_count] = glyphs;
+
+    return subset->font_count++;
+}
+
+/*!
+ * \brief Hold a page back taking note of the glyphs it shows with each font
+ *
+ * Glyphs are copied: the page is kept in memory until the document is complete.
+ *
+ * \param subset            Document to add the page to
+ * \param page              Page (with `font_faces` NULL if all glyphs use `font_face`)
+ *
+ * \return `true` on success, `false` if out of memory or showing too many fonts
+ *
+ */
+bool emojivur_pdf_subset_add_page(emojivur_pdf_subset_t *subset, emojivur_pdf_subset_page_t page)
+{
+    if (subset->page_count == subset->pages_allocated)
+    {
+        unsigned int pages_allocated = subset->pages_allocated ? subset->pages_allocated * 2 : 16;
+        emojivur_pdf_subset_entry_t *pages = realloc(subset->pages, pages_allocated * sizeof(*pages));
+        if (unlikely(!pages))
+        {
+            return false;
+        }
+        subset->pages = pages;
+        subset->pages_allocated = pages_allocated;
+    }
+
+    if (subset->glyph_count + page.glyph_count > subset->glyphs_allocated)
+    {
+        size_t glyphs_allocated = subset->glyphs_allocated ? subset->glyphs_allocated : 256;
+        while (glyphs_allocated < subset->glyph_count + page.glyph_count)
+        {
+            glyphs_allocated *= 2;
+        }
+        cairo_glyph_t *glyphs = realloc(subset->glyphs, glyphs_allocated * sizeof(*glyphs));
+        if (unlikely(!glyphs))
+        {
+            return false;
+        }
+        subset->glyphs = glyphs;
+        uint8_t *glyph_fonts = realloc(subset->glyph_fonts, glyphs_allocated);
+        if (unlikely(!glyph_fonts))
+        {
+            return false;
+        }
+        subset->glyph_fonts = glyph_fonts;
+        subset->glyphs_allocated = glyphs_allocated;
+    }
+
+    int page_font = emojivur_pdf_subset_font(subset, page.font_face);
+    if (unlikely(page_font < 0))
+    {
+        return false;
+    }
+
+    // Glyphs come in runs of the same font: look the font up only when it changes
+    cairo_font_face_t *last_face = page.font_face;
+    int font = page_font;
+    for (unsigned int i = 0; i < page.glyph_count; ++i)
+    {
+        cairo_font_face_t *font_face = page.font_faces ? page.font_faces[page.glyph_fonts[i]] : page.font_face;
+        if (font_face != last_face)
+        {
+            font = emojivur_pdf_subset_font(subset, font_face);
+            if (unlikely(font < 0))
+            {
+                return false;
+            }
+            last_face = font_face;
+        }
+        hb_set_add(subset->font_glyphs[font], page.glyphs[i].index);
+        subset->glyph_fonts[subset->glyph_count + i] = font;
+    }
+    for (unsigned int i = 0; i < subset->font_count; ++i)
+    {
+        if (unlikely(!hb_set_allocation_successful(subset->font_glyphs[i])))
+        {
+            return false;
+        }
+    }
+    memcpy(&subset->glyphs[subset->glyph_count], page.glyphs, page.glyph_count * sizeof(*page.glyphs));
+
+    subset->pages[subset->page_count++] = (emojivur_pdf_subset_entry_t){
+        .width = page.width,
+        .height = page.height,
+        .glyph_size = page.glyph_size,
+        .font = page_font,
+        .first_glyph = subset->glyph_count,
+        .glyph_count = page.glyph_count,
+    };
+    subset->glyph_count += page.glyph_count;
+
+    return true;
+}
+
+/*!
+ * \brief Subset a font to some of its glyphs
+ *
+ * \param font_face         Font face to subset
+ * \param glyphs            Glyphs to keep
+ *
+ * \return A new reference to the subset font face, or to `font_face` itself if it cannot be subset
+ *
+ */
+static cairo_font_face_t *emojivur_pdf_subset_font_face(cairo_font_face_t *font_face, const hb_set_t *glyphs)
+{
+#ifdef HAVE_HB_SUBSET
+    // Only fonts loaded by `emojivur_font_face_create()` give back the data of their font file
+    FT_Face ft_face = emojivur_font_face_ft_face(font_face);
+    if (unlikely(!ft_face))
+    {
+        return cairo_font_face_reference(font_face);
+    }
+
+    hb_blob_t *harfbuzz_blob = ft_face->generic.data;
+    hb_face_t *harfbuzz_face = hb_face_create(harfbuzz_blob, ft_face->face_index & 0xFFFF);
+    hb_face_t *subset_face = NULL;
+    hb_subset_input_t *input = hb_subset_input_create_or_fail();
+    if (likely(input))
+    {
+        hb_set_union(hb_subset_input_set(input, HB_SUBSET_SETS_GLYPH_INDEX), glyphs);
+        hb_set_t *dropped_tables = hb_subset_input_set(input, HB_SUBSET_SETS_DROP_TABLE_TAG);
+        for (size_t i = 0; i < sizeof(emojivur_pdf_subset_dropped_tables) / sizeof(hb_tag_t); ++i)
+        {
+            hb_set_add(dropped_tables, emojivur_pdf_subset_dropped_tables[i]);
+        }
+        // Glyphs are already shaped: their indices must stay the same in the subset font
+        hb_subset_input_set_flags(input, HB_SUBSET_FLAGS_RETAIN_GIDS);
+        subset_face = hb_subset_or_fail(harfbuzz_face, input);
+        hb_subset_input_destroy(input);
+    }
+    hb_face_destroy(harfbuzz_face);
+    if (unlikely(!subset_face))
+    {
+        return cairo_font_face_reference(font_face);
+    }
+
+    hb_blob_t *subset_blob = hb_face_reference_blob(subset_face);
+    hb_face_destroy(subset_face);
+    cairo_font_face_t *subset_font_face = emojivur_font_face_create(ft_face->glyph->library, subset_blob, 0);
+    if (unlikely(emojivur_verbose))
+    {
+        printf("font subset=%u glyphs, %u bytes out of %u\n", hb_set_get_population(glyphs),
+               hb_blob_get_length(subset_blob), hb_blob_get_length(harfbuzz_blob));
+    }
+    hb_blob_destroy(subset_blob);
+
+    return subset_font_face ? subset_font_face : cairo_font_face_reference(font_face);
+#else
+    return cairo_font_face_reference(font_face);
+#endif
+}
+
+/*!
+ * \brief Subset every font of the document to the glyphs of all its pages
+ *
+ * Each font gets a single subset shared by all pages, so that it is embedded in the PDF document only once.
+ * Glyph indices are retained and color tables (`CBDT`, `sbix`, `COLR`) are kept: pages are shown unchanged.
+ * Fonts which cannot be subset are embedded as they are.
+ *
+ * \param subset            Document
+ *
+ */
+void emojivur_pdf_subset_build(emojivur_pdf_subset_t *subset)
+{
+    for (unsigned int font = 0; font < subset->font_count; ++font)
+    {
+        if (!subset->subset_faces[font])
+        {
+            subset->subset_faces[font] = emojivur_pdf_subset_font_face(subset->font_faces[font],
+                                                                       subset->font_glyphs[font]);
+        }
+    }
+}
+
+/*!
+ * \brief Get the number of pages held back
+ *
+ * \param subset            Document
+ *
+ * \return Number of pages
+ *
+ */
+unsigned int emojivur_pdf_subset_page_count(const emojivur_pdf_subset_t *subset)
+{
+    return subset->page_count;
+}
+
+/*!
+ * \brief Get a page held back showing its glyphs with the subset fonts
+ *
+ * \param subset            Document (already built)
+ * \param page              Position of the page
+ *
+ * \return Page, valid until the document is cleared
+ *
+ */
+emojivur_pdf_subset_page_t emojivur_pdf_subset_page(const emojivur_pdf_subset_t *subset, unsigned int page)
+{
+    const emojivur_pdf_subset_entry_t *entry = &subset->pages[page];
+
+    return (emojivur_pdf_subset_page_t){
+        .width = entry->width,
+        .height = entry->height,
+        .glyph_size = entry->glyph_size,
+        .font_face = subset->subset_faces[entry->font],
+        .font_faces = subset->subset_faces,
+        .glyph_fonts = &subset->glyph_fonts[entry->first_glyph],
+        .glyphs = &subset->glyphs[entry->first_glyph],
+        .glyph_count = entry->glyph_count,
+    };
+}
+
+/*!
+ * \brief Drop pages and fonts making the document ready for the pages of the next one
+ *
+ * \param subset            Document
+ *
+ */
+void emojivur_pdf_subset_clear(emojivur_pdf_subset_t *subset)
+{
+    for (unsigned int font = 0; font < subset->font_count; ++font)
+    {
+        cairo_font_face_destroy(subset->font_faces[font]);
+        hb_set_destroy(subset->font_glyphs[font]);
+        if (subset->subset_faces[font])
+        {
+            cairo_font_face_destroy(subset->subset_faces[font]);
+            subset->subset_faces[font] = NULL;
+        }
+    }
+    subset->font_count = 0;
+    subset->page_count = 0;
+    subset->glyph_count = 0;
+}
+
+/*!
+ * \brief Destroy a document releasing its pages and fonts
+ *
+ * \param subset            Document to destroy (can be NULL)
+ *
+ */
+void emojivur_pdf_subset_destroy(emojivur_pdf_subset_t *subset)
+{
+    if (!subset)
+    {
+        return;
+    }
+
+    emojivur_pdf_subset_clear(subset);
+    free(subset->pages);
+    free(subset->glyphs);
+    free(subset->glyph_fonts);
+    free(subset);
+}
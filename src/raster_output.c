@@ -0,0 +1,501 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       raster_output.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Raster (PNG) output backend
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include <png.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#define EMOJIVUR_HAVE_SSE2
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define EMOJIVUR_HAVE_AVX2
+#endif
+#endif
+
+#include "config.h"
+#include "raster_output.h"
+
+/*!
+ * \brief Un-premultiply one color channel of a pixel
+ *
+ * Same rounding used by Cairo when writing PNG images: (c * 255 + a / 2) / a
+ * (clamped to 255 for pixels which are not correctly premultiplied).
+ *
+ * \param c                 Color channel value
+ * \param a                 Alpha value (not 0)
+ *
+ * \return Un-premultiplied color channel value
+ *
+ */
+static inline uint8_t emojivur_unpremultiply(uint32_t c, uint32_t a)
+{
+    uint32_t value = (c * 255 + a / 2) / a;
+    return value > 255 ? 255 : value;
+}
+
+/*!
+ * \brief Convert premultiplied ARGB32 pixels to straight alpha RGBA (portable version)
+ *
+ * \param pixels            Pixels to convert in place
+ * \param count             Number of pixels to convert
+ *
+ */
+static void emojivur_argb32_to_rgba_scalar(uint32_t *pixels, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t pixel = pixels[i];
+        uint8_t a = pixel >> 24;
+        uint8_t r = (pixel >> 16) & 0xff;
+        uint8_t g = (pixel >> 8) & 0xff;
+        uint8_t b = pixel & 0xff;
+
+        if (a == 0)
+        {
+            r = g = b = 0;
+        }
+        else if (a != 0xff)
+        {
+            r = emojivur_unpremultiply(r, a);
+            g = emojivur_unpremultiply(g, a);
+            b = emojivur_unpremultiply(b, a);
+        }
+
+        // Output is a sequence of bytes whatever the endianness is
+        uint8_t *rgba = (uint8_t *)&pixels[i];
+        rgba[0] = r;
+        rgba[1] = g;
+        rgba[2] = b;
+        rgba[3] = a;
+    }
+}
+
+#ifdef EMOJIVUR_HAVE_SSE2
+/*!
+ * \brief Un-premultiply one color channel of 4 pixels at once (SSE2 version)
+ *
+ * Divisions are carried out in single precision: numerators are below 2^16 and denominators
+ * below 2^8, so truncating the (correctly rounded) quotient gives the same result as the
+ * integer division used by `emojivur_unpremultiply()`.
+ *
+ * \param c                 Color channel values (one per 32 bits lane)
+ * \param half_a            Alpha values divided by 2
+ * \param a                 Alpha values as floats
+ * \param opaque_mask       0xff for lanes where alpha is not 0, 0 otherwise
+ *
+ * \return Un-premultiplied color channel values
+ *
+ */
+static inline __m128i emojivur_unpremultiply_sse2(__m128i c, __m128i half_a, __m128 a, __m128i opaque_mask)
+{
+    __m128i numerator = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(c, 8), c), half_a);
+    __m128 quotient = _mm_div_ps(_mm_cvtepi32_ps(numerator), a);
+
+    // Division by 0 gives NaN: MINPS returns its second operand then, masked out right after
+    quotient = _mm_min_ps(quotient, _mm_set1_ps(255.0f));
+    return _mm_and_si128(_mm_cvttps_epi32(quotient), opaque_mask);
+}
+
+/*!
+ * \brief Convert premultiplied ARGB32 pixels to straight alpha RGBA (SSE2 version)
+ *
+ * \param pixels            Pixels to convert in place
+ * \param count             Number of pixels to convert
+ *
+ */
+static void emojivur_argb32_to_rgba_sse2(uint32_t *pixels, size_t count)
+{
+    const __m128i mask_ff = _mm_set1_epi32(0xff);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i argb = _mm_loadu_si128((const __m128i *)&pixels[i]);
+        __m128i a = _mm_srli_epi32(argb, 24);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(argb, 16), mask_ff);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(argb, 8), mask_ff);
+        __m128i b = _mm_and_si128(argb, mask_ff);
+
+        __m128i half_a = _mm_srli_epi32(a, 1);
+        __m128 a_ps = _mm_cvtepi32_ps(a);
+        __m128i opaque_mask = _mm_andnot_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), mask_ff);
+
+        r = emojivur_unpremultiply_sse2(r, half_a, a_ps, opaque_mask);
+        g = emojivur_unpremultiply_sse2(g, half_a, a_ps, opaque_mask);
+        b = emojivur_unpremultiply_sse2(b, half_a, a_ps, opaque_mask);
+
+        __m128i rgba = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                    _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+        _mm_storeu_si128((__m128i *)&pixels[i], rgba);
+    }
+
+    emojivur_argb32_to_rgba_scalar(pixels + i, count - i);
+}
+#endif
+
+#ifdef EMOJIVUR_HAVE_AVX2
+/*!
+ * \brief Un-premultiply one color channel of 8 pixels at once (AVX2 version)
+ *
+ * \param c                 Color channel values (one per 32 bits lane)
+ * \param half_a            Alpha values divided by 2
+ * \param a                 Alpha values as floats
+ * \param opaque_mask       0xff for lanes where alpha is not 0, 0 otherwise
+ *
+ * \return Un-premultiplied color channel values
+ *
+ */
+__attribute__((target("avx2"))) static inline __m256i emojivur_unpremultiply_avx2(__m256i c, __m256i half_a,
+                                                                                   __m256 a, __m256i opaque_mask)
+{
+    __m256i numerator = _mm256_add_epi32(_mm256_sub_epi32(_mm256_slli_epi32(c, 8), c), half_a);
+    __m256 quotient = _mm256_div_ps(_mm256_cvtepi32_ps(numerator), a);
+
+    // Division by 0 gives NaN: VMINPS returns its second operand then, masked out right after
+    quotient = _mm256_min_ps(quotient, _mm256_set1_ps(255.0f));
+    return _mm256_and_si256(_mm256_cvttps_epi32(quotient), opaque_mask);
+}
+
+/*!
+ * \brief Convert premultiplied ARGB32 pixels to straight alpha RGBA (AVX2 version)
+ *
+ * \param pixels            Pixels to convert in place
+ * \param count             Number of pixels to convert
+ *
+ */
+__attribute__((target("avx2"))) static void emojivur_argb32_to_rgba_avx2(uint32_t *pixels, size_t count)
+{
+    const __m256i mask_ff = _mm256_set1_epi32(0xff);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i argb = _mm256_loadu_si256((const __m256i *)&pixels[i]);
+        __m256i a = _mm256_srli_epi32(argb, 24);
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(argb, 16), mask_ff);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(argb, 8), mask_ff);
+        __m256i b = _mm256_and_si256(argb, mask_ff);
+
+        __m256i half_a = _mm256_srli_epi32(a, 1);
+        __m256 a_ps = _mm256_cvtepi32_ps(a);
+        __m256i opaque_mask = _mm256_andnot_si256(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()), mask_ff);
+
+        r = emojivur_unpremultiply_avx2(r, half_a, a_ps, opaque_mask);
+        g = emojivur_unpremultiply_avx2(g, half_a, a_ps, opaque_mask);
+        b = emojivur_unpremultiply_avx2(b, half_a, a_ps, opaque_mask);
+
+        __m256i rgba = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                       _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+        _mm256_storeu_si256((__m256i *)&pixels[i], rgba);
+    }
+
+    // Leftovers are still enough for the SSE2 version to be worth it
+#ifdef EMOJIVUR_HAVE_SSE2
+    emojivur_argb32_to_rgba_sse2(pixels + i, count - i);
+#else
+    emojivur_argb32_to_rgba_scalar(pixels + i, count - i);
+#endif
+}
+#endif
+
+/*!
+ * \brief Convert Cairo premultiplied ARGB32 pixels to straight alpha RGBA bytes in place
+ *
+ * The fastest implementation supported by the CPU is picked at runtime.
+ *
+ * \param data              Pixels of a Cairo ARGB32 image
+ * \param width             Width of the image in pixels
+ * \param height            Height of the image in pixels
+ * \param stride            Number of bytes between the beginning of two consecutive rows
+ *
+ */
+void emojivur_argb32_to_rgba(unsigned char *data, int width, int height, int stride)
+{
+    void (*convert_row)(uint32_t *, size_t) = emojivur_argb32_to_rgba_scalar;
+#ifdef EMOJIVUR_HAVE_SSE2
+    convert_row = emojivur_argb32_to_rgba_sse2;
+#endif
+#ifdef EMOJIVUR_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        convert_row = emojivur_argb32_to_rgba_avx2;
+    }
+#endif
+
+    for (int y = 0; y < height; ++y)
+    {
+        convert_row((uint32_t *)(data + (size_t)y * stride), width);
+    }
+}
+
+// Alignment of the blocks carved out of the memory of the PNG encoder
+#define PNG_ARENA_ALIGNMENT 16
+
+/*!
+ * \brief Memory handed out to libpng (zlib included) while encoding an image
+ *
+ * Blocks are carved out of a single area and all given back at once when the image is done.
+ * Whatever does not fit is allocated on its own and makes the area grow for the next image,
+ * so that once warmed up images of the same size are encoded without any heap allocation.
+ *
+ */
+typedef struct
+{
+    unsigned char *data;    /**< Area the blocks are carved out of */
+    size_t size;            /**< Number of bytes in `data` */
+    size_t used;            /**< Number of bytes carved out of `data` for the image being encoded */
+    size_t overflow;        /**< Number of bytes allocated on their own for the image being encoded */
+} emojivur_png_arena_t;
+
+// Every thread encodes its images with its own memory
+static _Thread_local emojivur_png_arena_t emojivur_png_arena;
+
+/*!
+ * \brief Allocate memory for libpng out of the arena of the calling thread
+ *
+ * \param png               libpng write structure
+ * \param size              Number of bytes to allocate
+ *
+ * \return Memory allocated, NULL if out of memory
+ *
+ */
+static png_voidp emojivur_png_arena_malloc(png_structp png, png_alloc_size_t size)
+{
+    (void)png;
+
+    emojivur_png_arena_t *arena = &emojivur_png_arena;
+    size_t aligned = (size + PNG_ARENA_ALIGNMENT - 1) & ~(size_t)(PNG_ARENA_ALIGNMENT - 1);
+    if (likely(arena->data && aligned >= size && aligned <= arena->size - arena->used))
+    {
+        png_voidp block = arena->data + arena->used;
+        arena->used += aligned;
+        return block;
+    }
+
+    arena->overflow += aligned;
+    return malloc(size);
+}
+
+/*!
+ * \brief Release memory allocated by `emojivur_png_arena_malloc()`
+ *
+ * Blocks carved out of the arena are given back all at once by `emojivur_png_arena_reset()`.
+ *
+ * \param png               libpng write structure
+ * \param ptr               Memory to release
+ *
+ */
+static void emojivur_png_arena_free(png_structp png, png_voidp ptr)
+{
+    (void)png;
+
+    emojivur_png_arena_t *arena = &emojivur_png_arena;
+    if ((unsigned char *)ptr < arena->data || (unsigned char *)ptr >= arena->data + arena->size)
+    {
+        free(ptr);
+    }
+}
+
+/*!
+ * \brief Give back all the blocks of the arena of the calling thread once an image is done
+ *
+ * The arena grows to fit the whole image if some blocks had to be allocated on their own.
+ *
+ */
+static void emojivur_png_arena_reset(void)
+{
+    emojivur_png_arena_t *arena = &emojivur_png_arena;
+    if (arena->overflow > 0)
+    {
+        size_t size = arena->used + arena->overflow;
+        free(arena->data);
+        arena->data = (unsigned char *)malloc(size);
+        arena->size = arena->data ? size : 0;
+    }
+    arena->used = 0;
+    arena->overflow = 0;
+}
+
+/*!
+ * \brief Release the memory used to encode PNG images by the calling thread
+ *
+ */
+void emojivur_png_release(void)
+{
+    free(emojivur_png_arena.data);
+    emojivur_png_arena = (emojivur_png_arena_t){NULL, 0, 0, 0};
+}
+
+/*!
+ * \brief Destination of the bytes of a PNG image written through a callback
+ *
+ */
+typedef struct
+{
+    cairo_write_func_t write_func;  /**< Function the bytes get handed over to */
+    void *closure;                  /**< Closure passed to `write_func` */
+} emojivur_png_sink_t;
+
+/*!
+ * \brief Hand the bytes encoded by libpng over to a Cairo style write function
+ *
+ * \param png               libpng write structure
+ * \param data              Bytes to write
+ * \param length            Number of bytes to write
+ *
+ */
+static void emojivur_png_sink_write(png_structp png, png_bytep data, png_size_t length)
+{
+    emojivur_png_sink_t *sink = (emojivur_png_sink_t *)png_get_io_ptr(png);
+    if (unlikely(length > UINT_MAX
+                 || sink->write_func(sink->closure, data, (unsigned int)length) != CAIRO_STATUS_SUCCESS))
+    {
+        png_error(png, "write error");
+    }
+}
+
+/*!
+ * \brief Nothing to flush for a write function (required by libpng)
+ *
+ * \param png               libpng write structure
+ *
+ */
+static void emojivur_png_sink_flush(png_structp png)
+{
+    (void)png;
+}
+
+/*!
+ * \brief Encode a Cairo ARGB32 image surface as PNG image
+ *
+ * Pixels are converted in place and then handed over to libpng row by row
+ * so that no copy of the whole image is ever made. Once written, the surface
+ * does not contain valid Cairo pixels any more. libpng gets its memory from
+ * the arena of the calling thread.
+ *
+ * \param surface           Cairo ARGB32 image surface to write (its pixels get converted in place)
+ * \param png_file          File to write the PNG image to (`NULL` to use `sink`)
+ * \param sink              Write function to hand the PNG image over to (when `png_file` is `NULL`)
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+static bool emojivur_png_encode(cairo_surface_t *surface, FILE *png_file, emojivur_png_sink_t *sink)
+{
+    cairo_surface_flush(surface);
+
+    unsigned char *data = cairo_image_surface_get_data(surface);
+    int width = cairo_image_surface_get_width(surface);
+    int height = cairo_image_surface_get_height(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    if (unlikely(!data || cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32))
+    {
+        return false;
+    }
+
+    png_structp png = png_create_write_struct_2(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL,
+                                                NULL, emojivur_png_arena_malloc, emojivur_png_arena_free);
+    if (unlikely(!png))
+    {
+        emojivur_png_arena_reset();
+        return false;
+    }
+    png_infop png_info = png_create_info_struct(png);
+    if (unlikely(!png_info))
+    {
+        png_destroy_write_struct(&png, NULL);
+        emojivur_png_arena_reset();
+        return false;
+    }
+
+    // libpng reports errors jumping back here
+    if (setjmp(png_jmpbuf(png)))
+    {
+        png_destroy_write_struct(&png, &png_info);
+        emojivur_png_arena_reset();
+        return false;
+    }
+
+    if (png_file)
+    {
+        png_init_io(png, png_file);
+    }
+    else
+    {
+        png_set_write_fn(png, sink, emojivur_png_sink_write, emojivur_png_sink_flush);
+    }
+    png_set_IHDR(png, png_info, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, png_info);
+
+    emojivur_argb32_to_rgba(data, width, height, stride);
+    for (int y = 0; y < height; ++y)
+    {
+        png_write_row(png, data + (size_t)y * stride);
+    }
+
+    png_write_end(png, NULL);
+    png_destroy_write_struct(&png, &png_info);
+    emojivur_png_arena_reset();
+
+    return true;
+}
+
+/*!
+ * \brief Write a Cairo ARGB32 image surface as PNG image
+ *
+ * \param surface           Cairo ARGB32 image surface to write (its pixels get converted in place)
+ * \param png_file          File to write the PNG image to
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+bool emojivur_png_write(cairo_surface_t *surface, FILE *png_file)
+{
+    return emojivur_png_encode(surface, png_file, NULL);
+}
+
+/*!
+ * \brief Write a Cairo ARGB32 image surface as PNG image through a write function
+ *
+ * \param surface           Cairo ARGB32 image surface to write (its pixels get converted in place)
+ * \param write_func        Function the bytes of the PNG image are handed over to
+ * \param closure           Closure passed to `write_func`
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+bool emojivur_png_write_stream(cairo_surface_t *surface, cairo_write_func_t write_func, void *closure)
+{
+    emojivur_png_sink_t sink = {write_func, closure};
+    return emojivur_png_encode(surface, NULL, &sink);
+}
@@ -0,0 +1,685 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       server.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Render daemon serving requests over a Unix domain socket
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <harfbuzz/hb.h>
+#include <harfbuzz/hb-ot.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "emojivur.h"
+#include "raster_output.h"
+#include "stream.h"
+#include "server.h"
+
+// Longest request line accepted (text included)
+#define SERVER_MAX_REQUEST (64 * 1024)
+
+// Largest size in pixels accepted to render the glyphs
+#define SERVER_MAX_PXSIZE 1024
+
+// Largest width (or height) in pixels of a PNG image Cairo is able to create
+#define SERVER_MAX_IMAGE_SIZE 32767
+
+// Number of connections waiting to be accepted
+#define SERVER_BACKLOG 64
+
+// Largest number of connections served at the same time (each one by its own thread)
+#define SERVER_MAX_CONNECTIONS 64
+
+/*!
+ * \brief One client connected to the server
+ *
+ */
+typedef struct emojivur_server_connection_temp
+{
+    struct emojivur_server_connection_temp *next; /**< Next connection in the list of the active ones */
+    struct emojivur_server_temp *server;          /**< Server the connection belongs to */
+    int fd;                                       /**< Socket connected to the client */
+} emojivur_server_connection_t;
+
+/*!
+ * \brief State shared by the threads serving the connections
+ *
+ */
+typedef struct emojivur_server_temp
+{
+    pthread_mutex_t lock;                        /**< Lock protecting the fields below */
+    pthread_cond_t connection_closed;            /**< Signaled when a connection is closed */
+    emojivur_server_connection_t *connections;   /**< List of the active connections */
+    unsigned int connection_count;               /**< Number of active connections */
+    int wake_pipe[2];                            /**< Pipe waking the server up when a connection slot gets free */
+
+    // Read-only data shared by all connection threads
+    emojivur_shared_ptrs_t *fonts;               /**< Fonts loaded (HarfBuzz faces are immutable) */
+    unsigned int font_count;                     /**< Number of fonts loaded */
+    emojivur_glyph_cache_t *glyph_cache;         /**< Rasterized glyphs (NULL if disabled) */
+    emojivur_shape_cache_t *shape_cache;         /**< Shaped runs (NULL if disabled) */
+} emojivur_server_t;
+
+// Pipe written by the signal handler to wake the server up when it has to stop
+static int emojivur_server_stop_pipe[2] = {-1, -1};
+
+/*!
+ * \brief Ask the server to stop (signal handler)
+ *
+ * \param signal_number     Signal received
+ *
+ */
+static void emojivur_server_stop(int signal_number)
+{
+    int saved_errno = errno;
+    const char byte = (char)signal_number;
+    if (write(emojivur_server_stop_pipe[1], &byte, 1) < 0)
+    {
+        // Pipe already full: the server is stopping anyway
+    }
+    errno = saved_errno;
+}
+
+/*!
+ * \brief Send an error as response to a request
+ *
+ * \param fd                Socket connected to the client
+ * \param error_msg         Error message (on one line)
+ *
+ * \return `true` on success, `false` if the client cannot be reached any more
+ *
+ */
+static bool emojivur_server_error(int fd, const char *error_msg)
+{
+    char response[256];
+    int length = snprintf(response, sizeof(response), "ERROR %s\n", error_msg);
+    return emojivur_write_all(fd, response, MIN((size_t)length, sizeof(response) - 1));
+}
+
+/*!
+ * \brief Render one request and send the result to the client
+ *
+ * Rendering errors are answered with `ERROR <message>`: they never stop the server.
+ *
+ * \param connection        Connection the request came from
+ * \param thread_data       Buffers owned by the connection thread
+ * \param harfbuzz_fonts    HarfBuzz fonts owned by the connection thread (one for each font, created on first use)
+ * \param request           Request line (NUL terminated, without line terminator)
+ *
+ * \return `true` if the connection can go on, `false` if the client cannot be reached any more
+ *
+ */
+static bool emojivur_server_request(emojivur_server_connection_t *connection, emojivur_shared_ptrs_t *thread_data,
+                                    hb_font_t **harfbuzz_fonts, const char *request)
+{
+    emojivur_server_t *server = connection->server;
+
+    char format[8];
+    int font_id = -1;
+    unsigned int pxsize = 0;
+    int text_offset = -1;
+    if (sscanf(request, "%7s %d %u%n", format, &font_id, &pxsize, &text_offset) != 3 ||
+        request[text_offset] != ' ' || request[text_offset + 1] == '\0')
+    {
+        return emojivur_server_error(connection->fd, "expected: <pdf|png> <font id> <pxsize> <text>");
+    }
+    const char *text = request + text_offset + 1;
+
+    bool png = strcmp(format, "png") == 0;
+    if (!png && strcmp(format, "pdf") != 0)
+    {
+        return emojivur_server_error(connection->fd, "unknown format");
+    }
+    if (font_id < 0 || font_id >= (int)server->font_count)
+    {
+        return emojivur_server_error(connection->fd, "unknown font id");
+    }
+    if (pxsize == 0 || pxsize > SERVER_MAX_PXSIZE)
+    {
+        return emojivur_server_error(connection->fd, "pxsize out of range");
+    }
+
+    // Only fonts actually requested get their HarfBuzz font created
+    if (!harfbuzz_fonts[font_id])
+    {
+        harfbuzz_fonts[font_id] = hb_font_create(server->fonts[font_id].harfbuzz_face);
+        hb_ot_font_set_funcs(harfbuzz_fonts[font_id]);
+    }
+    hb_font_set_scale(harfbuzz_fonts[font_id], pxsize * 64, pxsize * 64);
+
+    thread_data->harfbuzz_font = harfbuzz_fonts[font_id];
+    emoji_viewport_t text_size;
+    unsigned int glyph_count = 0;
+    bool shaped = emojivur_try_shape_text(thread_data, text, -1, pxsize, &text_size, &glyph_count);
+    thread_data->harfbuzz_font = NULL;
+    if (unlikely(!shaped))
+    {
+        return emojivur_server_error(connection->fd, "an error occured shaping the text");
+    }
+
+    emoji_to_render_t emoji = {
+        .viewport = emojivur_page_layout(thread_data->cairo_glyphs, glyph_count, text_size, pxsize),
+        .font_face = server->fonts[font_id].cairo_font_face,
+        .glyphs = thread_data->cairo_glyphs,
+        .glyph_count = glyph_count,
+        .glyph_size = pxsize,
+    };
+
+    emojivur_stream_t output = emojivur_stream_default;
+    if (png)
+    {
+        if (emoji.viewport.w == 0 || emoji.viewport.w > SERVER_MAX_IMAGE_SIZE ||
+            emoji.viewport.h == 0 || emoji.viewport.h > SERVER_MAX_IMAGE_SIZE)
+        {
+            return emojivur_server_error(connection->fd, "image size out of range");
+        }
+
+        if (unlikely(!emojivur_try_image_render(thread_data, emoji)))
+        {
+            return emojivur_server_error(connection->fd, "an error occured rendering the PNG image");
+        }
+        bool png_written = emojivur_png_write_stream(thread_data->cairo_surface, emojivur_stream_write, &output);
+        emojivur_image_recycle(thread_data);
+        if (unlikely(!png_written))
+        {
+            emojivur_stream_free(&output);
+            return emojivur_server_error(connection->fd, "an error occured writing the PNG image");
+        }
+    }
+    else
+    {
+        if (unlikely(!emojivur_try_pdf_open_stream(thread_data, emoji.viewport, emojivur_stream_write, &output)))
+        {
+            emojivur_stream_free(&output);
+            return emojivur_server_error(connection->fd, "an error occured creating the PDF document");
+        }
+
+        // The document is closed (releasing Cairo Surface & Context) even if the page could not be added
+        bool pdf_written = emojivur_try_pdf_page(thread_data, emoji);
+        pdf_written = emojivur_try_pdf_close(thread_data) && pdf_written;
+        if (unlikely(!pdf_written))
+        {
+            emojivur_stream_free(&output);
+            return emojivur_server_error(connection->fd, "an error occured writing the PDF document");
+        }
+    }
+
+    char header[32];
+    int header_length = snprintf(header, sizeof(header), "OK %zu\n", output.length);
+    bool sent = emojivur_write_all(connection->fd, header, header_length) &&
+                emojivur_write_all(connection->fd, output.data, output.length);
+    emojivur_stream_free(&output);
+
+    return sent;
+}
+
+/*!
+ * \brief Body of the thread serving a connection
+ *
+ * Every thread owns its HarfBuzz fonts & buffer and its Cairo surface & context,
+ * while HarfBuzz faces, Cairo font faces, rasterized glyphs and shaped runs are shared.
+ *
+ * \param arg               Connection to serve
+ *
+ * \return Always NULL
+ *
+ */
+static void *emojivur_server_connection_thread(void *arg)
+{
+    emojivur_server_connection_t *connection = (emojivur_server_connection_t *)arg;
+    emojivur_server_t *server = connection->server;
+
+    emojivur_shared_ptrs_t thread_data = emojivur_shared_ptrs_default;
+    thread_data.tmp_buffer = hb_buffer_create();
+    thread_data.glyph_cache = emojivur_glyph_cache_reference(server->glyph_cache);
+    thread_data.shape_cache = emojivur_shape_cache_reference(server->shape_cache);
+    hb_font_t **harfbuzz_fonts = (hb_font_t **)calloc(server->font_count, sizeof(hb_font_t *));
+    char *request = (char *)malloc(SERVER_MAX_REQUEST);
+
+    size_t filled = 0;
+    bool serving = harfbuzz_fonts && request;
+    while (serving)
+    {
+        char *line_end = (char *)memchr(request, '\n', filled);
+        if (!line_end)
+        {
+            if (filled == SERVER_MAX_REQUEST)
+            {
+                emojivur_server_error(connection->fd, "request too long");
+                break;
+            }
+
+            ssize_t received = read(connection->fd, request + filled, SERVER_MAX_REQUEST - filled);
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            serving = received > 0;
+            filled += MAX(received, 0);
+            continue;
+        }
+
+        // Strip line terminators (DOS line endings included)
+        size_t line_length = line_end - request;
+        *line_end = '\0';
+        if (line_length > 0 && request[line_length - 1] == '\r')
+        {
+            request[line_length - 1] = '\0';
+        }
+
+        serving = emojivur_server_request(connection, &thread_data, harfbuzz_fonts, request);
+
+        filled -= line_length + 1;
+        memmove(request, line_end + 1, filled);
+    }
+
+    free(request);
+    if (harfbuzz_fonts)
+    {
+        for (unsigned int i = 0; i < server->font_count; ++i)
+        {
+            hb_font_destroy(harfbuzz_fonts[i]);
+        }
+        free(harfbuzz_fonts);
+    }
+    emojivur_release(&thread_data);
+
+    // Once out of the list the socket cannot be shut down by the server any more
+    pthread_mutex_lock(&server->lock);
+    emojivur_server_connection_t **link = &server->connections;
+    while (*link != connection)
+    {
+        link = &(*link)->next;
+    }
+    *link = connection->next;
+    // The server stops accepting connections when all slots are taken: one just got free
+    if (server->connection_count-- == SERVER_MAX_CONNECTIONS)
+    {
+        if (write(server->wake_pipe[1], "", 1) < 0)
+        {
+            // Pipe already full: the server is going to be woken up anyway
+        }
+    }
+    pthread_cond_signal(&server->connection_closed);
+    pthread_mutex_unlock(&server->lock);
+
+    close(connection->fd);
+    free(connection);
+
+    return NULL;
+}
+
+/*!
+ * \brief Create the Unix domain socket the server listens on
+ *
+ * A socket left behind by a server no longer running is replaced.
+ *
+ * \param socket_path       Path of the Unix domain socket to listen on
+ *
+ * \return Socket listening, -1 on failure
+ *
+ */
+static int emojivur_server_listen(const char *socket_path)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    struct stat socket_stat;
+    if (lstat(socket_path, &socket_stat) == 0 && S_ISSOCK(socket_stat.st_mode))
+    {
+        int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe_fd >= 0 && connect(probe_fd, (struct sockaddr *)&address, sizeof(address)) != 0 &&
+            errno == ECONNREFUSED)
+        {
+            unlink(socket_path);
+        }
+        if (probe_fd >= 0)
+        {
+            close(probe_fd);
+        }
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        return -1;
+    }
+    if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listen_fd, SERVER_BACKLOG) != 0)
+    {
+        int saved_errno = errno;
+        close(listen_fd);
+        errno = saved_errno;
+        return -1;
+    }
+
+    return listen_fd;
+}
+
+/*!
+ * \brief Keep fonts loaded and render the texts requested by clients over a Unix domain socket
+ *
+ * Every connection is served by its own thread and can send any number of requests, one per line
+ * (up to `SERVER_MAX_CONNECTIONS` at the same time, further clients wait to be accepted):
+ *
+ *     <pdf|png> <font id> <pxsize> <text>\n
+ *
+ * where the font id is the position of the font in `font_filenames`. Each request is answered with
+ * `OK <length>\n` followed by `length` bytes of PDF document (or PNG image), or with `ERROR <message>\n`.
+ * The server runs until it gets SIGINT or SIGTERM.
+ *
+ * \param socket_path       Path of the Unix domain socket to listen on
+ * \param font_filenames    File names of the fonts to load (`FILENAME:N` loads the face N of a collection)
+ * \param font_count        Number of fonts to load
+ * \param glyph_cache_size  Memory in bytes used to cache the rasterized glyphs (0 to disable the cache)
+ * \param shape_cache_size  Memory in bytes used to cache the shaped runs (0 to disable the cache)
+ *
+ */
+void emojivur_server(const char *socket_path, char **font_filenames, unsigned int font_count,
+                     size_t glyph_cache_size, size_t shape_cache_size)
+{
+    emojivur_server_t server = {
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+        .connection_closed = PTHREAD_COND_INITIALIZER,
+        .font_count = font_count,
+    };
+
+    // Fonts are loaded once and shared by all the connections
+    server.fonts = (emojivur_shared_ptrs_t *)malloc(font_count * sizeof(emojivur_shared_ptrs_t));
+    emojivur_ptr_valid_or_exit(NULL, server.fonts, "An error occured allocating the server fonts!", 1);
+    for (unsigned int i = 0; i < font_count; ++i)
+    {
+        char font_filename[FILENAME_MAX];
+        unsigned int face_index;
+        if (unlikely(!emojivur_font_spec(font_filenames[i], font_filename, sizeof(font_filename), &face_index)))
+        {
+            emojivur_exit(NULL, "The file name of a font is too long!", 1);
+        }
+        server.fonts[i] = emojivur_shared_ptrs_default;
+        emojivur_load_font(&server.fonts[i], font_filename, face_index);
+        hb_face_make_immutable(server.fonts[i].harfbuzz_face);
+    }
+    if (glyph_cache_size > 0)
+    {
+        server.glyph_cache = emojivur_glyph_cache_create(glyph_cache_size);
+        emojivur_ptr_valid_or_exit(NULL, server.glyph_cache,
+                                   "An error occured during the glyph cache creation!", 1);
+    }
+    if (shape_cache_size > 0)
+    {
+        server.shape_cache = emojivur_shape_cache_create(shape_cache_size);
+        emojivur_ptr_valid_or_exit(NULL, server.shape_cache,
+                                   "An error occured during the shape cache creation!", 1);
+    }
+
+    if (unlikely(pipe(emojivur_server_stop_pipe) != 0))
+    {
+        emojivur_exit(NULL, "An error occured creating the server stop pipe!", 1);
+    }
+    if (unlikely(pipe(server.wake_pipe) != 0 || fcntl(server.wake_pipe[0], F_SETFL, O_NONBLOCK) != 0 ||
+                 fcntl(server.wake_pipe[1], F_SETFL, O_NONBLOCK) != 0))
+    {
+        emojivur_exit(NULL, "An error occured creating the server wake up pipe!", 1);
+    }
+    struct sigaction stop_action = {.sa_handler = emojivur_server_stop};
+    sigemptyset(&stop_action.sa_mask);
+    sigaction(SIGINT, &stop_action, NULL);
+    sigaction(SIGTERM, &stop_action, NULL);
+
+    // Clients going away must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = emojivur_server_listen(socket_path);
+    if (unlikely(listen_fd < 0))
+    {
+        char error_msg[FILENAME_MAX + 64];
+        snprintf(error_msg, sizeof(error_msg), "An error occured listening on %s: %s", socket_path, strerror(errno));
+        emojivur_exit(NULL, error_msg, 1);
+    }
+
+    // Signals are handled by this thread only: connection threads start with them blocked
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+
+    struct pollfd poll_fds[3] = {
+        {.fd = listen_fd, .events = POLLIN},
+        {.fd = emojivur_server_stop_pipe[0], .events = POLLIN},
+        {.fd = server.wake_pipe[0], .events = POLLIN},
+    };
+    while (true)
+    {
+        // With all slots taken new clients are left in the backlog until a connection closes
+        pthread_mutex_lock(&server.lock);
+        poll_fds[0].events = server.connection_count < SERVER_MAX_CONNECTIONS ? POLLIN : 0;
+        pthread_mutex_unlock(&server.lock);
+
+        if (poll(poll_fds, 3, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (poll_fds[1].revents)
+        {
+            break;
+        }
+        if (poll_fds[2].revents)
+        {
+            char wake_bytes[64];
+            while (read(server.wake_pipe[0], wake_bytes, sizeof(wake_bytes)) > 0)
+            {
+                // Nothing to do but waking up
+            }
+        }
+        if (!(poll_fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            continue;
+        }
+        emojivur_server_connection_t *connection =
+            (emojivur_server_connection_t *)malloc(sizeof(emojivur_server_connection_t));
+        if (unlikely(!connection))
+        {
+            close(fd);
+            continue;
+        }
+        connection->server = &server;
+        connection->fd = fd;
+
+        pthread_mutex_lock(&server.lock);
+        connection->next = server.connections;
+        server.connections = connection;
+        ++server.connection_count;
+        pthread_mutex_unlock(&server.lock);
+
+        sigset_t previous_signals;
+        pthread_sigmask(SIG_BLOCK, &stop_signals, &previous_signals);
+        pthread_attr_t thread_attr;
+        pthread_attr_init(&thread_attr);
+        pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+        pthread_t thread;
+        int started = pthread_create(&thread, &thread_attr, emojivur_server_connection_thread, connection);
+        pthread_attr_destroy(&thread_attr);
+        pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+
+        if (unlikely(started != 0))
+        {
+            pthread_mutex_lock(&server.lock);
+            server.connections = connection->next;
+            --server.connection_count;
+            pthread_mutex_unlock(&server.lock);
+            close(fd);
+            free(connection);
+        }
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+
+    // Wake up the connection threads waiting for requests and wait for them to be done
+    pthread_mutex_lock(&server.lock);
+    for (emojivur_server_connection_t *connection = server.connections; connection; connection = connection->next)
+    {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    while (server.connection_count > 0)
+    {
+        pthread_cond_wait(&server.connection_closed, &server.lock);
+    }
+    pthread_mutex_unlock(&server.lock);
+
+    emojivur_glyph_cache_destroy(server.glyph_cache);
+    emojivur_shape_cache_destroy(server.shape_cache);
+    for (unsigned int i = 0; i < font_count; ++i)
+    {
+        emojivur_release(&server.fonts[i]);
+    }
+    free(server.fonts);
+    close(emojivur_server_stop_pipe[0]);
+    close(emojivur_server_stop_pipe[1]);
+    close(server.wake_pipe[0]);
+    close(server.wake_pipe[1]);
+}
+
+/*!
+ * \brief Ask a render daemon to render a text and write the result to a file
+ *
+ * \param socket_path       Path of the Unix domain socket the server listens on
+ * \param format            Format of the output
+ * \param font_id           Position of the font to use in the list loaded by the server
+ * \param pxsize            Size in pixels used to render the glyphs
+ * \param text              UTF-8 text to render (on one line)
+ * \param output_filename   File name for the PDF (or PNG) to create (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ */
+void emojivur_client_output(const char *socket_path, enum enum_format format, int font_id,
+                            unsigned int pxsize, const char *text, const char *output_filename)
+{
+    if (unlikely(strpbrk(text, "\r\n")))
+    {
+        emojivur_exit(NULL, "The text to render must fit on one line!", 1);
+    }
+
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (unlikely(strlen(socket_path) >= sizeof(address.sun_path)))
+    {
+        emojivur_exit(NULL, "The path of the server socket is too long!", 1);
+    }
+    strcpy(address.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (unlikely(fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0))
+    {
+        emojivur_exit(NULL, "An error occured connecting to the server!", 1);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    char header[64];
+    int header_length = snprintf(header, sizeof(header), "%s %d %u ",
+                                 format == format_arg_png ? "png" : "pdf", font_id, pxsize);
+    if (unlikely(!emojivur_write_all(fd, header, header_length) ||
+                 !emojivur_write_all(fd, text, strlen(text)) ||
+                 !emojivur_write_all(fd, "\n", 1)))
+    {
+        emojivur_exit(NULL, "An error occured sending the request to the server!", 1);
+    }
+
+    FILE *response = fdopen(fd, "r");
+    emojivur_ptr_valid_or_exit(NULL, response, "An error occured reading the response of the server!", 1);
+
+    char status[256];
+    size_t length = 0;
+    if (unlikely(!fgets(status, sizeof(status), response)))
+    {
+        emojivur_exit(NULL, "The server closed the connection!", 1);
+    }
+    if (unlikely(sscanf(status, "OK %zu", &length) != 1))
+    {
+        char error_msg[300];
+        status[strcspn(status, "\n")] = '\0';
+        snprintf(error_msg, sizeof(error_msg), "The server refused the request: %s",
+                 strncmp(status, "ERROR ", 6) == 0 ? status + 6 : status);
+        emojivur_exit(NULL, error_msg, 1);
+    }
+
+    int output_fd = emojivur_output_fd(output_filename);
+    bool output_opened = output_fd < 0;
+    if (output_opened)
+    {
+        output_fd = open(output_filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (unlikely(output_fd < 0))
+        {
+            emojivur_exit(NULL, "An error occured opening the output file for writing!", 1);
+        }
+    }
+
+    char chunk[64 * 1024];
+    while (length > 0)
+    {
+        size_t received = fread(chunk, 1, MIN(length, sizeof(chunk)), response);
+        if (unlikely(received == 0))
+        {
+            emojivur_exit(NULL, "The server closed the connection before sending the whole output!", 1);
+        }
+        if (unlikely(!emojivur_write_all(output_fd, chunk, received)))
+        {
+            emojivur_exit(NULL, "An error occured writing the output file!", 1);
+        }
+        length -= received;
+    }
+
+    fclose(response);
+    if (unlikely(output_opened && close(output_fd) != 0))
+    {
+        emojivur_exit(NULL, "An error occured writing the output file!", 1);
+    }
+}
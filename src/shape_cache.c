@@ -0,0 +1,442 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       shape_cache.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      LRU cache of shaped runs of text
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <harfbuzz/hb.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "shape_cache.h"
+#include "stats.h"
+
+// Number of hash buckets the cache starts with (always a power of 2)
+#define SHAPE_CACHE_MIN_BUCKETS 256
+
+/*!
+ * \brief A run of text shaped into positioned glyphs
+ *
+ * Entries are chained in their hash bucket and in the LRU list at the same time. Glyphs and
+ * text are stored right after the entry, in the same allocation.
+ *
+ */
+typedef struct emojivur_shape_entry
+{
+    emojivur_shape_key_t key;           /**< What the run has been shaped from (face referenced, text owned) */
+    size_t hash;                        /**< Hash of the key */
+    cairo_glyph_t *glyphs;              /**< Cairo glyphs laid out from the origin */
+    unsigned int glyph_count;           /**< Number of Cairo glyphs */
+    unsigned int text_width;            /**< Width in pixels of the shaped text */
+    unsigned int text_height;           /**< Height in pixels of the shaped text */
+    size_t bytes;                       /**< Memory accounted for the entry */
+    struct emojivur_shape_entry *next_in_bucket;
+    struct emojivur_shape_entry *newer; /**< Entry used right after this one */
+    struct emojivur_shape_entry *older; /**< Entry used right before this one */
+} emojivur_shape_entry_t;
+
+struct emojivur_shape_cache
+{
+    pthread_mutex_t lock;               /**< Lock protecting the fields below */
+    int references;                     /**< Reference count */
+    emojivur_shape_entry_t **buckets;   /**< Hash table of the entries */
+    size_t bucket_count;                /**< Number of hash buckets */
+    size_t entry_count;                 /**< Number of entries cached */
+    emojivur_shape_entry_t *newest;     /**< Most recently used entry */
+    emojivur_shape_entry_t *oldest;     /**< Least recently used entry (the first evicted) */
+    size_t bytes;                       /**< Memory used by the entries */
+    size_t max_bytes;                   /**< Memory the entries can use at most */
+};
+
+/*!
+ * \brief Hash a key (FNV-1a over the text, then mixing in everything else)
+ *
+ * \param key               Key to hash
+ *
+ * \return Hash of the key
+ *
+ */
+static size_t emojivur_shape_hash(const emojivur_shape_key_t *key)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < key->text_length; ++i)
+    {
+        hash = (hash ^ (unsigned char)key->text[i]) * 0x100000001B3ull;
+    }
+
+    hash = (hash ^ (uintptr_t)key->face) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ (uint32_t)key->x_scale ^ ((uint64_t)(uint32_t)key->y_scale << 32)) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ key->pxsize ^ ((uint64_t)key->direction << 32)) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ (uint32_t)key->script ^ (uintptr_t)key->language) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 32);
+}
+
+/*!
+ * \brief Compare two keys
+ *
+ * \param a                 First key
+ * \param b                 Second key
+ *
+ * \return `true` if the keys are the same
+ *
+ */
+static inline bool emojivur_shape_key_equal(const emojivur_shape_key_t *a, const emojivur_shape_key_t *b)
+{
+    return a->face == b->face && a->x_scale == b->x_scale && a->y_scale == b->y_scale &&
+           a->pxsize == b->pxsize && a->direction == b->direction && a->script == b->script &&
+           a->language == b->language && a->text_length == b->text_length &&
+           memcmp(a->text, b->text, a->text_length) == 0;
+}
+
+/*!
+ * \brief Move an entry to the most recently used end of the LRU list
+ *
+ * \param cache             Cache the entry belongs to (locked)
+ * \param entry             Entry just used (or just created)
+ *
+ */
+static void emojivur_shape_cache_touch(emojivur_shape_cache_t *cache, emojivur_shape_entry_t *entry)
+{
+    if (cache->newest == entry)
+    {
+        return;
+    }
+
+    // Unlink (if linked at all)
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    if (cache->oldest == entry)
+    {
+        cache->oldest = entry->newer;
+    }
+
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if (cache->newest)
+    {
+        cache->newest->newer = entry;
+    }
+    cache->newest = entry;
+    if (!cache->oldest)
+    {
+        cache->oldest = entry;
+    }
+}
+
+/*!
+ * \brief Evict the least recently used entries until the cache fits its memory cap
+ *
+ * \param cache             Cache to trim (locked)
+ *
+ */
+static void emojivur_shape_cache_trim(emojivur_shape_cache_t *cache)
+{
+    while (cache->bytes > cache->max_bytes && cache->oldest)
+    {
+        emojivur_shape_entry_t *entry = cache->oldest;
+
+        cache->oldest = entry->newer;
+        if (cache->oldest)
+        {
+            cache->oldest->older = NULL;
+        }
+        else
+        {
+            cache->newest = NULL;
+        }
+
+        emojivur_shape_entry_t **link = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+        while (*link != entry)
+        {
+            link = &(*link)->next_in_bucket;
+        }
+        *link = entry->next_in_bucket;
+
+        cache->bytes -= entry->bytes;
+        --cache->entry_count;
+        hb_face_destroy(entry->key.face);
+        free(entry);
+        emojivur_stats_count(EMOJIVUR_COUNTER_SHAPE_CACHE_EVICTIONS, 1);
+    }
+}
+
+/*!
+ * \brief Double the number of hash buckets moving the entries to the new ones
+ *
+ * \param cache             Cache to grow (locked)
+ *
+ */
+static void emojivur_shape_cache_grow(emojivur_shape_cache_t *cache)
+{
+    size_t bucket_count = cache->bucket_count * 2;
+    emojivur_shape_entry_t **buckets = (emojivur_shape_entry_t **)calloc(bucket_count,
+                                                                         sizeof(emojivur_shape_entry_t *));
+    if (unlikely(!buckets))
+    {
+        // Longer chains are slower but still correct
+        return;
+    }
+
+    for (size_t i = 0; i < cache->bucket_count; ++i)
+    {
+        emojivur_shape_entry_t *entry = cache->buckets[i];
+        while (entry)
+        {
+            emojivur_shape_entry_t *next = entry->next_in_bucket;
+            size_t bucket = entry->hash & (bucket_count - 1);
+            entry->next_in_bucket = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = bucket_count;
+}
+
+/*!
+ * \brief Create an empty cache of shaped runs
+ *
+ * The cache can be shared by many threads and it is reference counted.
+ *
+ * \param max_bytes         Memory the cached runs can use at most
+ *
+ * \return The new cache (with a reference count of 1), NULL on failure
+ *
+ */
+emojivur_shape_cache_t *emojivur_shape_cache_create(size_t max_bytes)
+{
+    emojivur_shape_cache_t *cache = (emojivur_shape_cache_t *)calloc(1, sizeof(emojivur_shape_cache_t));
+    if (unlikely(!cache))
+    {
+        return NULL;
+    }
+
+    cache->bucket_count = SHAPE_CACHE_MIN_BUCKETS;
+    cache->buckets = (emojivur_shape_entry_t **)calloc(cache->bucket_count, sizeof(emojivur_shape_entry_t *));
+    if (unlikely(!cache->buckets))
+    {
+        free(cache);
+        return NULL;
+    }
+
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->references = 1;
+    cache->max_bytes = max_bytes;
+
+    return cache;
+}
+
+/*!
+ * \brief Get a new reference to a cache
+ *
+ * \param cache             Cache to reference (can be NULL)
+ *
+ * \return `cache`
+ *
+ */
+emojivur_shape_cache_t *emojivur_shape_cache_reference(emojivur_shape_cache_t *cache)
+{
+    if (cache)
+    {
+        __atomic_add_fetch(&cache->references, 1, __ATOMIC_RELAXED);
+    }
+
+    return cache;
+}
+
+/*!
+ * \brief Release a reference to a cache, destroying it together with its runs when it is the last one
+ *
+ * \param cache             Cache to release (can be NULL)
+ *
+ */
+void emojivur_shape_cache_destroy(emojivur_shape_cache_t *cache)
+{
+    if (!cache || __atomic_sub_fetch(&cache->references, 1, __ATOMIC_ACQ_REL) > 0)
+    {
+        return;
+    }
+
+    // Every entry accounts for some memory: no memory left means no entry left
+    cache->max_bytes = 0;
+    emojivur_shape_cache_trim(cache);
+
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    free(cache);
+}
+
+/*!
+ * \brief Look a shaped run up, copying its glyphs on a hit
+ *
+ * \param cache             Cache to look into (can be NULL)
+ * \param key               What the run has been shaped from
+ * \param glyphs            Vector of Cairo glyphs the run is copied to, laid out from the origin (grown if needed)
+ * \param glyphs_allocated  Number of Cairo glyphs that fit in `glyphs` (updated when it grows)
+ * \param glyph_count       Number of Cairo glyphs copied (output)
+ * \param text_width        Width in pixels of the shaped text (output)
+ * \param text_height       Height in pixels of the shaped text (output)
+ *
+ * \return `true` on a hit, `false` if the run has to be shaped
+ *
+ */
+bool emojivur_shape_cache_lookup(emojivur_shape_cache_t *cache, const emojivur_shape_key_t *key,
+                                 cairo_glyph_t **glyphs, unsigned int *glyphs_allocated, unsigned int *glyph_count,
+                                 unsigned int *text_width, unsigned int *text_height)
+{
+    if (!cache)
+    {
+        return false;
+    }
+
+    size_t hash = emojivur_shape_hash(key);
+    bool hit = false;
+
+    pthread_mutex_lock(&cache->lock);
+    emojivur_shape_entry_t *entry = cache->buckets[hash & (cache->bucket_count - 1)];
+    while (entry && (entry->hash != hash || !emojivur_shape_key_equal(&entry->key, key)))
+    {
+        entry = entry->next_in_bucket;
+    }
+    if (entry)
+    {
+        // Glyphs are copied to the vector of the caller, which only ever grows (geometrically)
+        if (entry->glyph_count > *glyphs_allocated)
+        {
+            unsigned int allocated = MAX(entry->glyph_count, *glyphs_allocated * 2);
+            cairo_glyph_t *grown = cairo_glyph_allocate(allocated);
+            if (likely(grown))
+            {
+                cairo_glyph_free(*glyphs);
+                *glyphs = grown;
+                *glyphs_allocated = allocated;
+            }
+        }
+        if (likely(entry->glyph_count <= *glyphs_allocated))
+        {
+            if (entry->glyph_count)
+            {
+                memcpy(*glyphs, entry->glyphs, entry->glyph_count * sizeof(cairo_glyph_t));
+            }
+            *glyph_count = entry->glyph_count;
+            *text_width = entry->text_width;
+            *text_height = entry->text_height;
+            emojivur_shape_cache_touch(cache, entry);
+            hit = true;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    emojivur_stats_count(hit ? EMOJIVUR_COUNTER_SHAPE_CACHE_HITS : EMOJIVUR_COUNTER_SHAPE_CACHE_MISSES, 1);
+
+    return hit;
+}
+
+/*!
+ * \brief Add a shaped run to a cache, evicting the least recently used ones to make room for it
+ *
+ * \param cache             Cache to add the run to (can be NULL)
+ * \param key               What the run has been shaped from
+ * \param glyphs            Vector of Cairo glyphs laid out from the origin (copied)
+ * \param glyph_count       Number of Cairo glyphs in the vector
+ * \param text_width        Width in pixels of the shaped text
+ * \param text_height       Height in pixels of the shaped text
+ *
+ */
+void emojivur_shape_cache_add(emojivur_shape_cache_t *cache, const emojivur_shape_key_t *key,
+                              const cairo_glyph_t *glyphs, unsigned int glyph_count,
+                              unsigned int text_width, unsigned int text_height)
+{
+    size_t bytes = sizeof(emojivur_shape_entry_t) + glyph_count * sizeof(cairo_glyph_t) + key->text_length;
+    if (!cache || bytes > cache->max_bytes)
+    {
+        return;
+    }
+
+    emojivur_shape_entry_t *entry = (emojivur_shape_entry_t *)malloc(bytes);
+    if (unlikely(!entry))
+    {
+        return;
+    }
+    entry->glyphs = (cairo_glyph_t *)(entry + 1);
+    memcpy(entry->glyphs, glyphs, glyph_count * sizeof(cairo_glyph_t));
+    char *text = (char *)(entry->glyphs + glyph_count);
+    memcpy(text, key->text, key->text_length);
+
+    entry->key = *key;
+    entry->key.text = text;
+    entry->key.face = hb_face_reference(key->face);
+    entry->hash = emojivur_shape_hash(key);
+    entry->glyph_count = glyph_count;
+    entry->text_width = text_width;
+    entry->text_height = text_height;
+    entry->bytes = bytes;
+    entry->newer = NULL;
+    entry->older = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+
+    // Another thread may have shaped the same run in the meantime
+    emojivur_shape_entry_t *cached = cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    while (cached && (cached->hash != entry->hash || !emojivur_shape_key_equal(&cached->key, key)))
+    {
+        cached = cached->next_in_bucket;
+    }
+    if (cached)
+    {
+        emojivur_shape_cache_touch(cache, cached);
+        pthread_mutex_unlock(&cache->lock);
+        hb_face_destroy(entry->key.face);
+        free(entry);
+        return;
+    }
+
+    if (cache->entry_count >= cache->bucket_count)
+    {
+        emojivur_shape_cache_grow(cache);
+    }
+    size_t bucket = entry->hash & (cache->bucket_count - 1);
+    entry->next_in_bucket = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    ++cache->entry_count;
+    cache->bytes += bytes;
+    emojivur_shape_cache_touch(cache, entry);
+    emojivur_shape_cache_trim(cache);
+
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,328 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       stats.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Per-stage timing and allocation statistics
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "config.h"
+#include "stats.h"
+
+/*!
+ * \brief Measurements collected for a stage (updated atomically by any thread)
+ *
+ */
+typedef struct
+{
+    uint64_t calls;           /**< Number of times the stage run */
+    uint64_t elapsed_ns;      /**< Total time spent in the stage */
+    uint64_t max_ns;          /**< Longest time spent in the stage by one call */
+    uint64_t allocations;     /**< Number of heap allocations made during the stage */
+    uint64_t allocated_bytes; /**< Number of bytes allocated during the stage */
+} emojivur_stage_stats_t;
+
+static const char *emojivur_stage_names[EMOJIVUR_STAGE_COUNT] = {
+    "font_load",
+    "shape",
+    "glyphs",
+    "render",
+    "output",
+};
+
+static const char *emojivur_counter_names[EMOJIVUR_COUNTER_COUNT] = {
+    "shape_cache_hits",
+    "shape_cache_misses",
+    "shape_cache_evictions",
+};
+
+static bool emojivur_stats_active = false;
+static bool emojivur_stats_allocations_hooked = false;
+static const char *emojivur_stats_report_filename = NULL;
+static uint64_t emojivur_stats_start_ns = 0;
+static emojivur_stage_stats_t emojivur_stages[EMOJIVUR_STAGE_COUNT + 1];
+static uint64_t emojivur_counters[EMOJIVUR_COUNTER_COUNT];
+static _Thread_local emojivur_stage_t emojivur_current_stage = EMOJIVUR_STAGE_NONE;
+
+/*!
+ * \brief Start collecting statistics (it cannot be stopped)
+ *
+ */
+void emojivur_stats_enable(void)
+{
+    emojivur_stats_start_ns = emojivur_stats_now();
+    __atomic_store_n(&emojivur_stats_active, true, __ATOMIC_RELEASE);
+}
+
+/*!
+ * \brief Check whether statistics are being collected
+ *
+ * \return `true` if `emojivur_stats_enable()` has been called
+ *
+ */
+bool emojivur_stats_enabled(void)
+{
+    return __atomic_load_n(&emojivur_stats_active, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Read the monotonic clock
+ *
+ * \return Current time in nanoseconds from an arbitrary point in the past
+ *
+ */
+uint64_t emojivur_stats_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+/*!
+ * \brief Start measuring a stage on the calling thread
+ *
+ * Until the matching `emojivur_stats_stop()` every allocation made by the calling
+ * thread is accounted to `stage`. Stages can be nested.
+ *
+ * \param stage             Stage to measure
+ *
+ * \return Running measurement to hand over to `emojivur_stats_stop()`
+ *
+ */
+emojivur_stats_timer_t emojivur_stats_start(emojivur_stage_t stage)
+{
+    emojivur_stats_timer_t timer = {stage, emojivur_current_stage, 0};
+    if (likely(!emojivur_stats_enabled()))
+    {
+        return timer;
+    }
+
+    emojivur_current_stage = stage;
+    timer.start_ns = emojivur_stats_now();
+    return timer;
+}
+
+/*!
+ * \brief Stop measuring a stage started by `emojivur_stats_start()`
+ *
+ * \param timer             Running measurement of the stage
+ *
+ */
+void emojivur_stats_stop(emojivur_stats_timer_t *timer)
+{
+    if (likely(timer->start_ns == 0))
+    {
+        return;
+    }
+
+    uint64_t elapsed_ns = emojivur_stats_now() - timer->start_ns;
+    emojivur_stage_stats_t *stats = &emojivur_stages[timer->stage];
+    __atomic_add_fetch(&stats->calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->elapsed_ns, elapsed_ns, __ATOMIC_RELAXED);
+
+    uint64_t max_ns = __atomic_load_n(&stats->max_ns, __ATOMIC_RELAXED);
+    while (elapsed_ns > max_ns &&
+           !__atomic_compare_exchange_n(&stats->max_ns, &max_ns, elapsed_ns, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+
+    emojivur_current_stage = timer->previous;
+}
+
+/*!
+ * \brief Count some occurrences of an event
+ *
+ * \param counter           Event occurred
+ * \param count             Number of occurrences
+ *
+ */
+void emojivur_stats_count(emojivur_counter_t counter, uint64_t count)
+{
+    if (likely(!emojivur_stats_enabled()))
+    {
+        return;
+    }
+
+    __atomic_add_fetch(&emojivur_counters[counter], count, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Read the number of occurrences of an event counted so far
+ *
+ * \param counter           Event to read the counter of
+ *
+ * \return Number of occurrences
+ *
+ */
+uint64_t emojivur_stats_counter(emojivur_counter_t counter)
+{
+    return __atomic_load_n(&emojivur_counters[counter], __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Read the total number of heap allocations made since statistics are collected
+ *
+ * \param allocations       Number of allocations (output, can be NULL)
+ * \param allocated_bytes   Number of bytes allocated (output, can be NULL)
+ *
+ * \return `false` if allocations are not counted (the allocator hooks are not linked in)
+ *
+ */
+bool emojivur_stats_count_allocations(uint64_t *allocations, uint64_t *allocated_bytes)
+{
+    uint64_t total_allocations = 0;
+    uint64_t total_bytes = 0;
+    for (int i = 0; i <= EMOJIVUR_STAGE_COUNT; ++i)
+    {
+        total_allocations += __atomic_load_n(&emojivur_stages[i].allocations, __ATOMIC_RELAXED);
+        total_bytes += __atomic_load_n(&emojivur_stages[i].allocated_bytes, __ATOMIC_RELAXED);
+    }
+
+    if (allocations)
+    {
+        *allocations = total_allocations;
+    }
+    if (allocated_bytes)
+    {
+        *allocated_bytes = total_bytes;
+    }
+
+    return __atomic_load_n(&emojivur_stats_allocations_hooked, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Write the statistics collected so far as a JSON document
+ *
+ * \param report_file       File to write the report to
+ *
+ */
+void emojivur_stats_report(FILE *report_file)
+{
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    bool allocations_counted = emojivur_stats_count_allocations(&allocations, &allocated_bytes);
+
+    fprintf(report_file, "{\n  \"wall_ms\": %.3f,\n  \"stages\": {\n",
+            (emojivur_stats_now() - emojivur_stats_start_ns) / 1e6);
+    for (int i = 0; i < EMOJIVUR_STAGE_COUNT; ++i)
+    {
+        const emojivur_stage_stats_t *stats = &emojivur_stages[i];
+        fprintf(report_file,
+                "    \"%s\": {\"calls\": %llu, \"total_ms\": %.3f, \"mean_us\": %.3f, \"max_us\": %.3f",
+                emojivur_stage_names[i],
+                (unsigned long long)stats->calls,
+                stats->elapsed_ns / 1e6,
+                stats->calls ? stats->elapsed_ns / 1e3 / stats->calls : 0.0,
+                stats->max_ns / 1e3);
+        if (allocations_counted)
+        {
+            fprintf(report_file, ", \"allocations\": %llu, \"allocated_bytes\": %llu",
+                    (unsigned long long)stats->allocations,
+                    (unsigned long long)stats->allocated_bytes);
+        }
+        fprintf(report_file, "}%s\n", i + 1 < EMOJIVUR_STAGE_COUNT ? "," : "");
+    }
+    fprintf(report_file, "  },\n  \"counters\": {");
+    for (int i = 0; i < EMOJIVUR_COUNTER_COUNT; ++i)
+    {
+        fprintf(report_file, "%s\"%s\": %llu", i ? ", " : "", emojivur_counter_names[i],
+                (unsigned long long)emojivur_stats_counter(i));
+    }
+    fprintf(report_file, "}");
+    if (allocations_counted)
+    {
+        fprintf(report_file, ",\n  \"allocations\": %llu,\n  \"allocated_bytes\": %llu",
+                (unsigned long long)allocations, (unsigned long long)allocated_bytes);
+    }
+    fprintf(report_file, "\n}\n");
+}
+
+/*!
+ * \brief Write the report to the file chosen by `emojivur_stats_report_at_exit()`
+ *
+ */
+static void emojivur_stats_report_on_exit(void)
+{
+    FILE *report_file = stderr;
+    if (emojivur_stats_report_filename)
+    {
+        report_file = fopen(emojivur_stats_report_filename, "w");
+        if (unlikely(!report_file))
+        {
+            fprintf(stderr, "[ERROR] An error occured opening the statistics file for writing!\n");
+            return;
+        }
+    }
+
+    emojivur_stats_report(report_file);
+
+    if (report_file != stderr)
+    {
+        fclose(report_file);
+    }
+}
+
+/*!
+ * \brief Start collecting statistics and write a report when the program exits
+ *
+ * \param report_filename   File name of the JSON report (NULL to write it on the standard error)
+ *
+ */
+void emojivur_stats_report_at_exit(const char *report_filename)
+{
+    emojivur_stats_report_filename = report_filename;
+    emojivur_stats_enable();
+    atexit(emojivur_stats_report_on_exit);
+}
+
+/*!
+ * \brief Tell that allocations are counted, the allocator hooks being linked in (see `stats_alloc.c`)
+ *
+ */
+void emojivur_stats_hook_allocations(void)
+{
+    __atomic_store_n(&emojivur_stats_allocations_hooked, true, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \brief Account an allocation to the stage being measured on the calling thread
+ *
+ * \param size              Number of bytes allocated
+ *
+ */
+void emojivur_stats_allocation(size_t size)
+{
+    if (likely(!emojivur_stats_enabled()))
+    {
+        return;
+    }
+
+    emojivur_stage_stats_t *stats = &emojivur_stages[emojivur_current_stage];
+    __atomic_add_fetch(&stats->allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->allocated_bytes, size, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,109 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       stats_alloc.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Allocator hooks counting heap allocations for the statistics
+//
+//  Only the executables reporting allocations link this file (see `EMOJIVUR_COUNT_ALLOCATIONS` in CMakeLists.txt):
+//  the allocator of the whole process is wrapped, libraries included.
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include "config.h"
+#include "stats.h"
+
+// Allocations can be counted only where the C library allows malloc & co. to be wrapped
+#if defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+/*!
+ * \brief Tell the statistics that allocations are counted as soon as the program starts
+ *
+ */
+__attribute__((constructor)) static void emojivur_stats_alloc_init(void)
+{
+    emojivur_stats_hook_allocations();
+}
+
+// The whole family is replaced, as glibc requires, even if only allocations are counted
+
+void *malloc(size_t size)
+{
+    emojivur_stats_allocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    emojivur_stats_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    emojivur_stats_allocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    emojivur_stats_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    emojivur_stats_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (unlikely(alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0))
+    {
+        return EINVAL;
+    }
+
+    emojivur_stats_allocation(size);
+    void *allocated = __libc_memalign(alignment, size);
+    if (unlikely(!allocated && size > 0))
+    {
+        return ENOMEM;
+    }
+    *ptr = allocated;
+
+    return 0;
+}
+#endif
@@ -0,0 +1,216 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       stream.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Byte streams Cairo can write documents to
+//
+
+#include <stdlib.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <cairo/cairo.h>
+
+#include "config.h"
+#include "stream.h"
+
+// Bytes allocated by a memory stream at its first write
+#define STREAM_MIN_ALLOCATION (64 * 1024)
+
+// Bytes buffered by a stream writing to a file descriptor before flushing them
+#define STREAM_FD_BUFFER (1024 * 1024)
+
+const emojivur_stream_t emojivur_stream_default = {NULL, 0, 0, -1, false};
+
+/*!
+ * \brief Get the file descriptor an output file name refers to, if any
+ *
+ * \param filename          Output file name (`-` for the standard output, `fd:N` for the file descriptor N)
+ *
+ * \return File descriptor to write to, -1 if `filename` names a regular file
+ *
+ */
+int emojivur_output_fd(const char *filename)
+{
+    if (strcmp(filename, "-") == 0)
+    {
+        return STDOUT_FILENO;
+    }
+
+    if (strncmp(filename, "fd:", 3) == 0)
+    {
+        char *end = NULL;
+        errno = 0;
+        long fd = strtol(filename + 3, &end, 10);
+        if (end != filename + 3 && *end == '\0' && errno == 0 && fd >= 0 && fd <= INT_MAX)
+        {
+            return (int)fd;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * \brief Make room in the buffer of a stream for some more bytes
+ *
+ * \param stream            Stream to grow
+ * \param length            Number of bytes to make room for
+ *
+ * \return `true` on success, `false` if out of memory
+ *
+ */
+static bool emojivur_stream_reserve(emojivur_stream_t *stream, size_t length)
+{
+    if (stream->length + length <= stream->allocated)
+    {
+        return true;
+    }
+
+    size_t allocated = MAX(stream->allocated, stream->fd < 0 ? STREAM_MIN_ALLOCATION : STREAM_FD_BUFFER);
+    while (allocated < stream->length + length)
+    {
+        allocated *= 2;
+    }
+
+    unsigned char *buffer = (unsigned char *)realloc(stream->data, allocated);
+    if (unlikely(!buffer))
+    {
+        return false;
+    }
+    stream->data = buffer;
+    stream->allocated = allocated;
+
+    return true;
+}
+
+/*!
+ * \brief Append bytes to a stream (suitable as `cairo_write_func_t`)
+ *
+ * Memory streams grow to fit everything written to them, while streams writing to a file
+ * descriptor buffer small writes and flush them in large chunks (big writes go straight through).
+ *
+ * \param closure           Stream to write to
+ * \param data              Bytes to write
+ * \param length            Number of bytes to write
+ *
+ * \return `CAIRO_STATUS_SUCCESS`, `CAIRO_STATUS_WRITE_ERROR` on failure
+ *
+ */
+cairo_status_t emojivur_stream_write(void *closure, const unsigned char *data, unsigned int length)
+{
+    emojivur_stream_t *stream = (emojivur_stream_t *)closure;
+    if (unlikely(stream->failed))
+    {
+        return CAIRO_STATUS_WRITE_ERROR;
+    }
+
+    if (stream->fd >= 0 && stream->length + length > STREAM_FD_BUFFER)
+    {
+        if (unlikely(!emojivur_stream_flush(stream)))
+        {
+            return CAIRO_STATUS_WRITE_ERROR;
+        }
+        if (length >= STREAM_FD_BUFFER)
+        {
+            stream->failed = !emojivur_write_all(stream->fd, data, length);
+            return stream->failed ? CAIRO_STATUS_WRITE_ERROR : CAIRO_STATUS_SUCCESS;
+        }
+    }
+
+    if (unlikely(!emojivur_stream_reserve(stream, length)))
+    {
+        stream->failed = true;
+        return CAIRO_STATUS_WRITE_ERROR;
+    }
+
+    memcpy(stream->data + stream->length, data, length);
+    stream->length += length;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/*!
+ * \brief Write the bytes buffered by a stream to its file descriptor
+ *
+ * \param stream            Stream to flush (nothing to do for memory streams)
+ *
+ * \return `true` if every byte written to the stream so far reached its destination, `false` otherwise
+ *
+ */
+bool emojivur_stream_flush(emojivur_stream_t *stream)
+{
+    if (stream->fd >= 0 && stream->length > 0 && !stream->failed)
+    {
+        stream->failed = !emojivur_write_all(stream->fd, stream->data, stream->length);
+        stream->length = 0;
+    }
+
+    return !stream->failed;
+}
+
+/*!
+ * \brief Release the memory of a stream, leaving it empty (buffered bytes are not flushed)
+ *
+ * \param stream            Stream to release
+ *
+ */
+void emojivur_stream_free(emojivur_stream_t *stream)
+{
+    free(stream->data);
+    *stream = emojivur_stream_default;
+}
+
+/*!
+ * \brief Write all the bytes provided to a file descriptor (retrying after partial writes and signals)
+ *
+ * \param fd                File descriptor to write to
+ * \param data              Bytes to write
+ * \param length            Number of bytes to write
+ *
+ * \return `true` on success, `false` otherwise (`errno` tells why)
+ *
+ */
+bool emojivur_write_all(int fd, const void *data, size_t length)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, bytes, length);
+        if (unlikely(written < 0 && errno == EINTR))
+        {
+            continue;
+        }
+        // Nothing written while bytes are left would loop forever: it is taken as a failure
+        if (unlikely(written <= 0))
+        {
+            return false;
+        }
+        bytes += written;
+        length -= written;
+    }
+
+    return true;
+}
@@ -0,0 +1,421 @@
+//  ------------------------------------------------------------------------  //
+//                        _ _                                                 //
+//    ___ _ __ ___   ___ (_|_)_   ___   _ _ __                                //
+//   / _ \ '_ ` _ \ / _ \| | \ \ / / | | | '__|                               //
+//  |  __/ | | | | | (_) | | |\ V /| |_| | |                                  //
+//   \___|_| |_| |_|\___// |_| \_/  \__,_|_|                                  //
+//                     |__/                                                   //
+//                                                                            //
+//  ------------------------------------------------------------------------  //
+//  emojivur                                                                  //
+//  Lightweight emoji viewer and PDF conversion utility                       //
+//  ------------------------------------------------------------------------  //
+//  Copyright (c) 2020 Simone Conti, @itnok <s.conti@itnok.com>               //
+//  All Rights Reserved.                                                      //
+//                                                                            //
+//  Distributed under MIT license.                                            //
+//  See file LICENSE for detail                                               //
+//  or copy at https://opensource.org/licenses/MIT                            //
+//  ------------------------------------------------------------------------  //
+//  \file       emojivur_test.c
+//  \author     Simone Conti (itnok)
+//  \date       2026/10/16
+//
+//  \brief      Golden image regression test of one case rendered by emojivur within its budgets
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <png.h>
+
+#include <cairo/cairo.h>
+#ifdef HAVE_POPPLER
+#include <poppler.h>
+#endif
+
+#include "config.h"
+#include "test_options.h"
+
+// Exit status telling CTest that the case was skipped
+#define TEST_SKIPPED 77
+
+/*!
+ * \brief Image read from a PNG file as 8 bits RGBA pixels (not premultiplied)
+ *
+ */
+typedef struct
+{
+    png_image png;   /**< Size & format of the image */
+    uint8_t *pixels; /**< Rows of pixels, one after the other */
+} test_image_t;
+
+/*!
+ * \brief Run emojivur rendering a case to a file, measuring how long it takes and how much memory it uses
+ *
+ * \param options           Command line options (with the arguments for emojivur)
+ * \param elapsed_ns        Wall time taken by emojivur (output)
+ * \param peak_rss_kib      Peak resident memory used by emojivur in KiB (output)
+ *
+ * \return `true` if emojivur succeeded, `false` otherwise
+ *
+ */
+static bool test_run(const struct gengetopt_args_info *options, uint64_t *elapsed_ns, long *peak_rss_kib)
+{
+    // emojivur -f FONT [ARGUMENTS...] -o OUTPUT
+    char **argv = (char **)calloc(options->inputs_num + 6, sizeof(char *));
+    if (unlikely(!argv))
+    {
+        return false;
+    }
+    unsigned int argc = 0;
+    argv[argc++] = options->emojivur_arg;
+    argv[argc++] = "-f";
+    argv[argc++] = options->font_arg;
+    for (unsigned int i = 0; i < options->inputs_num; ++i)
+    {
+        argv[argc++] = options->inputs[i];
+    }
+    argv[argc++] = "-o";
+    argv[argc++] = options->output_arg;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execv(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    free(argv);
+    if (unlikely(pid < 0))
+    {
+        perror("fork");
+        return false;
+    }
+
+    int status;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) < 0)
+    {
+        if (unlikely(errno != EINTR))
+        {
+            perror("wait4");
+            return false;
+        }
+    }
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *elapsed_ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ull + end.tv_nsec - start.tv_nsec;
+#ifdef __APPLE__
+    *peak_rss_kib = usage.ru_maxrss / 1024;
+#else
+    *peak_rss_kib = usage.ru_maxrss;
+#endif
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/*!
+ * \brief Rasterize all pages of a PDF document one below the other to a PNG image
+ *
+ * Pages are rendered at 72 DPI on a transparent background, so that a pixel of the image is a point of the page.
+ *
+ * \param pdf_filename      PDF document to rasterize
+ * \param png_filename      PNG image to write
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+static bool test_pdf_rasterize(const char *pdf_filename, const char *png_filename)
+{
+#ifdef HAVE_POPPLER
+    char path[PATH_MAX];
+    if (unlikely(!realpath(pdf_filename, path)))
+    {
+        perror(pdf_filename);
+        return false;
+    }
+
+    GError *error = NULL;
+    char *uri = g_filename_to_uri(path, NULL, &error);
+    PopplerDocument *document = uri ? poppler_document_new_from_file(uri, NULL, &error) : NULL;
+    g_free(uri);
+    if (unlikely(!document))
+    {
+        fprintf(stderr, "%s: %s\n", pdf_filename, error ? error->message : "cannot be read");
+        if (error)
+        {
+            g_error_free(error);
+        }
+        return false;
+    }
+
+    int page_count = poppler_document_get_n_pages(document);
+    double width = 0;
+    double height = 0;
+    for (int i = 0; i < page_count; ++i)
+    {
+        double page_width, page_height;
+        PopplerPage *page = poppler_document_get_page(document, i);
+        poppler_page_get_size(page, &page_width, &page_height);
+        g_object_unref(page);
+        width = page_width > width ? page_width : width;
+        height += ceil(page_height);
+    }
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, ceil(width), height);
+    cairo_t *cairo_context = cairo_create(surface);
+    for (int i = 0; i < page_count; ++i)
+    {
+        double page_width, page_height;
+        PopplerPage *page = poppler_document_get_page(document, i);
+        poppler_page_get_size(page, &page_width, &page_height);
+        poppler_page_render(page, cairo_context);
+        g_object_unref(page);
+        cairo_translate(cairo_context, 0, ceil(page_height));
+    }
+    cairo_destroy(cairo_context);
+    g_object_unref(document);
+
+    bool written = cairo_surface_write_to_png(surface, png_filename) == CAIRO_STATUS_SUCCESS;
+    cairo_surface_destroy(surface);
+
+    return written;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \brief Read a PNG image
+ *
+ * \param filename          PNG image to read
+ * \param image             Image to fill in (release its pixels with `free()`)
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+static bool test_image_read(const char *filename, test_image_t *image)
+{
+    memset(image, 0, sizeof(*image));
+    image->png.version = PNG_IMAGE_VERSION;
+    if (unlikely(!png_image_begin_read_from_file(&image->png, filename)))
+    {
+        fprintf(stderr, "%s: %s\n", filename, image->png.message);
+        return false;
+    }
+
+    image->png.format = PNG_FORMAT_RGBA;
+    image->pixels = (uint8_t *)malloc(PNG_IMAGE_SIZE(image->png));
+    if (unlikely(!image->pixels || !png_image_finish_read(&image->png, NULL, image->pixels, 0, NULL)))
+    {
+        fprintf(stderr, "%s: %s\n", filename, image->pixels ? image->png.message : "out of memory");
+        png_image_free(&image->png);
+        free(image->pixels);
+        image->pixels = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Write a PNG image
+ *
+ * \param filename          PNG image to write
+ * \param image             Image
+ *
+ * \return `true` on success, `false` otherwise
+ *
+ */
+static bool test_image_write(const char *filename, test_image_t *image)
+{
+    if (unlikely(!png_image_write_to_file(&image->png, filename, 0, image->pixels, 0, NULL)))
+    {
+        fprintf(stderr, "%s: %s\n", filename, image->png.message);
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Compare an image to its golden image, marking the pixels that differ
+ *
+ * Color channels are compared premultiplied by alpha, so that fully transparent pixels always match.
+ *
+ * \param result            Image rendered (its pixels are replaced by the differences)
+ * \param golden            Golden image of the same size
+ * \param tolerance         Largest difference of a color channel for a pixel still to match
+ *
+ * \return Number of pixels that differ
+ *
+ */
+static size_t test_image_compare(test_image_t *result, const test_image_t *golden, int tolerance)
+{
+    size_t differing = 0;
+    size_t pixel_count = (size_t)result->png.width * result->png.height;
+    for (size_t i = 0; i < pixel_count; ++i)
+    {
+        uint8_t *pixel = &result->pixels[i * 4];
+        const uint8_t *golden_pixel = &golden->pixels[i * 4];
+        bool differs = abs(pixel[3] - golden_pixel[3]) > tolerance;
+        for (unsigned int channel = 0; channel < 3 && !differs; ++channel)
+        {
+            int value = (pixel[channel] * pixel[3] + 127) / 255;
+            int golden_value = (golden_pixel[channel] * golden_pixel[3] + 127) / 255;
+            differs = abs(value - golden_value) > tolerance;
+        }
+
+        // Differences are red, matching pixels a faint gray shadow of the golden image
+        if (differs)
+        {
+            ++differing;
+            pixel[0] = 255;
+            pixel[1] = 0;
+            pixel[2] = 0;
+            pixel[3] = 255;
+        }
+        else
+        {
+            pixel[0] = pixel[1] = pixel[2] = 128;
+            pixel[3] = golden_pixel[3] / 4;
+        }
+    }
+
+    return differing;
+}
+
+//    __  __    _    ___ _   _
+//   |  \/  |  / \  |_ _| \ | |
+//   | |\/| | / _ \  | ||  \| |
+//   | |  | |/ ___ \ | || |\  |
+//   |_|  |_/_/   \_\___|_| \_|
+//
+//   #pragma MAIN
+
+int main(int argc, char *argv[])
+{
+    struct gengetopt_args_info options;
+    if (unlikely(cmdline_parser(argc, argv, &options) != 0))
+    {
+        return 1;
+    }
+
+    const char *update_golden = getenv("EMOJIVUR_UPDATE_GOLDEN");
+    bool update = options.update_flag || (update_golden && strcmp(update_golden, "1") == 0);
+    const char *extension = strrchr(options.output_arg, '.');
+    bool is_pdf = extension && strcasecmp(extension, ".pdf") == 0;
+
+    if (options.font_arg[0] == '\0' || access(options.font_arg, R_OK) != 0)
+    {
+        printf("[SKIPPED] No font to render the case with: choose one with -DEMOJIVUR_TEST_FONT=FILENAME\n");
+        return TEST_SKIPPED;
+    }
+#ifndef HAVE_POPPLER
+    if (is_pdf)
+    {
+        printf("[SKIPPED] PDF documents cannot be rasterized without poppler-glib\n");
+        return TEST_SKIPPED;
+    }
+#endif
+    // A case without its golden image checks nothing: it fails rather than passing unnoticed
+    if (!update && access(options.golden_arg, R_OK) != 0)
+    {
+        fprintf(stderr, "[FAILED] No golden image %s: record it building the `golden` target\n", options.golden_arg);
+        return 1;
+    }
+
+    uint64_t elapsed_ns;
+    long peak_rss_kib;
+    if (unlikely(!test_run(&options, &elapsed_ns, &peak_rss_kib)))
+    {
+        fprintf(stderr, "[FAILED] emojivur could not render the case\n");
+        return 1;
+    }
+    printf("wall time=%.1f ms (budget: %d ms)\n", elapsed_ns / 1e6, options.time_budget_arg);
+    printf("peak RSS=%.1f MiB (budget: %d MiB)\n", peak_rss_kib / 1024.0, options.rss_budget_arg);
+
+    // PDF documents are compared to their golden image once rasterized next to them
+    char png_filename[PATH_MAX];
+    snprintf(png_filename, sizeof(png_filename), "%s%s", options.output_arg, is_pdf ? ".png" : "");
+    if (is_pdf && unlikely(!test_pdf_rasterize(options.output_arg, png_filename)))
+    {
+        fprintf(stderr, "[FAILED] The PDF document could not be rasterized\n");
+        return 1;
+    }
+
+    test_image_t result;
+    if (unlikely(!test_image_read(png_filename, &result)))
+    {
+        fprintf(stderr, "[FAILED] The result could not be read\n");
+        return 1;
+    }
+
+    if (update)
+    {
+        bool written = test_image_write(options.golden_arg, &result);
+        free(result.pixels);
+        printf("%s %s\n", written ? "[RECORDED]" : "[FAILED]", options.golden_arg);
+        return written ? 0 : 1;
+    }
+
+    int failures = 0;
+    test_image_t golden;
+    if (unlikely(!test_image_read(options.golden_arg, &golden)))
+    {
+        fprintf(stderr, "[FAILED] The golden image could not be read\n");
+        ++failures;
+    }
+    else if (result.png.width != golden.png.width || result.png.height != golden.png.height)
+    {
+        fprintf(stderr, "[FAILED] Size of the result %ux%u differs from the golden image %ux%u\n",
+                result.png.width, result.png.height, golden.png.width, golden.png.height);
+        ++failures;
+    }
+    else
+    {
+        size_t pixel_count = (size_t)golden.png.width * golden.png.height;
+        size_t differing = test_image_compare(&result, &golden, options.tolerance_arg);
+        printf("differing pixels=%zu out of %zu\n", differing, pixel_count);
+        if (differing > options.max_differing_arg * pixel_count)
+        {
+            char diff_filename[PATH_MAX];
+            snprintf(diff_filename, sizeof(diff_filename), "%s.diff.png", options.output_arg);
+            test_image_write(diff_filename, &result);
+            fprintf(stderr, "[FAILED] The result differs from the golden image (see %s)\n", diff_filename);
+            ++failures;
+        }
+    }
+    free(result.pixels);
+    free(golden.pixels);
+
+    if (options.time_budget_arg > 0 && elapsed_ns > options.time_budget_arg * 1000000ull)
+    {
+        fprintf(stderr, "[FAILED] Rendering took longer than its budget\n");
+        ++failures;
+    }
+    if (options.rss_budget_arg > 0 && peak_rss_kib > options.rss_budget_arg * 1024l)
+    {
+        fprintf(stderr, "[FAILED] Rendering used more memory than its budget\n");
+        ++failures;
+    }
+
+    return failures ? 1 : 0;
+}